@@ -10,6 +10,7 @@
 #include <vector>
 #include <mutex>
 #include <map>
+#include <deque>
 #include <chrono>
 #include <random>
 #include <atomic>
@@ -136,6 +137,11 @@ private:
     std::vector<Point> path_; // 当前领到的任务路径
     int pathIndex_ = 0;       // 走到路径的第几步了
     bool isWorking_ = false;  // 是否在执行任务
+    bool hasTask_ = false;    // 是否持有任务 (含等待路径阶段)
+
+    // 服务器预推送的后续任务 : 当前任务完成后按序接着做
+    std::deque<std::pair<std::string, Point>> taskQueue_;
+    std::string lastDoneTaskId_ = "";  // 刚做完的任务 : 服务器重传的下发可能晚于完成才到
 
     std::string token_ = "";
 
@@ -301,9 +307,10 @@ private:
         SendPacket(MsgType::HEARTBEAT, j);
     }
 
-    void SendTaskReport(AgvStatus status, double progress, int32_t ackSeq = 0) {
+    void SendTaskReport(AgvStatus status, double progress, int32_t ackSeq = 0, const std::string& taskId = "") {
+        const std::string& id = taskId.empty() ? currentTaskId_ : taskId;
         json j;
-        j["taskId"] = currentTaskId_;
+        j["taskId"] = id;
         j["agvId"] = id_;
         j["status"] = status; 
         j["currentPos"] = { {"x", currentPos_.x}, {"y", currentPos_.y} };
@@ -312,10 +319,56 @@ private:
         SendPacket(MsgType::TASK_REPORT, j);
 
         if (ackSeq > 0) {
-            printf("[AGV-%d] > Sent ACK (RefSeq=%d) for Task %s.\n", id_, ackSeq, currentTaskId_.c_str());
+            printf("[AGV-%d] > Sent ACK (RefSeq=%d) for Task %s.\n", id_, ackSeq, id.c_str());
+        }
+    }
+
+    // 开始执行一个任务 : 发起寻路
+    void StartTask(const std::string& taskId, Point target) {
+        currentTaskId_ = taskId;
+        currentTaskTarget_ = target;
+        hasTask_ = true;
+
+        RequestNewPath(currentTaskTarget_);
+        printf("[AGV-%d] Requesting Path to target point(%d,%d)...\n", id_, currentTaskTarget_.x, currentTaskTarget_.y);
+    }
+
+    // 当前任务完成 : 上报，并无缝接上队列里的下一单
+    void FinishTask() {
+        isWorking_ = false;
+        hasTask_ = false;
+        path_.clear();
+        lastDoneTaskId_ = currentTaskId_;
+        SendTaskReport(AgvStatus::IDLE, 1.0);
+
+        if (!taskQueue_.empty()) {
+            auto next = taskQueue_.front();
+            taskQueue_.pop_front();
+            printf("[AGV-%d] Continue with queued Task [%s].\n", id_, next.first.c_str());
+            StartTask(next.first, next.second);
+        }
+    }
+
+    // 纯 ACK : 只确认收到 (refSeq)，内容是车上当前任务的真实状态
+    // 服务器收到上报会刷新这辆车的任务 ID / 进度 (ETA 据此推算)，不能拿别的任务 ID 或 0 进度把它冲掉
+    void SendAck(int32_t seq) {
+        if (hasTask_) {
+            double progress = path_.empty() ? 0.0 : (double)pathIndex_ / path_.size();
+            SendTaskReport(isWorking_ ? AgvStatus::MOVING : AgvStatus::IDLE, progress, seq);
+        } else {
+            SendTaskReport(AgvStatus::IDLE, 1.0, seq, lastDoneTaskId_);
         }
     }
 
+    bool IsKnownTask(const std::string& taskId) const {
+        if (hasTask_ && taskId == currentTaskId_) return true;
+        if (taskId == lastDoneTaskId_) return true;
+        for (const auto& t : taskQueue_) {
+            if (t.first == taskId) return true;
+        }
+        return false;
+    }
+
     void RequestNewPath(Point end) {
         json j;
         j["mapId"] = 1;
@@ -370,10 +423,8 @@ private:
                 printf("[AGV-%d] Moved to (%d,%d)\n", id_, currentPos_.x, currentPos_.y);
             } else {
                 // 走完了
-                isWorking_ = false;
-                path_.clear();
-                SendTaskReport(AgvStatus::IDLE, 1.0); // 
                 printf("[AGV-%d] Task Completed.\n", id_);
+                FinishTask();
             }
         }
     }
@@ -398,19 +449,32 @@ private:
     void ProcessMessage(MsgType type, int32_t seq, const json& j) {
         switch (type) {
             case MsgType::TASK_REQUEST: {
-                // 1. 更新状态
-                currentTaskId_ = j["taskId"];
-                currentTaskTarget_ = { j["targetPos"]["x"], j["targetPos"]["y"] };
-                
+                std::string taskId = j["taskId"];
+                Point target = { j["targetPos"]["x"], j["targetPos"]["y"] };
+
                 printf("[AGV-%d] Received Task [%s] -> Go to (%d, %d)\n", 
-                       id_, currentTaskId_.c_str(), currentTaskTarget_.x, currentTaskTarget_.y);
+                       id_, taskId.c_str(), target.x, target.y);
+
+                // 0. 服务器重传 (ACK 丢了 / 晚了) : 已经接过的任务只补 ACK，不重复执行
+                if (IsKnownTask(taskId)) {
+                    SendAck(seq);
+                    printf("[AGV-%d] Task [%s] is a retransmission, re-ACK only.\n", id_, taskId.c_str());
+                    break;
+                }
+
+                // 1. 手上有活 : 服务器预推送的下一单，排队并 ACK
+                if (hasTask_) {
+                    taskQueue_.emplace_back(taskId, target);
+                    SendAck(seq);
+                    printf("[AGV-%d] Task [%s] queued (%lu waiting).\n", id_, taskId.c_str(), taskQueue_.size());
+                    break;
+                }
 
                 // 2. 立即回复 ACK (TaskReport)
-                SendTaskReport(AgvStatus::IDLE, 0.0 , seq); 
+                SendTaskReport(AgvStatus::IDLE, 0.0 , seq, taskId); 
 
                 // 3. 发起寻路请求 (参数是任务目的地)
-                RequestNewPath(currentTaskTarget_);
-                printf("[AGV-%d] Requesting Path to target point(%d,%d)...\n", id_, currentTaskTarget_.x, currentTaskTarget_.y);
+                StartTask(taskId, target);
                 break;
             }
 
@@ -426,8 +490,7 @@ private:
                     if (path_.empty()) {
                         // 已经在目标位置，立即完成任务
                         printf("[AGV-%d] Already at target! Task completed immediately.\n", id_);
-                        SendTaskReport(AgvStatus::IDLE, 1.0);
-                        isWorking_ = false;
+                        FinishTask();
                     } else {
                         // 有路径，开始执行
                         isWorking_ = true;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "utils/json.hpp"
+#include "model/TaskHandle.h"
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -160,11 +161,20 @@ struct AgvInfo {
 
     // --- 逻辑状态信息 ：··    
     AgvStatus status = AgvStatus::IDLE; // 核心数据。决定了它能不能接单
-    std::string currentTaskId;  // 当前正在执行的任务ID (空字符串表示没任务)
+    TaskHandle currentTaskId;  // 当前正在执行的任务ID (无效句柄表示没任务)
     double taskProgress = 0.0;  // 任务进度
 
     // --- 运维保活信息
     int64_t lastHeartbeatTime = 0;  // 核心数据。用来计算“最后一次心跳时间”，判断是否断连 毫秒级
+
+    // --- 运动学观测 ：由 WorldManager 维护，用于预测车辆何时、在哪空闲 (ETA)
+    int pathLen = 0;            // 最近一次规划的路径长度 (格)
+    double speed = 0.0;         // 观测速度 (格/秒，EWMA); 0 表示还没有观测
+    int64_t lastMoveTime = 0;   // 上一次位置变化的时间 毫秒级
+
+    // --- 调度视图 ：只在调度快照里由 TaskManager 填写
+    // 预测候选 : 空闲前还要走的格数 (0 = 已空闲)，此时 currentPos 为预计空闲位置
+    int etaCells = 0;
 };
 
 
@@ -211,7 +221,7 @@ NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Heartbeat, agvId, status, currentPos, battery
 
 // [MsgType::TASK_REQUEST] 任务下发
 struct TaskRequest {
-    std::string taskId;
+    TaskHandle taskId;  // 线上仍是字符串 (见 TaskHandle.h)
     AgvId targetAgvId;
     Point targetPos;
     ActionType targetAct;  // action, 到了目的地干什么
@@ -227,7 +237,7 @@ Header 负责传输，Body 负责关联
 */
 // [MsgType::TASK_REPORT] 任务状态上报
 struct TaskReport {
-    std::string taskId;
+    TaskHandle taskId;
     AgvId agvId;
     AgvStatus status;
     Point currentPos;
@@ -253,5 +263,22 @@ struct PathResponse {
 };
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PathResponse, success, pathPoints, failReason)
 
+// [MsgType::RESERVE_REQ] 格子预约 : 先放 release，再按顺序申请 claim
+struct ReserveRequest {
+    std::vector<Point> claim;    // 前方要进入的格子 (按行驶顺序)
+    std::vector<Point> release;  // 已经驶离的格子
+    bool allOrNothing;           // true : 一格拿不到就全不要 (单行通道); false : 能拿几格拿几格
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ReserveRequest, claim, release, allOrNothing)
+
+// [MsgType::RESERVE_RESP] 预约结果
+struct ReserveResponse {
+    bool granted;        // claim 是否全部拿到
+    int grantedCount;    // 从头开始拿到的格数
+    Point conflictCell;  // 没拿到的第一格
+    AgvId conflictAgv;   // 占着它的车 (-1 : 障碍物 / 越界 / 超出单次上限)
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ReserveResponse, granted, grantedCount, conflictCell, conflictAgv)
+
 }
 }
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "utils/json.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+/*
+任务句柄 (Task Handle) : 64 位紧凑任务 ID
+原来的 taskId 是 "T-毫秒-序号" 字符串，每一次状态流转都要拷贝 / 哈希 / 比较它：
+    入队建索引、按 ID 出堆、上报时在序列里查找、RPC 回调捕获、延迟日志条目 ...
+    串长超过 SSO (15 字节) 时每次拷贝都是一次堆分配，"T-1792315023595-105" 正好超过
+现在内部统一用一个 uint64_t (类似 Snowflake)：
+    [63..56] 分片   8 位   任务所在分区，按 ID 路由到分片无需逐个查找
+    [55..16] 毫秒  40 位   相对 2020-01-01，约 34 年
+    [15..0]  序号  16 位   同一毫秒内递增; 溢出时借位到毫秒字段，保证单调且唯一
+字符串只出现在边缘：
+    日志 : ToText() 在栈上格式化，不分配堆内存
+    JSON : to_json / from_json，线上格式 "T-<unix毫秒>-<分片>-<序号>"，车端仍按字符串透传
+value == 0 表示无效 (没有任务)
+*/
+
+namespace agv{
+namespace model{
+
+struct TaskHandle {
+    uint64_t value = 0;
+
+    static constexpr int kSeqBits = 16;
+    static constexpr int kTimeBits = 40;
+    static constexpr int kShardBits = 8;
+    static constexpr int64_t kEpochMs = 1577836800000LL;  // 2020-01-01 00:00:00 UTC
+
+    static constexpr uint64_t kSeqMask = (1ULL << kSeqBits) - 1;
+    static constexpr uint64_t kStampMask = (1ULL << (kSeqBits + kTimeBits)) - 1;  // 毫秒 + 序号
+    static constexpr size_t kMaxShards = 1u << kShardBits;
+
+    // stamp = 毫秒 << 16 | 序号 (由生成方保证单调)
+    static TaskHandle Make(uint64_t stamp, size_t shard) {
+        TaskHandle h;
+        h.value = (static_cast<uint64_t>(shard) << (kSeqBits + kTimeBits)) | (stamp & kStampMask);
+        return h;
+    }
+
+    // unix 毫秒对应的最小 stamp (序号为 0)
+    static uint64_t StampFloor(int64_t unixMs) {
+        int64_t ms = unixMs > kEpochMs ? unixMs - kEpochMs : 0;
+        return (static_cast<uint64_t>(ms) << kSeqBits) & kStampMask;
+    }
+
+    bool Valid() const { return value != 0; }
+    size_t Shard() const { return static_cast<size_t>(value >> (kSeqBits + kTimeBits)); }
+    int64_t UnixMs() const { return kEpochMs + static_cast<int64_t>((value & kStampMask) >> kSeqBits); }
+    uint32_t Seq() const { return static_cast<uint32_t>(value & kSeqMask); }
+
+    // 日志用 : 定长栈缓冲，LOG_xxx("%s", h.ToText().c_str())
+    struct Text {
+        char buf[48];
+        const char* c_str() const { return buf; }
+    };
+
+    Text ToText() const {
+        Text t;
+        if (!Valid()) {
+            snprintf(t.buf, sizeof(t.buf), "-");
+        } else {
+            snprintf(t.buf, sizeof(t.buf), "T-%lld-%lu-%u",
+                     static_cast<long long>(UnixMs()), static_cast<unsigned long>(Shard()), Seq());
+        }
+        return t;
+    }
+
+    std::string ToString() const { return Valid() ? std::string(ToText().c_str()) : std::string(); }
+
+    // 解析线上格式; 格式不对返回无效句柄
+    static TaskHandle Parse(const char* s) {
+        if (s == nullptr || s[0] != 'T' || s[1] != '-') return {};
+        char* end = nullptr;
+        long long ms = strtoll(s + 2, &end, 10);
+        if (*end != '-') return {};
+        unsigned long shard = strtoul(end + 1, &end, 10);
+        if (*end != '-') return {};
+        unsigned long seq = strtoul(end + 1, &end, 10);
+        if (*end != '\0') return {};
+
+        if (ms < kEpochMs || shard >= kMaxShards || seq > kSeqMask) return {};
+        uint64_t t = static_cast<uint64_t>(ms - kEpochMs);
+        if (t >> kTimeBits) return {};
+        return Make((t << kSeqBits) | seq, shard);
+    }
+    static TaskHandle Parse(const std::string& s) { return Parse(s.c_str()); }
+
+    bool operator==(const TaskHandle& o) const { return value == o.value; }
+    bool operator!=(const TaskHandle& o) const { return value != o.value; }
+    bool operator<(const TaskHandle& o) const { return value < o.value; }
+};
+
+// JSON 边缘 : 与原字符串 taskId 的线上格式兼容 (空串 <-> 无效句柄)
+inline void to_json(nlohmann::json& j, const TaskHandle& h) {
+    j = h.ToString();
+}
+
+inline void from_json(const nlohmann::json& j, TaskHandle& h) {
+    h = j.is_string() ? TaskHandle::Parse(j.get_ref<const std::string&>()) : TaskHandle{};
+}
+
+}
+}
+
+namespace std {
+template <>
+struct hash<agv::model::TaskHandle> {
+    size_t operator()(const agv::model::TaskHandle& h) const noexcept {
+        return std::hash<uint64_t>{}(h.value);
+    }
+};
+}
@@ -36,7 +36,11 @@ enum class MsgType : int32_t {
 
     // 4.寻路业务
     PATH_REQ     = 10, // AGV 请求寻路
-    PATH_RESP    = 11  // Server 返回路径
+    PATH_RESP    = 11, // Server 返回路径
+
+    // 5.交通管制
+    RESERVE_REQ  = 12, // AGV 申请 / 释放前方格子
+    RESERVE_RESP = 13  // Server 返回预约结果
 };
 
 
@@ -49,6 +53,8 @@ inline std::string msgTypeToString(MsgType type) {
         case MsgType::TASK_REPORT:  return "TASK_REPORT";
         case MsgType::PATH_REQ:     return "PATH_REQ";
         case MsgType::PATH_RESP:    return "PATH_RESP";
+        case MsgType::RESERVE_REQ:  return "RESERVE_REQ";
+        case MsgType::RESERVE_RESP: return "RESERVE_RESP";
         default: return "UNKNOWN(" + std::to_string((int32_t)type) + ")";
     }
 }
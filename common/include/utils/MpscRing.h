@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/*
+有界 MPSC 环形队列 (Multi-Producer Single-Consumer, 参考 Disruptor / Vyukov bounded queue)
+用途：多个线程往一个单写者 (Actor) 投递事件，替代 “大家抢同一把 mutex 直接改状态”
+    槽位数组 + 每个槽位一个序号 seq：
+        生产者 : CAS 抢占 tail_ 上的一个位置，写入数据后把槽位 seq 置为 pos + 1 (发布)
+        消费者 : 只有一个，直接读 head_ 位置的槽位，seq == head + 1 说明已发布; 取走后把 seq 置为 head + 容量 (归还)
+    生产者之间只在 tail_ 上 CAS，消费者不与任何人竞争; 没有锁，也没有每个事件一次的堆分配
+    容量固定 (2 的幂)，满了 TryPush 返回 false，由调用方决定等待还是丢弃 (背压)
+head_ / tail_ 分别独占缓存行，避免生产者与消费者之间的伪共享
+*/
+
+template <typename T>
+class MpscRing {
+public:
+    // capacity 向上取整到 2 的幂 (至少 2)
+    explicit MpscRing(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        cells_.reset(new Cell[cap]);
+        for (size_t i = 0; i < cap; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // 任意线程; 只有成功时才会移走 v
+    bool TryPush(T& v) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = cells_[pos & mask_];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.data = std::move(v);
+                    c.seq.store(pos + 1, std::memory_order_release);  // 发布
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;  // 满 : 该槽位还没被消费者归还
+            }
+            else {
+                pos = tail_.load(std::memory_order_relaxed);  // 被别的生产者抢先了
+            }
+        }
+    }
+
+    // 仅消费者线程
+    bool TryPop(T& out) {
+        Cell& c = cells_[head_ & mask_];
+        if (c.seq.load(std::memory_order_acquire) != head_ + 1) return false;
+
+        out = std::move(c.data);
+        c.data = T();  // 尽早释放槽位里持有的资源 (shared_ptr 等)
+        c.seq.store(head_ + mask_ + 1, std::memory_order_release);  // 归还
+        ++head_;
+        return true;
+    }
+
+    // 仅消费者线程 : 是否有已发布的元素
+    bool Empty() const {
+        return cells_[head_ & mask_].seq.load(std::memory_order_acquire) != head_ + 1;
+    }
+
+    size_t Capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    size_t mask_ = 0;
+    std::unique_ptr<Cell[]> cells_;
+
+    alignas(64) std::atomic<size_t> tail_{0};  // 生产者
+    alignas(64) size_t head_ = 0;              // 消费者独占
+};
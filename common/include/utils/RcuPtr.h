@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+/*
+RCU 指针 (读多写少的不可变快照，参考 Linux SRCU 的双计数器宽限期)
+用途：替代 std::atomic_load / atomic_store(shared_ptr) —— libstdc++ 里那两个函数是按地址哈希到一把全局自旋锁上实现的，
+     每次读都要抢锁，并不是无锁; 读者还要对快照做一次引用计数增减，所有读者挤在同一个控制块的缓存行上
+读 : Read() 拿到一个守卫，守卫存活期间快照不会被释放
+    1. 读全局纪元 e，在 e 的奇偶分组里给自己所在的条带计数 +1
+    2. 再读一次纪元，还是 e 才算进入 (否则说明写者刚翻过纪元，撤销计数重来)，然后读当前指针
+    只有原子加减与读，不拿锁; 唯一的重试发生在恰好撞上写者翻纪元时 (写者已经前进了，整体不会卡住)
+写 : Exchange() 发布新对象，等宽限期结束后把旧对象交还调用方 (调用方在锁外析构)
+    1. 原子交换指针 : 之后进入的读者只会看到新对象
+    2. 纪元 +1 : 之后进入的读者都计在另一组
+    3. 等旧分组各条带计数归零 : 可能拿到旧对象的读者都在旧分组里，它们全部离开后旧对象就没人在读了
+    写者之间不能并发 (由调用方的锁串行化); 写者会等读者，读者临界区只应做查找 + 拷贝，不要在里面阻塞
+条带 : 计数按线程散到 kStripes 条缓存行上，读者之间不在同一个计数器上争抢
+*/
+
+template <typename T>
+class RcuPtr {
+public:
+    static constexpr size_t kStripes = 16;
+
+    explicit RcuPtr(std::unique_ptr<T> init) : ptr_(init.release()) {}
+    ~RcuPtr() { delete ptr_.load(std::memory_order_relaxed); }
+
+    RcuPtr(const RcuPtr&) = delete;
+    RcuPtr& operator=(const RcuPtr&) = delete;
+
+    // 读守卫 : 只能移动，析构时离开临界区
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& o) noexcept : counter_(o.counter_), ptr_(o.ptr_) { o.counter_ = nullptr; }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+        ~ReadGuard() { if (counter_) counter_->fetch_sub(1, std::memory_order_release); }
+
+        const T* get() const { return ptr_; }
+        const T* operator->() const { return ptr_; }
+        const T& operator*() const { return *ptr_; }
+
+    private:
+        friend class RcuPtr;
+        ReadGuard(std::atomic<int64_t>* counter, const T* ptr) : counter_(counter), ptr_(ptr) {}
+
+        std::atomic<int64_t>* counter_;
+        const T* ptr_;
+    };
+
+    // 任意线程
+    ReadGuard Read() const {
+        const size_t stripe = StripeOfThisThread();
+        for (;;) {
+            uint64_t e = epoch_.load(std::memory_order_seq_cst);
+            std::atomic<int64_t>& c = readers_[e & 1][stripe].count;
+            c.fetch_add(1, std::memory_order_seq_cst);
+            if (epoch_.load(std::memory_order_seq_cst) == e) {
+                return ReadGuard(&c, ptr_.load(std::memory_order_seq_cst));
+            }
+            c.fetch_sub(1, std::memory_order_relaxed);  // 撞上翻纪元 : 撤销重来
+        }
+    }
+
+    // 仅写者 (持有调用方的写锁) : 读当前对象，用于 复制 -> 修改
+    const T* Peek() const { return ptr_.load(std::memory_order_acquire); }
+
+    // 仅写者 (持有调用方的写锁) : 发布 next，等宽限期结束后返回旧对象
+    std::unique_ptr<T> Exchange(std::unique_ptr<T> next) {
+        T* old = ptr_.exchange(next.release(), std::memory_order_seq_cst);
+        uint64_t e = epoch_.fetch_add(1, std::memory_order_seq_cst);
+        for (auto& r : readers_[e & 1]) {
+            while (r.count.load(std::memory_order_seq_cst) != 0) std::this_thread::yield();
+        }
+        return std::unique_ptr<T>(old);
+    }
+
+private:
+    // 线程首次读时轮转分配条带
+    static size_t StripeOfThisThread() {
+        static std::atomic<size_t> next{0};
+        static thread_local const size_t stripe = next.fetch_add(1, std::memory_order_relaxed) % kStripes;
+        return stripe;
+    }
+
+    struct alignas(64) Counter {
+        std::atomic<int64_t> count{0};
+    };
+
+    std::atomic<T*> ptr_;
+    alignas(64) std::atomic<uint64_t> epoch_{0};
+    mutable Counter readers_[2][kStripes];
+};
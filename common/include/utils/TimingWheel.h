@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+分层时间轮 (Hierarchical Timing Wheel, 参考 Varghese & Lauck / Linux 内核 timer wheel)
+用途：大量 “到期时间经常被推后” 的定时器，比如每个执行中任务的进度看门狗 —— 每次上报都要重新定时
+    4 层 × 64 槽，第 L 层一个槽覆盖 64^L 个 tick; tick = 100ms 时可覆盖约 19 天
+    定时器按 “到期 tick 与当前 tick 最高的不同 6 位组” 放层 :
+        与当前 tick 只差低 6 位 -> 第 0 层，精确到 tick
+        差得越高放得越高，当前 tick 走到该槽的起点时整槽下沉 (cascade) 到低层
+    Arm (定时 / 重新定时) : 哈希表找到节点 + list splice 挪到新槽，O(1)，重新定时不分配内存
+    Cancel : O(1)
+    Advance : 每走一个 tick 处理一个第 0 层槽 (+ 偶尔的下沉)，均摊 O(1) + 到期数; 轮子空时直接跳到当前时间
+超出最高层范围的定时器先放在最高层最远的槽，下沉时再按真实到期时间重新放
+非线程安全 : 由持有者 (单写者线程) 独占使用
+*/
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class TimingWheel {
+public:
+    struct Expired {
+        Key key;
+        Value value;
+    };
+
+    explicit TimingWheel(int64_t tickMs = 100) : tickMs_(tickMs > 0 ? tickMs : 1) {}
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    // 定时 / 重新定时 : deadlineMs 到期 (毫秒，与 Advance 的 nowMs 同一时间基准)
+    // 时间起点由 Advance 设定 (轮子空时 Advance 直接跳到 nowMs)，首次 Arm 之前应先 Advance 一次
+    void Arm(const Key& key, const Value& value, int64_t deadlineMs) {
+        int64_t tick = (deadlineMs + tickMs_ - 1) / tickMs_;  // 向上取整 : 只会晚到不超过一个 tick，不会提前
+        if (!started_) {  // 没 Advance 过 : 以第一个定时器为时间起点
+            curTick_ = tick - 1;
+            started_ = true;
+        }
+        if (tick <= curTick_) tick = curTick_ + 1;  // 已过期 : 下一个 tick 触发
+
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            Bucket& b = Slot(tick);
+            b.list.push_back(Node{key, value, tick});
+            index_.emplace(key, Pos{&b, std::prev(b.list.end())});
+            return;
+        }
+
+        // 已存在 : 改到期时间，挪到新槽 (splice 不分配内存)
+        Pos& pos = it->second;
+        pos.it->value = value;
+        pos.it->tick = tick;
+        Bucket& b = Slot(tick);
+        if (&b != pos.bucket) {
+            b.list.splice(b.list.end(), pos.bucket->list, pos.it);
+            pos.bucket = &b;
+        }
+    }
+
+    bool Cancel(const Key& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) return false;
+        it->second.bucket->list.erase(it->second.it);
+        index_.erase(it);
+        return true;
+    }
+
+    bool Contains(const Key& key) const { return index_.count(key) > 0; }
+    size_t Size() const { return index_.size(); }
+    bool Empty() const { return index_.empty(); }
+    int64_t TickMs() const { return tickMs_; }
+
+    // 推进到 nowMs，到期的定时器移出轮子并追加到 out (回调由调用方在之后执行，避免遍历中改轮子)
+    void Advance(int64_t nowMs, std::vector<Expired>& out) {
+        int64_t target = nowMs / tickMs_;
+        if (!started_ || index_.empty()) {
+            curTick_ = target;
+            started_ = true;
+            return;
+        }
+
+        while (curTick_ < target && !index_.empty()) {
+            ++curTick_;
+
+            // 1. 下沉 : curTick_ 走到第 L 层某槽的起点时，把该槽的定时器按真实到期时间重新放 (高层先下沉)
+            int top = 0;
+            while (top + 1 < kLevels && (curTick_ & ((int64_t(1) << (kBits * (top + 1))) - 1)) == 0) ++top;
+            for (int level = top; level >= 1; --level) {
+                Bucket& b = wheels_[level][(curTick_ >> (kBits * level)) & kMask];
+                while (!b.list.empty()) {
+                    auto nit = b.list.begin();
+                    Bucket& dst = Slot(nit->tick);
+                    dst.list.splice(dst.list.end(), b.list, nit);
+                    index_[nit->key].bucket = &dst;
+                }
+            }
+
+            // 2. 到期 : 第 0 层当前槽
+            Bucket& b = wheels_[0][curTick_ & kMask];
+            while (!b.list.empty()) {
+                Node& n = b.list.front();
+                out.push_back(Expired{n.key, n.value});
+                index_.erase(n.key);
+                b.list.pop_front();
+            }
+        }
+        if (curTick_ < target) curTick_ = target;  // 轮子空了 : 直接跳到当前时间
+    }
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kBits = 6;
+    static constexpr int64_t kMask = (int64_t(1) << kBits) - 1;
+
+    struct Node {
+        Key key;
+        Value value;
+        int64_t tick;  // 真实到期 tick
+    };
+    struct Bucket {
+        std::list<Node> list;
+    };
+    struct Pos {
+        Bucket* bucket;
+        typename std::list<Node>::iterator it;
+    };
+
+    // tick 应落在哪个槽 (相对 curTick_)
+    Bucket& Slot(int64_t tick) {
+        if (tick <= curTick_) return wheels_[0][curTick_ & kMask];  // 下沉时恰好到期 : 当前 tick 触发
+
+        for (int level = 0; level + 1 < kLevels; ++level) {
+            int shift = kBits * (level + 1);
+            if ((tick >> shift) == (curTick_ >> shift)) return wheels_[level][(tick >> (kBits * level)) & kMask];
+        }
+
+        // 最高层 : 最多领先 63 个槽，否则 (超出范围) 放最远的槽，下沉时再按真实到期时间重新放
+        int shift = kBits * (kLevels - 1);
+        int64_t ahead = (tick >> shift) - (curTick_ >> shift);
+        if (ahead <= kMask) return wheels_[kLevels - 1][(tick >> shift) & kMask];
+        return wheels_[kLevels - 1][((curTick_ >> shift) - 1) & kMask];
+    }
+
+    int64_t tickMs_;
+    int64_t curTick_ = 0;
+    bool started_ = false;
+
+    Bucket wheels_[kLevels][1 << kBits];
+    std::unordered_map<Key, Pos, Hash> index_;
+};
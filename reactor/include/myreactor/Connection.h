@@ -82,6 +82,9 @@ public:
     std::string ip() const;
     uint16_t port() const;
 
+    // 所属 IO 线程的事件循环 (业务层借它做 “本轮事件处理完之后” 的合批)
+    EventLoop* getLoop() const { return loop_; }
+
     // 用于在TcpServer::newconnection中,对象创建后立即建立 Channel 与 Connection 的弱绑定
     void connectEstablished();
 
@@ -61,6 +61,14 @@ private:
     // 3.定时器机制
     int timerFd_;
     std::unique_ptr<Channel> timerChannel_;
+
+    // 附加的周期定时器 : 各自一个 timerfd，节拍与主 tick (1s) 无关
+    struct PeriodicTimer {
+        int fd;
+        std::unique_ptr<Channel> channel;
+        CB cb;
+    };
+    std::vector<std::unique_ptr<PeriodicTimer>> periodic_;
     
     // 内部辅助函数
     static int createEventfd();  // 与 Socket::createNonblocking() 形式统一，都是输出一个fd （static是为了在构造函数中调用，此时没有一个成功创建的对象，那么函数应该直接依赖/属于类 而不是 对象，因此用 static）
@@ -101,6 +109,8 @@ public:
     void removechannel(Channel* ch);
 
     void settimercb(const CB& fn);
+    // 每 intervalMs 毫秒在本 Loop 线程回调一次 fn (Loop 启动前或 Loop 线程内调用)
+    void runevery(int intervalMs, const CB& fn);
 
     //----跨线程调用核心----
     // 判断当前是否在 Loop 所在的线程
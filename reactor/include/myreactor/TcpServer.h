@@ -118,6 +118,8 @@ public:
 
     
     inline void setTickcb(const TickCB& cb) {tickcb_ = cb;}
+    // 比 1s tick 更细的周期任务 (在主 Loop 线程执行，start() 之前注册)
+    inline void runevery(int intervalMs, const TickCB& cb) {mainloop_.runevery(intervalMs, cb);}
 
 
    
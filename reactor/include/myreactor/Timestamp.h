@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <cstdint>
 /*
 配合 Reactor（微秒级）和 AGV（毫秒级），这个类必须同时支持两种转换，并且提供比较运算符（方便 TcpServer 判断超时）
 */
@@ -15,6 +16,15 @@ public:
 
     static Timestamp now(); // 当前时间
 
+    /*
+    可注入时钟 : 离线仿真用虚拟时间替换系统时钟
+        ClockFunc 返回“当前微秒数”; 传 nullptr 恢复系统时钟
+        用普通函数指针 + 原子量存放，now() 的额外开销只有一次 relaxed load
+    注意：只影响 Timestamp::now()，EventLoop 的超时 / 定时器仍走内核时钟
+    */
+    using ClockFunc = int64_t (*)();
+    static void setClock(ClockFunc clock);
+
     // 给 Logger 用 ：格式化输出 
     std::string toFormattedString(bool showMs = true) const;
 
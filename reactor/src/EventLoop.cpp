@@ -84,6 +84,11 @@ EventLoop::EventLoop()
 
 
 EventLoop::~EventLoop() {
+    // 先把 Channel 从 epoll 摘掉再关 fd
+    for (auto& t : periodic_) {
+        t->channel.reset();
+        ::close(t->fd);
+    }
     ::close(wakeupFd_);
     if (timerFd_ != -1) ::close(timerFd_);
     delete ep_;
@@ -201,6 +206,32 @@ void EventLoop::settimercb(const CB& fn){
     }
 }
 
+// 附加周期定时器 : 与主 tick 同样走 timerfd，只是间隔按毫秒给
+void EventLoop::runevery(int intervalMs, const CB& fn){
+    if(intervalMs <= 0 || !fn) return;
+
+    auto t = std::make_unique<PeriodicTimer>();
+    t->fd = createTimerfd();
+    t->cb = fn;
+    t->channel = std::make_unique<Channel>(this, t->fd);
+    PeriodicTimer* raw = t.get();  // 生命周期与 Loop 相同
+    t->channel->setreadcallback([raw]() {
+        readTimer(raw->fd);
+        raw->cb();
+    });
+    t->channel->enablereading();
+
+    struct itimerspec howlong;
+    memset(&howlong, 0 , sizeof(howlong));
+    howlong.it_value.tv_sec = intervalMs / 1000;
+    howlong.it_value.tv_nsec = (intervalMs % 1000) * 1000000L;
+    howlong.it_interval = howlong.it_value;
+    if(::timerfd_settime(t->fd, 0, &howlong, NULL) == -1){
+        perror("timerfd_settime failed");
+    }
+    periodic_.push_back(std::move(t));
+}
+
 // ---- 线程安全相关----
 
 bool EventLoop::isInLoopThread() const {
@@ -3,6 +3,7 @@
 // #include <time.h>
 #include <stdio.h>
 #include <chrono>
+#include <atomic>
 
 using namespace myreactor;
 
@@ -26,7 +27,17 @@ Timestamp::Timestamp(int64_t usSinceEpoch)
 std::chrono（C++11+）实现 : 跨平台（Linux/macOS/Windows/ 嵌入式）
 gettimeofday 实现 : 仅支持 POSIX 系统（Linux/Unix/macOS），Windows 无此函数
 */
+// 注入的时钟 (nullptr 表示系统时钟)
+static std::atomic<Timestamp::ClockFunc> g_clock{nullptr};
+
+void Timestamp::setClock(ClockFunc clock) {
+    g_clock.store(clock, std::memory_order_release);
+}
+
 Timestamp Timestamp::now() {
+    if (ClockFunc clock = g_clock.load(std::memory_order_acquire)) {
+        return Timestamp(clock());
+    }
     // 现代 C++ 写法，微秒级精度  microseconds 是微秒，缩写 us
     auto now_time = std::chrono::system_clock::now();
     auto duration_in_us = std::chrono::duration_cast<std::chrono::microseconds>(now_time.time_since_epoch());
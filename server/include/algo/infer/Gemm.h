@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/*
+轻量级 CPU 推理内核 (无第三方依赖)
+    只服务于调度场景下的小 MLP：输入特征维度几十、隐层几十到几百、行数 (任务×车辆 对) 上万。
+    这种形状下瓶颈在 "访存" 而不是 "算力"，所以核心手段是：
+        1. 权重预转置 (K×N 行主序)：内层循环沿 N 连续访存，天然适合 SIMD 向量化
+        2. 分块 (Cache Blocking)：K 方向按 KC 切块，一块 B 常驻 L1/L2；M 方向按 4 行一组复用同一条 B 行
+        3. 编译期分派：有 AVX2+FMA 时走手写 intrinsics，否则走可被编译器自动向量化的标量循环
+*/
+
+namespace agv {
+namespace algo {
+namespace infer {
+
+enum class Activation : uint32_t {
+    NONE = 0,
+    RELU = 1,
+    TANH = 2
+};
+
+// C[M×N] = A[M×K] · B[K×N] + bias[N]   (全部行主序; bias 可为 nullptr)
+void GemmBias(const float* A, const float* B, const float* bias, float* C,
+              int M, int N, int K);
+
+// 逐元素激活 (原地)
+void ApplyActivation(float* data, size_t n, Activation act);
+
+// 编译期选中的内核名字，用于启动日志
+const char* GemmKernelName();
+
+}
+}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "algo/infer/Gemm.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+MLP 策略网络 (部署态 SAC Actor 的确定性输出)
+    训练侧 (Python) 导出为自定义二进制文件，服务端只做前向，不依赖 ONNX/LibTorch。
+
+权重文件格式 (小端, 全部 4 字节对齐):
+    [Header]
+        uint32 magic       = 0x504C4D41 ('AMLP')
+        uint32 version     = 1
+        uint32 inputDim    特征维度 (需与调度器的特征定义一致)
+        uint32 numLayers
+        float  posScale    坐标/距离归一化尺度
+        float  timeScale   等待时间归一化尺度 (秒)
+        float  queueScale  虚拟队列归一化尺度
+    [Layer] × numLayers
+        uint32 in, uint32 out, uint32 activation (0=NONE 1=RELU 2=TANH)
+        float  weight[out][in]   (PyTorch nn.Linear 原生布局)
+        float  bias[out]
+    最后一层 out 必须为 1 (每个 任务-车辆 对输出一个偏好分 logit)
+*/
+
+namespace agv {
+namespace algo {
+namespace infer {
+
+struct DenseLayer {
+    int in = 0;
+    int out = 0;
+    Activation act = Activation::NONE;
+    std::vector<float> wt;    // 加载时转置为 in×out 行主序，供 GemmBias 连续访存
+    std::vector<float> bias;  // out
+};
+
+// 特征归一化参数：跟随模型文件走，保证训练/部署一致
+struct FeatureScale {
+    float pos = 50.0f;
+    float time = 60.0f;
+    float queue = 100.0f;
+};
+
+class MlpPolicy {
+public:
+    static constexpr uint32_t kMagic = 0x504C4D41; // 'AMLP'
+    static constexpr uint32_t kVersion = 1;
+
+    MlpPolicy() = default;
+    ~MlpPolicy() = default;
+
+    // 从二进制文件加载; 失败返回 false 且保持未加载状态
+    bool Load(const std::string& path);
+
+    bool IsLoaded() const { return !layers_.empty(); }
+    int InputDim() const { return inputDim_; }
+    const FeatureScale& Scale() const { return scale_; }
+
+    // 批量前向: x 为 rows×InputDim 行主序, out 写入 rows 个 logit
+    // 非线程安全 (内部复用乒乓缓冲区)，由调用方串行化
+    void Forward(const float* x, int rows, std::vector<float>& out);
+
+private:
+    int inputDim_ = 0;
+    FeatureScale scale_;
+    std::vector<DenseLayer> layers_;
+
+    // 层间激活的乒乓缓冲：容量只增不减，稳态下前向零分配
+    std::vector<float> bufA_;
+    std::vector<float> bufB_;
+};
+
+}
+}
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include "ITScheduler.h"
+#include "manager/IndexedTaskQueue.h"
+#include <unordered_map>
 
 namespace agv {
 namespace algo {
@@ -12,7 +14,8 @@ public:
 
     std::vector<DispatchResult> Dispatch(
         const std::vector<std::shared_ptr<manager::TaskContext>>& tasks,
-        const std::vector<model::AgvInfo>& candidates
+        const std::vector<model::AgvInfo>& candidates,
+        const Backlog& backlog
     ) override;
     /*
     override (以及 virtual, static)：这些关键字只用于头文件 (.h) 中的类声明里。它们是用来告诉编译器类的结构和继承关系的。
@@ -22,6 +25,33 @@ public:
         return "Greedy/NearestNeighbor";
     }
 
+    // ================= 增量模式 =================
+    bool SupportsIncremental() const override { return true; }
+    void Reset() override;
+    void OnTaskAdded(const std::shared_ptr<manager::TaskContext>& task, bool requeue) override;
+    void OnTaskRemoved(model::TaskHandle taskId) override;
+    void OnAgvFreed(const model::AgvInfo& agv) override;
+    void OnAgvBusy(int agvId) override;
+    void OnAgvMoved(int agvId, const model::Point& pos) override;
+    std::vector<DispatchResult> DispatchIncremental() override;
+
+private:
+    using spTask = std::shared_ptr<manager::TaskContext>;
+
+    // 待派任务 : 与 TaskManager::pendingTasks_ 同结构、同排队键 (TaskContext::rank)，保证两种模式派单顺序一致
+    manager::IndexedTaskQueue queue_;
+
+    // 可派车辆 : uid -> (当前位置 / 预计空闲位置, 空闲前剩余格数)
+    struct FreeAgv {
+        model::Point pos;
+        int etaCells = 0;
+    };
+    std::unordered_map<int, FreeAgv> freeAgvs_;
+
+    // 每轮复用的工作区
+    std::vector<spTask> taskScratch_;
+    std::vector<std::pair<int, FreeAgv>> freeScratch_;
+    std::vector<char> usedScratch_;
 };
 
 
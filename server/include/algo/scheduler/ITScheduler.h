@@ -25,21 +25,65 @@ struct DispatchResult {
     std::shared_ptr<manager::TaskContext> task;
     int agvId;
     int Distance;   // 用于日志
+    // 可选 : 紧跟首单之后的有序后续任务 (并单)。调度器不填时由 TaskManager 用插入启发式补全
+    std::vector<std::shared_ptr<manager::TaskContext>> followUps;
+};
+
+// 本轮积压 : 全量模式下 tasks 只是队首一个窗口，积压总量与到达量由分片单独统计后传入
+struct Backlog {
+    size_t pending = 0;   // 本轮开始时等待队列里的任务总数 (不止窗口)
+    size_t arrivals = 0;  // 上一轮开始以来进入等待队列的任务数 (新建 + 回滚)
 };
 
 class ITScheduler {  // 抽象类,仅提供一种接口规范
 public:
     virtual ~ITScheduler() = default;
 
-    // 任务调度接口 : 输入：待调度的任务列表, 可用的车辆列表; 输出：调度解落列表
+    // 任务调度接口 : 输入：待调度的任务列表, 可用的车辆列表, 本轮积压; 输出：调度解落列表
     virtual std::vector<DispatchResult> Dispatch(
         const std::vector<std::shared_ptr<manager::TaskContext>>& tasks,
-        const std::vector<model::AgvInfo>& candidates
+        const std::vector<model::AgvInfo>& candidates,
+        const Backlog& backlog
     ) = 0; // 纯虚函数
 
     // 获取算法名字,用于日志打印
     virtual std::string Name() const = 0;
 
+    // ================= 增量模式 (可选) =================
+    /*
+    全量模式：每轮都把全部 pending 任务 + 全部可用车辆重新喂给 Dispatch，开销与积压量成正比
+    增量模式：调度器自己维护 待派任务集 / 可用车辆集 以及代价结构，TaskManager 只喂变化量 (delta)
+        一轮的开销只与本轮变化量有关 : 没有新车空出、也没有新任务时，DispatchIncremental 直接返回
+    调用约定 (由 TaskManager 保证)：
+        1. 所有 OnXxx / DispatchIncremental 都在调度轮次内串行调用 (同一时刻最多一轮)，实现方无需加锁
+        2. DispatchIncremental 只给出提案，不修改内部状态; 真正派出去的，TaskManager 会回调 OnTaskRemoved + OnAgvBusy
+        3. 切换到本调度器时先 Reset()，再把全量状态按 delta 的形式重放一遍
+    默认实现：不支持增量，TaskManager 走全量 Dispatch
+    */
+    virtual bool SupportsIncremental() const { return false; }
+
+    // 清空内部状态 (切换调度器 / 重新同步时)
+    virtual void Reset() {}
+
+    // 任务进入待派集合; requeue = true 表示回滚重派，应排在队首
+    virtual void OnTaskAdded(const std::shared_ptr<manager::TaskContext>& task, bool requeue) { (void)task; (void)requeue; }
+
+    // 任务离开待派集合 (已派出 / 取消)
+    virtual void OnTaskRemoved(model::TaskHandle taskId) { (void)taskId; }
+
+    // 车辆变为可派 (空闲、有电、无在途任务; 或预计很快空闲的预测候选，etaCells > 0)
+    // 对已可派的车重复调用表示更新 (位置 / etaCells 变化)
+    virtual void OnAgvFreed(const model::AgvInfo& agv) { (void)agv; }
+
+    // 车辆变为不可派 (已派单 / 忙碌 / 没电 / 离线)
+    virtual void OnAgvBusy(int agvId) { (void)agvId; }
+
+    // 可派车辆的位置变化
+    virtual void OnAgvMoved(int agvId, const model::Point& pos) { (void)agvId; (void)pos; }
+
+    // 基于内部状态给出本轮派单提案
+    virtual std::vector<DispatchResult> DispatchIncremental() { return {}; }
+
 };
 
 
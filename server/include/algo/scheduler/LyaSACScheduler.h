@@ -1,33 +1,92 @@
 #pragma once
 #include "ITScheduler.h"
+#include "algo/infer/MlpPolicy.h"
+#include <mutex>
+
+/*
+Lyapunov-SAC 调度器 (部署态)
+    离线：SAC 训练 Actor 网络，对每个 (任务, 车辆) 对输出偏好分 logit
+    在线：本类做三件事
+        1. 候选剪枝：每个任务只保留曼哈顿距离最近的 topK 辆车，把 T×A 对压到 T×K，保证 500 车规模单核可在一轮内算完
+        2. 批量推理：所有候选对拼成一个特征矩阵，一次 MlpPolicy::Forward (分块 GEMM) 得到全部 logit
+        3. 漂移加惩罚 (Drift-plus-Penalty)：维护积压虚拟队列 Q，
+               Q(t+1) = max(Q(t) - served(t), 0) + arrivals(t) + carried(t)
+           carried 为上一轮派完仍在等的任务数 : 没人接的任务每多等一轮就把 Q 再抬高一次
+           每个候选对的决策代价为  V·(-logit) - Q，只有 < 0 (即 V·logit + Q > 0) 才派单
+           Q 小时只接“好单”、给后续任务留车；Q 随等待增长，门槛终会放到任何 logit 之下，远单不会被永远搁置
+特征定义 (kFeatureDim = 8，需与训练侧一致):
+    [dx, dy, 曼哈顿距离, 电量, 任务等待时间, 优先级, 虚拟队列 Q, 积压任务/车辆 比]
+模型未加载时退化为 全局最近优先的一对一匹配 (按 候选对距离 升序，不设 DPP 门槛)，与 Greedy 同样有车就派，保证可以安全切换
+*/
 
 namespace agv {
 namespace algo {
-namespace scheduler{
+namespace scheduler {
 
 class LyaSACScheduler : public ITScheduler {
-    /*
-    LyaSACScheduler() {
-        // TODO: Init Python Interpreter or Load ONNX Model
-        // printf("Loading SAC Policy Network...\n");
-    }*/
+public:
+    static constexpr int kFeatureDim = 8;
+
+    // lyaV: 漂移加惩罚中的权衡系数 V; topK: 每个任务保留的候选车数量
+    explicit LyaSACScheduler(double lyaV = 10.0, int topK = 16);
+    ~LyaSACScheduler() override = default;
+
+    // 加载策略网络; 失败时保持启发式退化模式
+    bool LoadModel(const std::string& path);
 
     std::vector<DispatchResult> Dispatch(
         const std::vector<std::shared_ptr<manager::TaskContext>>& tasks,
-        const std::vector<model::AgvInfo>& candidates
-    ) override {
-        std::vector<DispatchResult> results;
-        
-        // ...
-
-        return results;
-    }
+        const std::vector<model::AgvInfo>& candidates,
+        const Backlog& backlog
+    ) override;
 
     inline std::string Name() const override {
         return "Lyapunov-SAC-RL";
     }
+
+    // 监控接口
+    double VirtualQueue() const;
+
+private:
+    // 一个 (任务, 车辆) 候选对
+    struct Pair {
+        int taskIdx;
+        int agvIdx;
+        int dist;
+    };
+
+    // 增量更新虚拟队列 : O(1)，到达量由调用方给出
+    void UpdateVirtualQueue(const Backlog& backlog);
+
+    void BuildPairs(const std::vector<std::shared_ptr<manager::TaskContext>>& tasks,
+                    const std::vector<model::AgvInfo>& candidates);
+
+    void BuildFeatures(const std::vector<std::shared_ptr<manager::TaskContext>>& tasks,
+                       const std::vector<model::AgvInfo>& candidates,
+                       const Backlog& backlog);
+
+private:
+    const double lyaV_;
+    const int topK_;
+
+    infer::MlpPolicy policy_;
+
+    // 调度器状态 : Dispatch 可能被多个 worker 并发调用，统一串行化
+    mutable std::mutex mutex_;
+
+    // Lyapunov 虚拟队列状态
+    double virtualQ_ = 0.0;
+    size_t lastPending_ = 0;
+    size_t lastServed_ = 0;
+
+    // 每轮复用的工作区 (容量只增不减)
+    std::vector<Pair> pairs_;
+    std::vector<float> features_;
+    std::vector<float> logits_;
+    std::vector<int> order_;
+    std::vector<std::pair<int, int>> distScratch_; // (dist, agvIdx)
 };
 
 }
 }
-}
\ No newline at end of file
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "ITScheduler.h"
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+/*
+组合调度器 (Portfolio)：把多个调度策略放在同一个快照上“赛马”，按统一代价模型择优提交
+    1. 基线策略 (第一个注册的) 在调用线程上同步执行，保证每轮一定有解，不会因为实验策略变差 / 变慢拖垮车队
+    2. 其余策略投递到内部线程池并行执行，基线跑完后最多再等到时间预算截止; 超时未返回的本轮作废
+       (迟到的结果写入已过期的轮次状态，直接丢弃)
+    3. 所有按时返回的解用同一个代价模型打分 (不信任策略自报的 Distance)：
+           cost = Σ (etaCells + 曼哈顿距离(车, 任务)) - assignBonus × 派单数
+       同时校验合法性 (一车多单 / 一单多车 / 车不在候选集 → 整个解作废)
+    4. 记录每个策略的 胜出次数 / 超时次数 / 耗时，定期打印，用于判断哪个策略值得它占用的 CPU
+并发约定：上一轮超时仍在运行的策略，本轮跳过 (记为 skipped)，避免同一策略实例被并发调用
+*/
+
+namespace myreactor {
+    class ThreadPool;
+}
+
+namespace agv {
+namespace algo {
+namespace scheduler {
+
+class PortfolioScheduler : public ITScheduler {
+public:
+    // 单个策略的统计 (快照)
+    struct StrategyStats {
+        std::string name;
+        uint64_t rounds = 0;      // 参与 (按时返回) 的轮数
+        uint64_t wins = 0;        // 胜出轮数
+        uint64_t timeouts = 0;    // 超出预算的轮数
+        uint64_t skipped = 0;     // 因上一轮仍未结束而跳过的轮数
+        uint64_t invalid = 0;     // 解不合法被丢弃的轮数
+        double avgLatencyUs = 0;
+        int64_t maxLatencyUs = 0;
+    };
+
+    // budgetMs: 每轮等待实验策略的时间预算; assignBonus: 每多派一单的代价奖励 (与距离同量纲)
+    explicit PortfolioScheduler(int budgetMs = 20, int assignBonus = 50, int statsEveryRounds = 100);
+    ~PortfolioScheduler() override;
+
+    // 注册策略 : 第一个为基线。须在首轮 Dispatch 前完成注册
+    void AddStrategy(std::shared_ptr<ITScheduler> strategy);
+
+    std::vector<DispatchResult> Dispatch(
+        const std::vector<std::shared_ptr<manager::TaskContext>>& tasks,
+        const std::vector<model::AgvInfo>& candidates,
+        const Backlog& backlog
+    ) override;
+
+    std::string Name() const override;
+
+    // 监控接口
+    std::vector<StrategyStats> GetStats() const;
+
+    // 统一代价模型; 解不合法时返回 false
+    static bool Evaluate(const std::vector<DispatchResult>& results,
+                         const std::vector<model::AgvInfo>& candidates,
+                         int assignBonus, int64_t& cost);
+
+private:
+    struct Strategy;
+    struct Round;
+
+    void Record(Strategy& s, int64_t latencyUs);
+    void LogStats() const;
+
+private:
+    const std::chrono::milliseconds budget_;
+    const int assignBonus_;
+    const int statsEvery_;
+
+    std::vector<std::shared_ptr<Strategy>> strategies_;
+    std::unique_ptr<myreactor::ThreadPool> pool_;  // 实验策略的执行线程 (首轮时按策略数启动)
+
+    // 统计数据
+    mutable std::mutex statsMutex_;
+    uint64_t totalRounds_ = 0;
+};
+
+}
+}
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "ITScheduler.h"
+#include "config/ServerConfig.h"
+
+/*
+调度器工厂 : 按配置构造调度策略
+    AgvServer 与离线仿真 (FleetSimulator) 共用，保证两边跑的是同一套策略配置
+*/
+
+namespace agv {
+namespace algo {
+namespace scheduler {
+
+// 按名字构造单个策略 ("GREEDY" / "LYA_SAC"); 未知名字返回 nullptr
+std::shared_ptr<ITScheduler> CreateStrategy(const std::string& name, const config::SchedulerConfig& cfg);
+
+// 按 cfg.type 构造 (PORTFOLIO 会按 cfg.portfolio 注册参赛策略); 失败时退回 Greedy
+std::shared_ptr<ITScheduler> CreateScheduler(const config::SchedulerConfig& cfg);
+
+}
+}
+}
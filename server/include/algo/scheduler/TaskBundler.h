@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <functional>
+#include "model/AgvStructs.h"
+
+namespace agv {
+    namespace manager {
+        struct TaskContext;
+    }
+}
+
+/*
+并单器 (Bundling) : 最便宜插入法 (Cheapest Insertion)，TSP 构造启发式的一种
+    调度器给某辆车指派了首单 first 后，从待派窗口里挑若干“顺路”的任务串在后面，
+    让车做完一单直接接着做下一单，省掉 上报 -> 调度轮次 -> RPC 往返 的空档
+做法：
+    路线 R = [first, t1, ..., tk] (按目标点)
+    对每个候选 c、每个插入位置 i (只允许插在 first 之后)，插入代价
+        Δ = d(R[i], c) + d(c, R[i+1]) - d(R[i], R[i+1])      (插在末尾时为 d(R[k], c))
+    每次选 Δ 最小者插入，直到满 maxBundle 或者 最小 Δ 超过 maxDetour
+复杂度 O(maxBundle² · |pool|)，pool 是优先队列队首的一个小窗口，与积压总量无关
+first 永远在首位：调度器的决策被完整保留，并单只是“顺手带上”
+*/
+
+namespace agv {
+namespace algo {
+namespace scheduler {
+
+class TaskBundler {
+public:
+    using spTask = std::shared_ptr<manager::TaskContext>;
+    using Filter = std::function<bool(const spTask&)>;
+
+    TaskBundler() = default;
+
+    // maxBundle : 单车序列最大长度 (含首单，<=1 表示关闭); maxDetour : 单次插入允许的最大绕行 (曼哈顿格数)
+    void SetParams(int maxBundle, int maxDetour);
+
+    bool Enabled() const { return maxBundle_ > 1; }
+
+    // 返回后续任务 (不含 first)，顺序即执行顺序; usable 过滤掉不可并单的任务
+    std::vector<spTask> Build(const spTask& first, const std::vector<spTask>& pool, const Filter& usable) const;
+
+private:
+    int maxBundle_ = 1;
+    int maxDetour_ = 0;
+};
+
+}
+}
+}
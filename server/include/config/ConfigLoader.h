@@ -77,6 +77,98 @@ public:
                 toConfig.map.obstacleRatio = m.value("ratio", 0.1);
            }
 
+           if(j.contains("scheduler")) {
+                auto& sc = j["scheduler"];
+                std::string typeStr = sc.value("type", "GREEDY");
+
+                if (typeStr=="LYA_SAC") toConfig.scheduler.type = SchedulerType::LYA_SAC;
+                else if (typeStr=="PORTFOLIO") toConfig.scheduler.type = SchedulerType::PORTFOLIO;
+                else toConfig.scheduler.type = SchedulerType::GREEDY;
+
+                toConfig.scheduler.modelPath = sc.value("model_path", "");
+                toConfig.scheduler.lyaV = sc.value("lya_v", 10.0);
+                toConfig.scheduler.topK = sc.value("top_k", 16);
+
+                if (sc.contains("portfolio")) {
+                    toConfig.scheduler.portfolio = sc["portfolio"].get<std::vector<std::string>>();
+                }
+                toConfig.scheduler.budgetMs = sc.value("budget_ms", 20);
+                toConfig.scheduler.assignBonus = sc.value("assign_bonus", 50);
+                toConfig.scheduler.statsEveryRounds = sc.value("stats_every_rounds", 100);
+           }
+
+           if(j.contains("dispatch")) {
+                auto& d = j["dispatch"];
+                toConfig.dispatch.minIntervalMs = d.value("min_interval_ms", 50);
+                toConfig.dispatch.batchSize = d.value("batch_size", 32);
+                toConfig.dispatch.agingMs = d.value("aging_ms", 30000);
+                toConfig.dispatch.bundleSize = d.value("bundle_size", 3);
+                toConfig.dispatch.bundleDetour = d.value("bundle_detour", 10);
+                toConfig.dispatch.prefetchProgress = d.value("prefetch_progress", 0.7);
+                toConfig.dispatch.predictHorizonMs = d.value("predict_horizon_ms", 3000);
+                toConfig.dispatch.nominalSpeed = d.value("nominal_speed", 2.0);
+                toConfig.dispatch.stallTimeoutMs = d.value("stall_timeout_ms", 30000);
+                toConfig.dispatch.zoneCols = d.value("zone_cols", 1);
+                toConfig.dispatch.zoneRows = d.value("zone_rows", 1);
+                toConfig.dispatch.fleetSnapshotMs = d.value("fleet_snapshot_ms", 0);
+           }
+
+           if(j.contains("journal")) {
+                auto& jn = j["journal"];
+                toConfig.journal.enable = jn.value("enable", false);
+                toConfig.journal.path = jn.value("path", "./task.journal");
+                toConfig.journal.groupCommitMs = jn.value("group_commit_ms", 10);
+                toConfig.journal.compactMb = jn.value("compact_mb", 64);
+           }
+
+           if(j.contains("liveness")) {
+                auto& lv = j["liveness"];
+                toConfig.liveness.heartbeatIntervalMs = lv.value("heartbeat_interval_ms", 1000);
+                toConfig.liveness.missedBeats = lv.value("missed_beats", 3);
+                toConfig.liveness.offlineBeats = lv.value("offline_beats", 10);
+           }
+
+           if(j.contains("trajectory")) {
+                auto& tr = j["trajectory"];
+                toConfig.trajectory.capacity = tr.value("capacity", 0);
+                toConfig.trajectory.sampleIntervalMs = tr.value("sample_interval_ms", 100);
+           }
+
+           if(j.contains("deadlock")) {
+                auto& dl = j["deadlock"];
+                toConfig.deadlock.enable = dl.value("enable", false);
+                toConfig.deadlock.gridlockMs = dl.value("gridlock_ms", 5000);
+                toConfig.deadlock.replanHoldMs = dl.value("replan_hold_ms", 2000);
+           }
+
+           if(j.contains("rpc_retry")) {
+                auto& rr = j["rpc_retry"];
+                toConfig.rpcRetry.maxRetries = rr.value("max_retries", 0);
+                toConfig.rpcRetry.minRtoMs = rr.value("min_rto_ms", 1000);
+                toConfig.rpcRetry.maxRtoMs = rr.value("max_rto_ms", 4000);
+           }
+
+           if(j.contains("reservation")) {
+                auto& rv = j["reservation"];
+                toConfig.reservation.enable = rv.value("enable", false);
+                toConfig.reservation.maxClaim = rv.value("max_claim", 16);
+           }
+
+           if(j.contains("sim")) {
+                auto& s = j["sim"];
+                toConfig.sim.agvCount = s.value("agv_count", 10);
+                toConfig.sim.cellTimeMs = s.value("cell_time_ms", 500);
+                toConfig.sim.actionTimeMs = s.value("action_time_ms", 0);
+                toConfig.sim.linkLatencyMs = s.value("link_latency_ms", 20);
+                toConfig.sim.replanRetryMs = s.value("replan_retry_ms", 1000);
+                toConfig.sim.maxReplan = s.value("max_replan", 5);
+                toConfig.sim.ordersFile = s.value("orders_file", "");
+                toConfig.sim.orderCount = s.value("order_count", 500);
+                toConfig.sim.ordersPerHour = s.value("orders_per_hour", 3600.0);
+                toConfig.sim.seed = s.value("seed", 42u);
+                toConfig.sim.maxSimHours = s.value("max_sim_hours", 24.0);
+           }
+
            LOG_INFO("Config loaded successfully from %s", filePath.c_str());
            return true;
 
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 
 namespace agv{
@@ -22,6 +23,101 @@ struct MapConfig{
     double obstacleRatio = 0.1;
 };
 
+// 调度算法
+enum class SchedulerType {
+    GREEDY,
+    LYA_SAC,
+    PORTFOLIO   // 多策略赛马，按统一代价择优
+};
+
+struct SchedulerConfig{
+    SchedulerType type = SchedulerType::GREEDY;
+    std::string modelPath = "";  // LYA_SAC 策略网络权重文件
+    double lyaV = 10.0;          // 漂移加惩罚权衡系数 V
+    int topK = 16;               // 每个任务保留的候选车数量
+
+    // PORTFOLIO : 参赛策略 (第一个为基线，始终同步执行)
+    std::vector<std::string> portfolio = {"GREEDY", "LYA_SAC"};
+    int budgetMs = 20;           // 每轮等待实验策略的时间预算
+    int assignBonus = 50;        // 代价模型中每多派一单的奖励 (格)
+    int statsEveryRounds = 100;  // 每多少轮打印一次策略统计
+};
+
+// 调度防抖
+struct DispatchConfig{
+    int minIntervalMs = 50;  // 两轮调度的最小间隔
+    int batchSize = 32;      // 攒够多少个事件可提前触发
+    int agingMs = 30000;     // 优先级老化窗口 : 每级优先级等价于多等待的毫秒数
+    int bundleSize = 3;      // 单车任务序列最大长度 (1 表示不并单)
+    int bundleDetour = 10;   // 并单时单个任务允许的最大绕行 (格)
+    double prefetchProgress = 0.7; // 当前任务进度达到该值时预推送下一单
+    int predictHorizonMs = 3000;   // 预计该时间内空闲的忙车也作为候选 (0 关闭预测派单)
+    double nominalSpeed = 2.0;     // 还没有速度观测时的默认速度 (格/秒)
+    int stallTimeoutMs = 30000;    // 执行中任务超过该时间没有进度上报则收回重派 (0 关闭看门狗)
+    int zoneCols = 1;              // 分区 : 地图按 cols × rows 切成矩形区域，每个区域一个任务分片 (1×1 即不分片)
+    int zoneRows = 1;
+    int fleetSnapshotMs = 0;       // 车队快照最多每隔多久重建一次 (只有位置 / 电量变化时); 登录、下线、状态变化立即重建; 0 每次有变化都重建
+};
+
+// 任务日志 (WAL) : 崩溃 / 重启后恢复未完成的任务
+struct JournalConfig{
+    bool enable = false;
+    std::string path = "./task.journal";
+    int groupCommitMs = 10;      // 组提交窗口 : 攒一批记录再 fdatasync 一次
+    int compactMb = 64;          // 日志超过该大小时按快照压缩
+};
+
+// 车辆存活检测 : 比 TCP 空闲清理 (tcpTimeoutSec) 早得多地发现半开连接
+struct LivenessConfig{
+    int heartbeatIntervalMs = 1000;  // 车端心跳间隔
+    int missedBeats = 3;             // 连续丢几个心跳判失联 (状态置 UNKNOWN，不再派单); 0 关闭
+    int offlineBeats = 10;           // 累计丢几个心跳判下线 (踢掉连接); 0 只判失联
+};
+
+// 死锁 / 僵局检测 (DeadlockDetector)
+struct DeadlockConfig{
+    bool enable = false;
+    int gridlockMs = 5000;       // 等待超过该时间且前车一直没动判僵局; 让路车超过该时间没动则重新选车
+    int replanHoldMs = 2000;     // 被同一辆车堵在同一格时，该时间内的重复寻路请求直接回等待
+};
+
+// RPC 重传 : 按实测 RTT 自适应的重传超时 (RTO)，总时限仍是 rpcTimeoutMs
+struct RpcRetryConfig{
+    int maxRetries = 0;          // 宣告失败前最多重传几次 (0 关闭 : 只发一次，rpcTimeoutMs 后失败)
+    int minRtoMs = 1000;         // RTO 下限; 主 Loop 每秒检查一次，更小没有意义
+    int maxRtoMs = 4000;         // RTO 上限 (含指数退避)
+};
+
+// 交通管制 : 格子预约 (ReservationTable)
+struct ReservationConfig{
+    bool enable = false;
+    int maxClaim = 16;           // 单次申请的格数上限
+};
+
+// 车辆轨迹 : 每车一个定长环 (TrajectoryStore)，内存 ≈ 车数 × capacity × 24 字节
+struct TrajectoryConfig{
+    int capacity = 0;            // 每车保留的采样数 (0 关闭); 10Hz 保留 60s 即 600
+    int sampleIntervalMs = 100;  // 降采样 : 两个采样的最小间隔
+};
+
+// 离线仿真 (FleetSimulator / AgvFleetSim)
+struct SimConfig{
+    int agvCount = 10;
+    int cellTimeMs = 500;        // 走一格耗时 (与 AgvSimulator 一致)
+    int actionTimeMs = 0;        // 到点作业耗时
+    int linkLatencyMs = 20;      // 下发时延 (服务器 -> 车); 上报按零时延处理
+    int replanRetryMs = 1000;    // 寻路失败后的重试间隔
+    int maxReplan = 5;           // 连续寻路失败次数上限，超过则上报 ERROR 退单
+
+    // 订单流 : ordersFile 非空时回放录制订单，否则按泊松过程合成
+    std::string ordersFile = ""; // CSV : 到达偏移毫秒,x,y[,priority]
+    int orderCount = 500;
+    double ordersPerHour = 3600.0;
+    unsigned int seed = 42;
+
+    double maxSimHours = 24.0;   // 仿真时长上限 (防止订单永远做不完时空转)
+};
+
 struct ServerConfig{
     // 网络配置
     std::string ip = "0.0.0.0"; // 通配地址
@@ -34,9 +130,32 @@ struct ServerConfig{
 
     // 业务配置
     int rpcTimeoutMs = 5000;
+    RpcRetryConfig rpcRetry;
 
     // 地图配置
     MapConfig map;
+
+    // 调度配置
+    SchedulerConfig scheduler;
+    DispatchConfig dispatch;
+
+    // 任务日志配置
+    JournalConfig journal;
+
+    // 存活检测配置
+    LivenessConfig liveness;
+
+    // 车辆轨迹
+    TrajectoryConfig trajectory;
+
+    // 死锁检测
+    DeadlockConfig deadlock;
+
+    // 格子预约
+    ReservationConfig reservation;
+
+    // 离线仿真配置 (AgvServer 不使用)
+    SimConfig sim;
 };
 
 
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+/*
+AGV 槽位表 (单例) : AgvId -> 紧凑下标
+原来 WorldManager::onlineAgvs_、AgvManager::idMap_、TaskShard::runningTasks_ 都是以 AgvId 为 key 的红黑树，
+每个心跳 / 上报都要在几棵树上各做一次 O(logN) 的指针追逐
+现在登录时给车分配一个槽位 (0,1,2,...)，各子系统把自己的状态放进按槽位下标的连续数组：
+    查找 : AgvId -> 槽位 走一张直接寻址表 (无锁)，再按下标取数组元素
+    遍历 : 顺序扫数组，缓存友好
+代数 (generation) 防过期句柄 :
+    AgvSlot = {下标, 代数}; 子系统数组元素里记着写入时的 AgvSlot，读取时比对代数，不一致就当作不存在
+    槽位被回收给另一辆车时代数 +2 (中间的奇数表示 “正在改写”，读者遇到奇数直接放弃)，旧句柄和旧数组元素自动失效
+槽位映射是粘滞的 : 下线只标记离线，同一辆车重连拿回原槽位 (断线重连后任务序列还能对上);
+    只有槽位用完时才回收一个离线槽位给新车
+线程模型 :
+    Find / IsCurrent 无锁，任意线程
+    Acquire / Release 只在登录 / 下线时调用，写锁串行
+*/
+
+namespace agv{
+namespace manager{
+
+struct AgvSlot {
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    uint32_t index = kNone;
+    uint32_t gen = 0;
+
+    bool Valid() const { return index != kNone; }
+    bool operator==(const AgvSlot& o) const { return index == o.index && gen == o.gen; }
+    bool operator!=(const AgvSlot& o) const { return !(*this == o); }
+};
+
+class AgvSlotTable{
+public:
+    static constexpr uint32_t kMaxSlots = 4096;  // 同时登记的车辆上限
+    static constexpr int kDirectIds = 65536;     // [0, kDirectIds) 的 AgvId 直接寻址，之外的走哈希表
+
+    static AgvSlotTable& Instance();
+
+    // 登录 : 已有槽位直接返回; 否则分配新槽位 (用完时回收一个离线槽位); 全满且都在线返回无效槽位
+    AgvSlot Acquire(int agvId);
+
+    // 下线 : 只标记离线，映射保留
+    void Release(int agvId);
+
+    // AgvId -> 当前槽位; 没有登记过 (或正被回收) 返回无效槽位
+    AgvSlot Find(int agvId) const;
+
+    // 句柄是否仍然有效 (槽位没被回收给别的车)
+    bool IsCurrent(AgvSlot slot) const;
+
+    // 已分配过的槽位数 (高水位) : 子系统数组的长度上界
+    uint32_t Size() const { return used_.load(std::memory_order_acquire); }
+
+private:
+    AgvSlotTable();
+    ~AgvSlotTable() = default;
+
+    AgvSlotTable(const AgvSlotTable&) = delete;
+    AgvSlotTable& operator=(const AgvSlotTable&) = delete;
+
+    static bool IsDirect(int agvId) { return agvId >= 0 && agvId < kDirectIds; }
+
+    // 以下在写锁内调用
+    uint32_t LookupLocked(int agvId) const;  // 下标 + 1，0 表示没有
+    void MapLocked(int agvId, uint32_t idxPlus1);
+    void UnmapLocked(int agvId);
+
+private:
+    struct Meta {
+        std::atomic<uint32_t> gen{0};    // 偶数 : 稳定; 奇数 : 正在改写
+        std::atomic<int> agvId{-1};
+        std::atomic<bool> online{false};
+    };
+
+    // 直接寻址表 : AgvId -> 下标 + 1
+    std::unique_ptr<std::atomic<uint32_t>[]> direct_;
+    // 超出直接寻址范围的 AgvId
+    std::unordered_map<int, uint32_t> sparse_;
+
+    std::unique_ptr<Meta[]> meta_;
+    std::atomic<uint32_t> used_{0};
+
+    // Acquire / Release 串行; Find 只在查 sparse_ 时拿读锁
+    mutable std::shared_mutex mutex_;
+};
+
+}
+}
+
+#define SlotTbl agv::manager::AgvSlotTable::Instance()
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "model/AgvStructs.h"
+#include "map/GridMap.h"
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+死锁 / 僵局检测 : 增量维护的等待图 (wait-for graph)
+原来窄通道里几辆车互相堵住，服务端毫无察觉 : 车端发现下一格有车就发 PATH_REQ 重新寻路，
+    而规划器只看静态地图，算出来还是同一条路，车每 500ms 重试一次，A* 全堆到工作线程池上 (重规划风暴)，谁也走不了
+现在 :
+    图的来源 : 上报的位置 (心跳 / 任务上报)、下发的路径 (PATH_RESP)、被堵的重规划请求 (PATH_REQ 时路径下一格被别的车占着)
+    等待边 A -> c : A 等格子 c; c 上的车 B 即 A 等的车 (A -> B 由占用表动态解析，B 开走边自动失效)
+        每辆车同时只等一格 : 出度 ≤ 1，图是函数图，判环只需沿着出边走，不需要 DFS
+    增量判环 : 只在边 “变活” 的时候从边的起点走一遍
+        新增等待边 (被堵的 PATH_REQ) / 有车开进了别人正在等的格子
+        走回起点即成环，代价是环长，不扫全图; 车一动，它的出边和所在环立即作废
+    化解 :
+        成环 : 选一辆车让路 (有空闲侧格的成员里，被选中次数最少的优先，次数相同取 ID 小的)
+            被选中的车下一次 PATH_REQ 直接拿到 “先退到侧格再去终点” 的路径; 其他成员的 PATH_REQ 直接回 “等待”，不算 A*
+            让路的车迟迟不动 (超过 gridlockMs)，环作废，下一次请求重新选车
+        同一辆车被同一辆车堵在同一格 : replanHoldMs 内的重复请求直接回 “等待” (静态地图上重算结果不变)
+        僵局 (不成环的长时间等待 : 前车坏了 / 停在通道里不走) : 定时检查只看等待中的车，超过 gridlockMs 且链头一直没动的上报
+            同一个链头只报一次 (排在后面的车都算在最长的那条链里)，链头动了之后再堵住才重新上报
+线程模型 : 位置更新在 IO 线程，PATH_REQ 在 IO 线程，路径回写在工作线程，定时检查在主 Loop; 一把锁，临界区只做哈希表增删和沿边行走
+*/
+
+namespace agv{
+namespace manager{
+
+class DeadlockDetector{
+public:
+    // PATH_REQ 的处理方式
+    struct Verdict {
+        enum Kind : uint8_t {
+            PLAN,     // 正常寻路
+            HOLD,     // 原地等待 (不寻路，回失败，车端继续沿旧路径等前方让开)
+            BACKOFF,  // 让路 : 先退到 side 再去终点
+        };
+        Kind kind = PLAN;
+        int blocker = -1;   // HOLD : 在等谁
+        model::Point side;  // BACKOFF : 让路的侧格
+    };
+
+    // 成环事件 (锁外打日志)
+    struct CycleEvent {
+        std::vector<int> members;  // 按等待方向排列 : members[i] 等 members[i + 1]，最后一个等第一个
+        int victim = -1;           // -1 : 没有车能让路
+        model::Point side;
+    };
+
+    // 僵局事件 (每个链头一条)
+    struct GridlockEvent {
+        int waiter;           // 链尾 : 等得最远的那辆
+        int head;             // 链头 : 一直没动的车
+        model::Point headPos;
+        int chainLen;
+        int64_t stillMs;      // 链头静止时长
+    };
+
+    DeadlockDetector() = default;
+
+    DeadlockDetector(const DeadlockDetector&) = delete;
+    DeadlockDetector& operator=(const DeadlockDetector&) = delete;
+
+    // 启动时调用一次 (地图加载之后; map 须比检测器活得久)
+    void Configure(const GridMap* map, bool enable, int gridlockMs, int replanHoldMs);
+    bool Enabled() const { return enable_; }
+
+    // 位置 (登录 / 心跳 / 上报; 只在位置变化时调用)
+    void OnMove(int agvId, const model::Point& pos, int64_t nowMs, std::vector<CycleEvent>& events);
+    // 批量位置 (一轮 IO 的心跳) : 逐条语义与 OnMove 相同，整批只加一次锁
+    struct Move {
+        int agvId;
+        model::Point pos;
+    };
+    void OnMoves(const std::vector<Move>& moves, int64_t nowMs, std::vector<CycleEvent>& events);
+    // 下线
+    void Remove(int agvId);
+
+    // PATH_REQ : 判定是否被堵、是否在环里
+    Verdict OnPathRequest(int agvId, int64_t nowMs, std::vector<CycleEvent>& events);
+    // 路径已下发
+    void OnPathPlanned(int agvId, const std::vector<model::Point>& path);
+
+    // 定时 : 不成环的长时间等待
+    void CheckGridlock(int64_t nowMs, std::vector<GridlockEvent>& events);
+
+private:
+    struct Node {
+        model::Point pos;
+        bool placed = false;
+        int64_t lastMoveMs = 0;
+
+        std::vector<model::Point> plan;  // 最近一次下发的路径 (含起点)
+        size_t planIdx = 0;              // 当前位置在 plan 中的下标
+
+        bool waiting = false;            // 出边 : 等 waitCell
+        model::Point waitCell;
+        int64_t waitSinceMs = 0;
+        bool gridlockReported = false;
+        bool gridlockHead = false;       // 作为链头已上报 (车一动清掉)
+
+        uint64_t cycle = 0;              // 所在的环 (0 : 无)
+        int victimCount = 0;             // 被选为让路车的次数 (轮换)
+
+        // 重复重规划抑制
+        int lastBlocker = -1;
+        model::Point lastBlockedCell;
+        int64_t lastReplanMs = 0;
+    };
+
+    struct Cycle {
+        std::vector<int> members;
+        int victim = -1;
+        model::Point side;
+        int64_t detectedMs = 0;
+    };
+
+    static uint64_t Key(const model::Point& p) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(p.x)) << 32) | static_cast<uint32_t>(p.y);
+    }
+
+    // 以下在锁内调用
+    int OwnerLocked(const model::Point& cell) const;
+    void SetWaitLocked(int agvId, Node& n, const model::Point& cell, int64_t nowMs);
+    void ClearWaitLocked(int agvId, Node& n);
+    void MoveLocked(int agvId, const model::Point& pos, int64_t nowMs, std::vector<CycleEvent>& events);
+    void DissolveLocked(uint64_t cycleId);
+    // 从 agvId 沿出边走，回到起点即成环 : 登记并选让路车，返回环号 (0 : 没成环)
+    uint64_t DetectFromLocked(int agvId, int64_t nowMs, std::vector<CycleEvent>& events);
+    bool FreeSideLocked(const Node& n, model::Point& side) const;
+    Verdict VerdictLocked(int agvId, const Cycle& c) const;
+
+private:
+    const GridMap* map_ = nullptr;
+    bool enable_ = false;
+    int gridlockMs_ = 5000;
+    int replanHoldMs_ = 2000;
+
+    std::mutex mutex_;
+    std::unordered_map<int, Node> nodes_;
+    std::unordered_map<uint64_t, int> owner_;                // 格子 -> 车
+    std::unordered_map<uint64_t, std::vector<int>> waiters_; // 格子 -> 等这格的车
+    std::unordered_set<int> waiting_;                        // 有出边的车 (僵局检查只看它们)
+    std::unordered_map<uint64_t, Cycle> cycles_;
+    uint64_t nextCycle_ = 1;
+};
+
+}
+}
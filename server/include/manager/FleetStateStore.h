@@ -0,0 +1,149 @@
+#pragma once
+
+#include "model/AgvStructs.h"
+#include "manager/AgvSlotTable.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/*
+车队状态存储 (按槽位下标, 每槽一个 seqlock)
+原来所有在线车的状态放在 vector<AgvEntry> 里，由 WorldManager::agvMutex_ 一把读写锁保护 :
+    每辆车每秒几次心跳，每次都拿写锁，IsOccupied / GetAgvStatus / GetAllAgvs 的读者频繁被卡住，
+    shared_mutex 偏向读还是偏向写由实现决定，心跳多时读者可能长时间拿不到锁
+现在 :
+    容量固定 (AgvSlotTable::kMaxSlots)，启动时一次分配，永不扩容 —— 读者不用担心数组被搬走
+    分冷热两个数组 (SoA) : 热行放位置 / 状态 / 电量 / 任务 / 心跳时间，冷行放运动学观测和版本号
+        每行独占一条缓存行 (alignas(64))，不同车的写者之间没有伪共享; 占用扫描只碰热行
+    每槽一个序号 seq (seqlock) :
+        写 : seq 由偶数 CAS 成奇数 (同一辆车的两个写者之间互斥，临界区只有十几次 store)，写字段，seq + 1 回到偶数
+        读 : 读 seq (奇数说明正在写，重读)，读字段，再读 seq，前后一致才算读到完整快照; 读者不拿锁，也不写任何共享内存
+    字段都是 relaxed 原子量 + 栅栏 (Boehm 的 seqlock 写法)，没有数据竞争
+    槽位代数 gen 与 AgvSlot 比对，槽位回收给别的车之后旧句柄的读写都会落空
+*/
+
+namespace agv{
+namespace manager{
+
+// 一辆车的完整状态 (普通值类型，读写都以它为单位)
+struct AgvState {
+    static constexpr size_t kVersionLen = 24;
+
+    int uid = -1;
+    model::Point pos;
+    model::AgvStatus status = model::AgvStatus::IDLE;
+    double battery = 100.0;
+    int64_t heartbeatMs = 0;
+    model::TaskHandle taskId;
+    double progress = 0.0;
+
+    // 运动学观测
+    double speed = 0.0;
+    int64_t lastMoveMs = 0;
+    int pathLen = 0;
+
+    char version[kVersionLen] = {0};  // 超长截断
+};
+
+class FleetStateStore{
+public:
+    static constexpr uint32_t kCapacity = AgvSlotTable::kMaxSlots;
+
+    FleetStateStore();
+
+    FleetStateStore(const FleetStateStore&) = delete;
+    FleetStateStore& operator=(const FleetStateStore&) = delete;
+
+    // ---------- 写 (任意线程; 同一槽位的写者之间 CAS 互斥) ----------
+    // 登录 : 整槽覆盖并标记在线，记下槽位代数
+    void Reset(AgvSlot slot, const AgvState& st);
+
+    // 下线 : 代数一致时标记离线
+    void Remove(AgvSlot slot);
+
+    // 读-改-写 : fn(AgvState&) 在写临界区内执行 (只做计算，不要加锁 / 打日志); 槽位不在线或代数不符返回 false
+    template <typename F>
+    bool Update(AgvSlot slot, F&& fn) {
+        if (!InRange(slot)) return false;
+        HotLine& h = hot_[slot.index];
+        ColdLine& c = cold_[slot.index];
+
+        uint32_t s = BeginWrite(h);
+        bool ok = h.online.load(std::memory_order_relaxed) && h.gen.load(std::memory_order_relaxed) == slot.gen;
+        if (ok) {
+            AgvState st;
+            LoadFields(h, c, st);  // 持有写权，直接读
+            fn(st);
+            StoreFields(st, h, c);
+        }
+        EndWrite(h, s);
+        return ok;
+    }
+
+    // ---------- 读 (任意线程，无锁) ----------
+    // 槽位在线且代数一致时读出完整快照
+    bool Read(AgvSlot slot, AgvState& out) const;
+
+    // 只读状态 (热行); 不在线返回 UNKNOWN
+    model::AgvStatus Status(AgvSlot slot) const;
+
+    // 是否有除 selfId 以外的在线车在 pos (只扫热行)
+    bool AnyAt(const model::Point& pos, int selfId) const;
+
+    // 写序号 : 所有槽位 seq 之和，每次写入都会变 (只扫热行的 seq，判断 “自上次以来有没有写过”)
+    uint64_t WriteStamp() const;
+
+    // 按槽位顺序遍历在线车 : fn(const AgvState&)
+    template <typename F>
+    void ForEachOnline(F&& fn) const {
+        uint32_t n = std::min(SlotTbl.Size(), kCapacity);
+        AgvState st;
+        for (uint32_t i = 0; i < n; ++i) {
+            if (ReadSlot(i, nullptr, st)) fn(st);
+        }
+    }
+
+private:
+    // 热行 : 56 字节，一条缓存行
+    struct alignas(64) HotLine {
+        std::atomic<uint32_t> seq{0};       // 偶数 : 稳定; 奇数 : 正在写
+        std::atomic<uint32_t> gen{0};       // 写入时的槽位代数
+        std::atomic<int32_t> uid{-1};
+        std::atomic<int32_t> x{0};
+        std::atomic<int32_t> y{0};
+        std::atomic<int8_t> status{0};
+        std::atomic<bool> online{false};
+        std::atomic<double> battery{0.0};
+        std::atomic<int64_t> heartbeatMs{0};
+        std::atomic<uint64_t> taskId{0};
+        std::atomic<double> progress{0.0};
+    };
+    // 冷行 : 运动学 + 版本号，只在心跳 / 上报写、全量快照读
+    struct alignas(64) ColdLine {
+        std::atomic<double> speed{0.0};
+        std::atomic<int64_t> lastMoveMs{0};
+        std::atomic<int32_t> pathLen{0};
+        std::atomic<uint64_t> version[AgvState::kVersionLen / sizeof(uint64_t)];
+    };
+    static_assert(sizeof(HotLine) == 64, "HotLine must fit one cache line");
+    static_assert(sizeof(ColdLine) == 64, "ColdLine must fit one cache line");
+
+    static bool InRange(AgvSlot slot) { return slot.Valid() && slot.index < kCapacity; }
+
+    static uint32_t BeginWrite(HotLine& h);
+    static void EndWrite(HotLine& h, uint32_t s);
+
+    static void LoadFields(const HotLine& h, const ColdLine& c, AgvState& st);
+    static void StoreFields(const AgvState& st, HotLine& h, ColdLine& c);
+
+    // seqlock 读 : 在线 (且 expect 非空时代数一致) 返回 true
+    bool ReadSlot(uint32_t index, const AgvSlot* expect, AgvState& out) const;
+
+private:
+    std::unique_ptr<HotLine[]> hot_;
+    std::unique_ptr<ColdLine[]> cold_;
+};
+
+}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include "model/TaskHandle.h"
+
+namespace agv{
+namespace manager{
+
+struct TaskContext;
+
+/*
+带索引的二叉堆 (Indexed Binary Heap) : 待派任务队列
+替代原来的 std::list<spTaskContext> pendingTasks_
+    list 的问题：每轮全量拷贝 O(n)，派出后 remove_if 再扫一遍 O(n)，且没有优先级概念
+    本结构：
+        堆数组 heap_         : 按 (rank, seq) 排序的小顶堆，rank 越小越先派
+        位置索引 pos_        : taskId -> 堆下标，支持按 ID 定位
+    复杂度：
+        Push / Remove(id) / Update(id)  O(log n)
+        Top                             O(1)
+        TopN(k)                         O(k log k)  与积压总量无关 (辅助堆只沿着原堆向下展开 k 层前沿)
+rank 由调用方计算并传入 (见 TaskShard::ComputeRank)，队列本身不关心优先级/老化的具体策略
+seq 为入队序号，rank 相同时先进先出
+非线程安全，由持有者加锁
+*/
+class IndexedTaskQueue {
+public:
+    using spTaskContext = std::shared_ptr<TaskContext>;
+
+    IndexedTaskQueue() = default;
+    ~IndexedTaskQueue() = default;
+
+    // 入队; taskId 已存在则返回 false
+    bool Push(const spTaskContext& task, int64_t rank);
+
+    // 按 ID 删除; 不存在返回 false
+    bool Remove(model::TaskHandle taskId);
+
+    // 修改 rank 并就地调整 (上浮或下沉); 不存在返回 false
+    bool Update(model::TaskHandle taskId, int64_t rank);
+
+    bool Contains(model::TaskHandle taskId) const { return pos_.count(taskId) > 0; }
+    size_t Size() const { return heap_.size(); }
+    bool Empty() const { return heap_.empty(); }
+
+    // 按 ID 查找; 不存在返回 nullptr
+    spTaskContext Find(model::TaskHandle taskId) const;
+
+    // 队首 (最先该派的任务); 空队列返回 nullptr
+    spTaskContext Top() const;
+
+    // 按派单顺序取前 n 个，追加到 out (不修改队列)
+    void TopN(size_t n, std::vector<spTaskContext>& out) const;
+
+    void Clear();
+
+private:
+    struct Node {
+        int64_t rank;
+        uint64_t seq;
+        spTaskContext task;
+    };
+
+    // a 是否应排在 b 之前
+    static bool Before(const Node& a, const Node& b) {
+        return a.rank != b.rank ? a.rank < b.rank : a.seq < b.seq;
+    }
+
+    void SiftUp(size_t i);
+    void SiftDown(size_t i);
+    void SwapNode(size_t i, size_t j);
+    void RemoveAt(size_t i);
+
+private:
+    std::vector<Node> heap_;
+    std::unordered_map<model::TaskHandle, size_t> pos_;
+    uint64_t seq_ = 0;
+};
+
+}
+}
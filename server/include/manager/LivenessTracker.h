@@ -0,0 +1,80 @@
+#pragma once
+
+#include "manager/AgvSlotTable.h"
+#include "utils/TimingWheel.h"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/*
+车辆存活检测 : 心跳期限挂在分层时间轮上 (见 utils/TimingWheel.h)
+原来 lastHeartbeatTime 只写不读，半开连接 (车已断电 / 网线拔了，TCP 还没发现) 的车一直是 IDLE，
+    会继续接单，直到 tcpTimeoutSec (默认 60s) 的空闲清理才下线
+现在每辆车一个期限 : 收到心跳 / 上报就把期限推到 now + 间隔 × missedBeats (时间轮 Arm，O(1)，不扫全表)
+    第一段到期 (SUSPECT) : 连续 missedBeats 个心跳没来 -> 状态置 UNKNOWN，立即退出派单候选; 再挂第二段期限
+    第二段到期 (OFFLINE) : 累计 offlineBeats 个心跳没来 -> 交给会话层踢下线，走正常的下线流程
+    期间心跳恢复 : 重新定时，状态随心跳恢复
+Advance 只处理到期的槽，没有周期性的全表扫描
+线程模型 : 心跳在各 IO 线程，Advance 在主 Loop 的定时器; 一把锁保护时间轮，批量心跳一次加锁
+*/
+
+namespace agv{
+namespace manager{
+
+class LivenessTracker{
+public:
+    enum class Stage : uint8_t {
+        SUSPECT = 1,  // 失联 : 置 UNKNOWN
+        OFFLINE,      // 判定下线 : 踢掉连接
+    };
+
+    struct Expired {
+        int agvId;
+        AgvSlot slot;
+        Stage stage;
+    };
+
+    LivenessTracker() = default;
+
+    LivenessTracker(const LivenessTracker&) = delete;
+    LivenessTracker& operator=(const LivenessTracker&) = delete;
+
+    // 启动时调用一次 (之后只读) ; intervalMs : 车端心跳间隔; missedBeats : 连续丢几个判失联 (0 关闭); offlineBeats : 累计丢几个判下线 (0 只置失联，不踢)
+    void Configure(int intervalMs, int missedBeats, int offlineBeats);
+    bool Enabled() const { return missedBeats_ > 0; }
+
+    // 收到心跳 / 上报 : 推后期限
+    void Beat(int agvId, AgvSlot slot, int64_t nowMs);
+    // 批量 : 一次加锁
+    void Beat(const std::vector<std::pair<int, AgvSlot>>& agvs, int64_t nowMs);
+
+    // 下线 : 不再跟踪
+    void Remove(int agvId);
+
+    // 推进到 nowMs，到期的追加到 out; SUSPECT 到期的车自动挂上 OFFLINE 期限
+    void Advance(int64_t nowMs, std::vector<Expired>& out);
+
+    // 判失联的静默时长 (毫秒)
+    int64_t SuspectAfterMs() const { return static_cast<int64_t>(intervalMs_) * missedBeats_; }
+
+private:
+    struct Entry {
+        AgvSlot slot;
+        Stage stage;
+    };
+    using Wheel = TimingWheel<int, Entry>;
+
+    void ArmLocked(int agvId, AgvSlot slot, int64_t nowMs);
+
+private:
+    int intervalMs_ = 1000;
+    int missedBeats_ = 0;    // 默认关闭 (离线仿真没有心跳超时的概念)
+    int offlineBeats_ = 0;
+
+    std::mutex mutex_;
+    Wheel wheel_{100};
+    std::vector<Wheel::Expired> expired_;  // Advance 复用
+};
+
+}
+}
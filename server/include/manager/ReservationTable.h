@@ -0,0 +1,94 @@
+#pragma once
+
+#include "model/AgvStructs.h"
+#include "map/GridMap.h"
+#include "manager/AgvSlotTable.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+格子预约表 (交通管制)
+原来只有 IsOccupied 的点检查 : 两辆车可以同时从两头开进同一条单行通道，在中间顶牛
+现在车在进入前方 N 格之前先申请预约 (RESERVE_REQ)，拿到的格子别的车进不来 :
+    每个格子一个原子的 “车主字” : 0 空闲，否则 AgvId + 1; 与 GridMap 同尺寸的平铺数组，下标 y * width + x
+    申请 : 按顺序逐格 CAS (0 -> 自己)，已经是自己的算成功 (幂等重试)
+        连续性 : 首格必须是车当前所在格或其相邻格，之后每格与前一格相邻; 断开处按冲突处理 (车主 -1)
+        allOrNothing : 任何一格失败，把这一批新拿到的格子 CAS 回 0，一格都不给 (整条通道要么全拿要么不进)
+        否则拿到冲突格之前的前缀 (能往前走几格走几格)
+    释放 : 逐格 CAS (自己 -> 0)，不会误放别人的格子
+    驶离 : 每辆车按行驶顺序记着自己持有的格子 (车道 Lane，按槽位下标)，位置推进到第 k 格时放掉前 k 格;
+        车端漏发 release 也不会一直占着身后的通道
+    下线 : 扫一遍整张表放掉这辆车的所有格子 (只在下线时发生)
+    没有全局锁 : 一次申请 N 格就是 N 次 CAS，微秒级，直接在 IO 线程做;
+        车道锁只属于一辆车 (该车的预约与心跳之间)，车与车之间不竞争
+*/
+
+namespace agv{
+namespace manager{
+
+class ReservationTable{
+public:
+    struct ClaimResult {
+        int granted = 0;           // 从头开始成功的格数 (allOrNothing 失败时为 0)
+        bool all = false;          // 是否全部拿到
+        model::Point conflictCell; // 失败的格子
+        int conflictAgv = -1;      // 占着这格的车 (-1 : 障碍物 / 越界)
+    };
+
+    ReservationTable() = default;
+
+    ReservationTable(const ReservationTable&) = delete;
+    ReservationTable& operator=(const ReservationTable&) = delete;
+
+    // 启动时调用一次 (地图加载之后; map 须比预约表活得久)
+    void Reset(const GridMap* map);
+    bool Enabled() const { return cells_ != nullptr; }
+
+    // from : 车当前所在格 (path 的连续性从这里算起)
+    ClaimResult Claim(int agvId, AgvSlot slot, const model::Point& from, const std::vector<model::Point>& path, bool allOrNothing);
+    // 返回实际放掉的格数
+    int Release(int agvId, AgvSlot slot, const std::vector<model::Point>& path);
+    int ReleaseAll(int agvId, AgvSlot slot);
+    // 位置变了 (心跳 / 上报) : 放掉车道里 pos 之前的格子 (车已驶过); pos 不在车道上则不动
+    int ReleaseBehind(int agvId, AgvSlot slot, const model::Point& pos);
+
+    // 当前车主 (-1 : 空闲 / 越界)
+    int Owner(const model::Point& p) const;
+
+private:
+    // 越界返回 -1
+    long IndexOf(const model::Point& p) const {
+        if (p.x < 0 || p.x >= width_ || p.y < 0 || p.y >= height_) return -1;
+        return static_cast<long>(p.y) * width_ + p.x;
+    }
+    static uint32_t Word(int agvId) { return static_cast<uint32_t>(agvId) + 1; }
+    static bool Adjacent(const model::Point& a, const model::Point& b) {
+        return std::abs(a.x - b.x) + std::abs(a.y - b.y) == 1;
+    }
+
+    // 一辆车持有的格子，按行驶顺序
+    struct Lane {
+        std::mutex mutex;
+        int agvId = -1;  // 槽位换主时作废
+        std::vector<model::Point> cells;
+    };
+    // 槽位的车道 (调用方加锁); 槽位无效返回 nullptr
+    Lane* LaneOf(AgvSlot slot);
+    static void ResetLaneLocked(Lane& lane, int agvId);
+    // CAS (自己 -> 0)
+    bool ReleaseCell(long idx, uint32_t me);
+
+private:
+    const GridMap* map_ = nullptr;
+    int width_ = 0;
+    int height_ = 0;
+    std::unique_ptr<std::atomic<uint32_t>[]> cells_;
+    std::unique_ptr<Lane[]> lanes_;  // 按槽位下标
+};
+
+}
+}
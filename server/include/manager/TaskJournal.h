@@ -0,0 +1,130 @@
+#pragma once
+
+#include "model/AgvStructs.h"
+#include "config/ServerConfig.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+任务日志 (Write-Ahead Journal) : TaskManager 纯内存，进程一重启，待派 / 执行中的任务全部丢失
+做法：把任务的每一次状态流转追加到一个二进制日志文件，重启时重放
+    记录 : 定长 40 字节 (任务句柄 + 事件类型 + 少量字段 + CRC32)，不做序列化，写入和重放都是整块 memcpy
+    前端 (分片写者线程 / WMS 线程) : 只把记录拷进内存缓冲 (一把锁 + push_back)，绝不碰磁盘
+    后端 (独立线程) : 组提交 (Group Commit)，攒 groupCommitMs 内的所有记录，一次 write + 一次 fdatasync
+        与 AsyncLogging 相同的双缓冲 swap; 代价是崩溃时最多丢失最后一个组提交窗口的记录
+    压缩 : 后端线程在写盘的同时维护一份影子状态 (当前还活着的任务)，文件超过 compactMb 时
+        把影子状态写成新文件 (每个活任务几条记录)，fdatasync 后 rename 原子替换旧文件
+        影子状态只属于后端线程，压缩不需要停任何分片
+    恢复 : 顺序读取，CRC 校验; 遇到残缺 / 校验失败的尾部 (写到一半时崩溃) 截断后继续追加
+恢复语义 : 未完成的任务一律回到待派队列 (重启后车辆会话都已断开，执行中的任务无法确认，重新派单)
+*/
+
+namespace agv{
+namespace manager{
+
+// 任务状态流转
+enum class JournalOp : uint8_t {
+    CREATED = 1,    // 新建 (目标点 / 动作 / 优先级 / 创建时间)
+    DISPATCHED,     // 下发到车
+    ACKED,          // 车端确认收到
+    PROGRESS,       // 进度检查点
+    DONE,           // 完成
+    ROLLED_BACK,    // 退回待派队列 (reason = ReclaimReason)
+    PRIORITY,       // 改优先级
+};
+
+struct JournalRecord {
+    uint64_t taskId = 0;
+    int64_t timeMs = 0;     // CREATED 为创建时间，其余为发生时间
+    int32_t agvId = -1;
+    int32_t x = 0;
+    int32_t y = 0;
+    float progress = 0.0f;
+    uint8_t op = 0;
+    uint8_t act = 0;
+    uint8_t priority = 0;
+    uint8_t reason = 0;
+    uint32_t crc = 0;       // 前 36 字节的 CRC32
+};
+static_assert(sizeof(JournalRecord) == 40, "JournalRecord must stay a fixed 40-byte record");
+
+// 重放得到的未完成任务
+struct RecoveredTask {
+    model::TaskRequest req;
+    int64_t createdMs = 0;
+    int agvId = -1;         // 崩溃前所在的车 (-1 : 待派)
+    float progress = 0.0f;
+};
+
+class TaskJournal{
+public:
+    explicit TaskJournal(const config::JournalConfig& cfg);
+    ~TaskJournal();
+
+    TaskJournal(const TaskJournal&) = delete;
+    TaskJournal& operator=(const TaskJournal&) = delete;
+
+    // 启动前调用 : 重放已有日志，out 为未完成的任务 (按句柄即创建顺序); 残缺尾部会被截断
+    bool Recover(std::vector<RecoveredTask>& out);
+
+    // 打开文件 (追加) 并启动后台线程; 失败返回 false
+    bool Start();
+    // 刷完缓冲后停止
+    void Stop();
+
+    // ---------- 前端 (任意线程，只拷内存) ----------
+    void Append(JournalRecord rec);
+
+    void Created(const model::TaskRequest& req, int64_t createdMs);
+    void Dispatched(model::TaskHandle taskId, int agvId);
+    void Acked(model::TaskHandle taskId, int agvId);
+    void Progress(model::TaskHandle taskId, int agvId, double progress);
+    void Done(model::TaskHandle taskId, int agvId);
+    void RolledBack(model::TaskHandle taskId, uint8_t reason);
+    void Priority(model::TaskHandle taskId, int priority);
+
+private:
+    struct LiveTask {
+        JournalRecord created;  // 最新优先级已合入
+        int agvId = -1;
+        float progress = 0.0f;
+    };
+
+    void ThreadFunc();
+    // 影子状态 : 应用一条记录
+    void ApplyLocked(const JournalRecord& rec);
+    // 以影子状态重写日志文件
+    bool Compact();
+    bool OpenForAppend();
+
+    static uint32_t Crc(const JournalRecord& rec);
+    static JournalRecord Make(JournalOp op, model::TaskHandle taskId, int agvId);
+
+private:
+    config::JournalConfig cfg_;
+    int fd_ = -1;
+    int64_t fileBytes_ = 0;
+
+    // 线程控制
+    bool stop_ = true;
+    std::unique_ptr<std::thread> thread_;
+
+    // 前端缓冲
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<JournalRecord> current_;
+    size_t dropped_ = 0;  // 缓冲超上限 (磁盘长时间卡住) 时丢弃的记录数
+
+    // 影子状态 : Recover 之后只由后端线程访问
+    std::unordered_map<uint64_t, LiveTask> live_;
+};
+
+}
+}
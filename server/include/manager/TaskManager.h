@@ -3,13 +3,15 @@
 #include "model/AgvStructs.h"
 #include "myreactor/Timestamp.h"
 #include <mutex>
+#include <shared_mutex>
 #include <memory>
 #include <atomic>
-#include <list>
-#include <map>
+#include <unordered_map>
 #include <string>
 #include <vector>
+#include <functional>
 #include "algo/scheduler/ITScheduler.h"  // 接口
+#include "config/ServerConfig.h"
 
 namespace myreactor{
     class ThreadPool;
@@ -18,6 +20,25 @@ namespace myreactor{
 namespace agv{
 namespace manager{
 
+// 任务被收回 (退回待派队列) 的原因
+enum class ReclaimReason : uint8_t {
+    NONE = 0,
+    RPC_FAILED,     // 下发 RPC 失败 / 超时
+    REJECTED,       // 车端上报 ERROR
+    PUSH_FAILED,    // 接续 / 预推送下发失败
+    STALLED,        // 看门狗 : 执行中长时间没有进度上报
+};
+
+inline const char* ReclaimReasonName(ReclaimReason r) {
+    switch (r) {
+        case ReclaimReason::RPC_FAILED:  return "RPC_FAILED";
+        case ReclaimReason::REJECTED:    return "REJECTED";
+        case ReclaimReason::PUSH_FAILED: return "PUSH_FAILED";
+        case ReclaimReason::STALLED:     return "STALLED";
+        default:                         return "NONE";
+    }
+}
+
 // 服务器内部的任务上下文
 /*
 区别于 model::TaskRequest,其有双重身份
@@ -34,125 +55,201 @@ struct TaskContext {
     model::AgvStatus status;
     double progress;
     myreactor::Timestamp updateTime; // 上一次上报的时间
+    // 最近一次被收回的原因 + 累计收回次数 (分片写者线程写)
+    ReclaimReason reclaimReason = ReclaimReason::NONE;
+    int reclaimCount = 0;
     // myreactor::Timestamp finishTime;
 
+    // 排队键 (越小越先派)，由 TaskShard::ComputeRank 计算
+    // 只由分片写者线程读写; 调度器在 worker 线程看到的是轮次快照里的副本 (见 TaskShard::BeginRound)
+    int64_t rank = 0;
+
     TaskContext(const model::TaskRequest& r)
+        : TaskContext(r, myreactor::Timestamp::now()) {}
+
+    // 批量建单 : 同一波次共用一次取时
+    TaskContext(const model::TaskRequest& r, myreactor::Timestamp created)
         : req(r),
-          createTime(myreactor::Timestamp::now()),
+          createTime(created),
           status(model::AgvStatus::IDLE),
           progress(0.0),
-          updateTime(myreactor::Timestamp::now())
+          updateTime(created)
         //   finishTime(0) // 0 表示未完成
         {}
     
 };
 
+// 批量下单的一条订单 (WMS 波次释放)
+struct OrderSpec {
+    model::Point targetPos;
+    model::ActionType targetAct = model::ActionType::NONE;
+    int priority = 1;
+};
+
+class TaskShard;
+class TaskJournal;
+
+/*
+任务管理门面 : 对外接口不变，内部按地图分区切成若干 TaskShard (见 TaskShard.h)
+    1. 路由：新任务按目标点所在分区入片; 上报按车辆归属路由; 改优先级按任务句柄里的分片号
+       路由之后只是往分片的事件环里投递，调用方不会被调度轮次阻塞 (见 TaskShard 的单写者模型)
+    2. 车辆归属 agvOwner_：新车按所在分区归属; 任务序列做完时按最终位置重新归属
+       有任务序列的车被所在分片占住 (held)，不会被借走，上报的路由因此稳定
+    3. 跨区均衡：分片待派多于可派车时，从有富余空闲车的分片借车 (就近优先，每轮有上限)
+       借车只改归属，不改车的物理状态; 对方分片下一轮差分时自然把这辆车移出候选
+ownerMutex_ 是分片之间唯一共享的锁，只在查 / 改归属时短暂持有，持锁期间不调用分片
+*/
 class TaskManager {
 public: 
     using spTaskContext = std::shared_ptr<TaskContext>;
 
+    // 下发出口 : 默认走 AgvSession 的 RPC; 离线仿真注入自己的实现 (在分片写者线程上调用，不得回调 TaskManager)
+    using DispatchSink = std::function<bool(int agvId, const model::TaskRequest& req)>;
+
+    // 调度器工厂 : 每个分片一个实例 (增量调度器带内部状态，不能跨分片共享)
+    using SchedulerMaker = std::function<std::shared_ptr<algo::scheduler::ITScheduler>()>;
+
     static TaskManager& Instance();
 
     /*单例模式 (Singleton) 与 依赖注入 (Dependency Injection) 的冲突”
     单例模式要求构造函数私有，因此无法在外部像 new TaskManager(pool) 这样传入参数。解决这个问题的标准做法是采用 【二段式初始化 (Two-phase Initialization)】。即：先获取实例，再注入资源  ：【添加 Init 接口】
     */
-    // 必须在 AgvServer 启动时显式调用一次
-    void Init(myreactor::ThreadPool* pool);
+    // 必须在 AgvServer 启动时显式调用一次 (分片在这里按 zoneCols × zoneRows 创建)
+    // cfg : 调度防抖、优先级老化、并单 / 预测、分区参数
+    // pool 传 nullptr 为内联模式 : 不启动写者线程，事件在调用线程直接应用，由调用方用 RunPendingRound() 驱动调度轮次 (离线仿真)
+    void Init(myreactor::ThreadPool* pool, const config::DispatchConfig& cfg = config::DispatchConfig());
+
+    // 停止各分片的写者线程 (须在 worker 线程池停止之前调用)，再刷完并关闭任务日志
+    void Stop();
+
+    // 打开任务日志 (Init 之后、开始接单之前调用一次) : 重放旧日志，未完成的任务重新入队，之后每次状态流转都追加记录
+    // 失败 (文件打不开) 返回 false，任务管理照常工作，只是不落盘
+    bool OpenJournal(const config::JournalConfig& cfg);
 
     // ================= 外部接口 =================
 
     // ---------- 写操作 ---------- 
-    // 发布新任务
-    std::string AddTask(model::Point targetPos, model::ActionType targetAct = model::ActionType::NONE);
+    // 发布新任务 ; priority 越大越紧急，范围 [kMinPriority, kMaxPriority]，越界会被截断
+    // 返回任务句柄 (未初始化时返回无效句柄)
+    model::TaskHandle AddTask(model::Point targetPos, model::ActionType targetAct = model::ActionType::NONE, int priority = 1);
+
+    // 批量发布 (WMS 波次释放) : 返回与 orders 一一对应的句柄 (未初始化时为空)
+    /*
+    逐条 AddTask 时每一单都要 : 一次 CAS 取号、一次堆分配、一条日志、一个事件、一次调度通知
+    批量时 : 一次 CAS 预留整段序号; 上下文一次性分配在同一块内存里; 每个分片只投递一个事件，
+        写者线程整批入队后只发一次调度通知 —— 一个波次 O(1) 轮调度，而不是 O(n) 轮
+    */
+    std::vector<model::TaskHandle> AddTasks(const std::vector<OrderSpec>& orders);
+
+    // 调整待派任务的优先级 : 异步，返回是否已投递到任务所在分片 (已派出的任务只打日志)
+    bool SetTaskPriority(model::TaskHandle taskId, int priority);
  
     // 处理任务上报 ： 由 AgvSession 调用
     void OnTaskReport(const model::TaskReport& msg);
 
     // 外部接口:尝试调度 (通常在有新任务或有车释放时调用)
+    // 只做标脏通知 (全部分片)，真正的调度轮次由各分片的写者线程合并后发起
     void TryDispatch();
 
-    // 设置调度算法 , 用基类指针接收
-    void SetScheduler(std::shared_ptr<algo::scheduler::ITScheduler>);
+    // 设置调度算法 : 每个分片调用一次工厂
+    void SetScheduler(SchedulerMaker maker);
+
+    // 替换下发出口 (传空恢复 Session 下发) ; 只能在 Init 之前或内联模式下调用
+    void SetDispatchSink(DispatchSink sink);
+
+    // ---------- 内联模式 ----------
+    // 是否有被标脏、尚未执行的调度轮次 (任一分片)
+    bool HasPendingRound() const;
+
+    // 在调用线程上依次执行各分片的调度轮次 (有脏标记时); 返回是否执行了
+    bool RunPendingRound();
+
+    size_t ShardCount() const { return shards_.size(); }
+
+    static constexpr int kMinPriority = 0;
+    static constexpr int kMaxPriority = 9;
 
 private:
+    friend class TaskShard;
+
     TaskManager();
-    ~TaskManager() = default;
+    ~TaskManager();
     TaskManager(const TaskManager&) = delete;
     TaskManager& operator=(const TaskManager&) = delete;
 
-    // 生成唯一的任务ID
-    std::string GenerateTaskId();
-
-    // 执行调度
-    void ExecuteDispatch(
-        const std::vector<spTaskContext>& tasksSnapst,
-        const std::vector<model::AgvInfo>& agvsSnapst,
-        std::shared_ptr<algo::scheduler::ITScheduler>);
-
-    // 处理 RPC 发送结果的回调函数 （IO线程调用，加锁）
-    void OnDispatchResult(int agvId, const std::string& taskId, bool success, const std::string& reason);
-
-    // 日志打印封装
-    // 日志类型枚举：
-    enum class LogAction {
-        DISPATCH_SUCCESS,       // 派单成功 (INFO)
-        DOUBLE_CHECK_FAILED,    // 双重检查失败：小车状态变动（物理与逻辑） (WARN)
-        SESSION_LOST,           // 会话丢失：查不到 Session 指针 (WARN)
-        DISPATCH_FAILED         // 可能多个原因，没登录/没设置回调 (ERROR)
-        // ROLLBACK_FAILED         // 回滚失败 (WARN)
-    };
+    // 任务日志 : 没打开时为 nullptr (离线仿真 / 未启用)
+    TaskJournal* Journal() const { return journal_.load(std::memory_order_acquire); }
 
-    // 通用日志条目：包含所有类型可能用到的字段
-    struct DeferredLog {  // 延迟日志
-        LogAction action;       // 类型
-        std::string taskId;     // 关联的任务ID
-        int agvId;              // 关联的AGV
-        int extraVal;           // 额外数值 (距离、状态等)
-    };
+    // 生成唯一的任务句柄 (分片位 = shard)
+    model::TaskHandle GenerateTaskId(size_t shard);
+    // 预留 n 个连续的 stamp (毫秒 << 16 | 序号)，返回第一个
+    uint64_t ReserveStamps(size_t n);
+
+    // 点所在分区 (分片下标)
+    size_t ZoneOf(const model::Point& pos) const;
+
+    // ---------- 车辆归属 (分片调用) ----------
+    // 车辆当前归属; 第一次见到的车按 pos 所在分区归属
+    size_t OwnerOf(int agvId, const model::Point& pos);
+
+    // 派单前占住车辆 : 归属仍为 shard 时标记 held 并返回 true
+    bool HoldAgv(size_t shard, int agvId);
+
+    // 序列被整体退回 (未做完) : 解除占用，归属不变
+    void UnholdAgv(int agvId);
+
+    // 从全量快照里挑出归属于 shard 的车 (新车顺便登记)
+    void CollectOwned(size_t shard, const std::vector<model::AgvInfo>& fleet, std::vector<model::AgvInfo>& out);
+
+    // 归属仍为 from 且未被占住时改为 to
+    bool TransferOwner(int agvId, size_t from, size_t to);
 
-    void ProcessLogs_TD(const std::vector<DeferredLog>& logs);
+    // 任务序列做完 : 按最终位置重新归属 (同时解除占用)，返回新归属
+    size_t RehomeAgv(int agvId, const model::Point& pos);
+
+    // 通知某个分片发起一轮调度
+    void NotifyShard(size_t shard);
+
+    // 分片 idle 有车空出且本区无待派 : 唤醒有积压的分片来借车 (否则积压分片没有新事件就不会再发起轮次)
+    void NotifyBacklogged(size_t idle);
+
+    // 跨区借车 : 为 needy 分片借最多 want 辆空闲车 (离 near 最近的优先)，返回借到的数量
+    size_t BorrowAgvs(size_t needy, size_t want, const model::Point& near, const std::vector<model::AgvInfo>& fleet);
 
 private:
-    std::mutex mutex_;
-    // 存在于 TaskManager 的内存里，就是一个单纯的数字（1, 2, 3...）。它的唯一作用就是为了防止重复
-    // taskID 由 taskSeq_ 和时间戳组合而成
+    // 上一个发出的句柄时间戳部分 (毫秒 << 16 | 序号)，全部分片共用
+    // taskID 由它和分片号组合而成 (见 model/TaskHandle.h)
     /* 【业务层求“稳”和“久”，用 uint64 确保哪怕跑一万年 ID 也不重复。】
-    业务唯一性：这是用来生成 TaskId (如 T-时间-001) 的。如果系统运行了十年，或者在一秒内生成了海量任务，32 位整数是有可能溢出重复的。而 64 位整数（2^64 ≈ 1.8e19）足以保证人类文明史内不溢出。
+    业务唯一性：同一毫秒内最多 65536 个序号，超出时借位到毫秒字段 (CAS 取 max(上一个 + 1, 当前毫秒起点))，
+        时钟回拨或一次批量建单都不会重复
     数据库/存储兼容：在生成唯一 ID 方面，通常都会用 64 位整型（比如 Twitter Snowflake 算法也是 64 位），这更符合后端存储的主键设计规范。
     */
-    std::atomic<uint64_t> taskSeq_{0};
+    std::atomic<uint64_t> lastStamp_{0};
 
-    // 任务等待队列 
-    /*
-    场景特点：随机挑选 + 中间删除 (Scheduling)
-    调度器（TaskManager）不是简单的“先来后到”，它有复杂的逻辑。
-        读操作：需要遍历整个链表，比较哪个任务距离车最近（贪心算法）。
-        写操作：找到那个最佳任务后，需要把它从队列的中间或者任意位置拿走（移入 runningTasks）。
-    */
-    std::list<spTaskContext> pendingTasks_;
+    bool initialized_ = false;
 
-    // 执行中的任务映射 ： AgvId -> TaskContext (1 车 同时 1任务)
-    std::map<int, spTaskContext> runningTasks_;
+    // 任务日志 : OpenJournal 里创建并发布，之后只读
+    std::unique_ptr<TaskJournal> journalOwner_;
+    std::atomic<TaskJournal*> journal_{nullptr};
 
-    /*
-    目前的逻辑看起来 TaskManager 是独占的，但考虑到：
-        要支持 运行时切换；
-        未来可能接入 Web 监控,打印；
-        AI算法对象可能很 重: 想在两个不同的地方复用同一个 AI 策略（例如：一个是真实的调度器，一个是后台跑的“仿真预测器”）。使用 shared_ptr，可以让 TaskManager 和 SimulationManager 共享同一个 AI 模型实例，而不需要在内存里加载两份几百 MB 的模型。
+    // 分区参数
+    int zoneCols_ = 1;
+    int zoneRows_ = 1;
 
-        使用 std::shared_ptr 是最稳健、容错率最高的选择，也是 C++ 后端开发处理“服务组件”时的惯例。
-    */
-    //持有策略接口指针（基类指针）
-    std::shared_ptr<algo::scheduler::ITScheduler> scheduler_;
+    // 分片 : Init 时创建，之后只读
+    std::vector<std::unique_ptr<TaskShard>> shards_;
 
-    // 指针成员可以配合 二段式初始化
-    /*
-    引用成员：必须在构造函数的初始化列表中立即绑定。
-    指针成员：可以在构造函数里，也可以在后续任何时候赋值。
-    */
-    // 初始化为 nullptr，表示“未就绪”
-    myreactor::ThreadPool* workerPool_ = nullptr;
+    // Init 之前注入的设置，创建分片时装上
+    SchedulerMaker schedulerMaker_;
+    DispatchSink dispatchSink_;
 
+    // 车辆归属 : agvId -> (分片下标, 是否被占住)
+    struct OwnerSlot {
+        size_t shard = 0;
+        bool held = false;  // 有任务序列 : 不可借出
+    };
+    mutable std::shared_mutex ownerMutex_;
+    std::unordered_map<int, OwnerSlot> agvOwner_;
 };
 
 
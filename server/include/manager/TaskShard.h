@@ -0,0 +1,355 @@
+#pragma once
+
+#include "manager/TaskManager.h"
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <string>
+#include <vector>
+#include "algo/scheduler/ITScheduler.h"  // 接口
+#include "manager/IndexedTaskQueue.h"
+#include "utils/MpscRing.h"
+#include "utils/TimingWheel.h"
+#include "algo/scheduler/TaskBundler.h"
+#include "config/ServerConfig.h"
+#include "manager/AgvSlotTable.h"
+
+namespace myreactor{
+    class ThreadPool;
+}
+
+/*
+任务分片 (Task Shard) : 一个地图分区的完整调度单元
+    原来 TaskManager 一把 mutex_ 管全部 pendingTasks_ / runningTasks_，所有上报、派单、回滚都在这把锁上排队，
+    调度轮次也只能串行跑。车队上千辆时锁竞争和单轮耗时都线性变大
+现在按分区切开，每个分片独立持有：
+    待派队列 / 执行中序列 / 调度器实例 / 写者线程
+    不同分片的上报与调度轮次互不阻塞，轮次在 worker 线程池上并行计算
+归属：
+    任务按目标点所在分区入片; 车辆归属由 TaskManager 统一维护 (见 TaskManager::agvOwner_)
+    分片只调度归属于自己的车，提交决策时占住 (Hold) 车辆，保证一辆车不会被两个分片同时派单
+
+单写者 (Actor) 模型：
+    分片状态只由自己的写者线程修改，不再有 mutex_。其他线程 (WMS / IO / worker) 一律投递类型化事件：
+        ADD_TASK      新任务           (AddTask)
+        ADD_TASKS     一批新任务       (AddTasks，整批入队后只通知一次调度)
+        REPORT        车辆上报         (OnTaskReport，IO 线程)
+        ACK           下发 RPC 的结果  (Session 回调，IO 线程; 超时也从这里回来)
+        SET_PRIORITY  改优先级
+        ROUND_DONE    调度器的决策结果 (worker 线程算完后投回)
+        SET_SCHEDULER 切换调度器
+    事件经有界 MPSC 环 (MpscRing) 进入写者线程，按入环顺序逐个应用 : 没有锁车队，事件顺序确定
+    调度轮次：
+        写者线程按防抖节奏 (脏标记 + minInterval / batchSize，原 DispatchCoordinator 的逻辑) 拍快照，
+        把计算投到 worker 线程池，决策以 ROUND_DONE 事件回到写者线程落地 (Double Check 不变)
+        同一时刻最多一轮在途
+    查询走发布的快照 : 待派数量等由写者线程在每批事件后发布到原子量，读方无需排队
+内联模式 (离线仿真，pool == nullptr)：调用线程就是唯一写者，事件直接应用，轮次由 RunPendingRound 同步执行
+*/
+
+namespace agv{
+namespace manager{
+
+class TaskShard {
+public:
+    using spTaskContext = std::shared_ptr<TaskContext>;
+
+    TaskShard(size_t index, TaskManager* owner);
+    ~TaskShard() = default;
+    TaskShard(const TaskShard&) = delete;
+    TaskShard& operator=(const TaskShard&) = delete;
+
+    // pool 传 nullptr 为内联模式 (见 TaskManager::Init)
+    void Init(myreactor::ThreadPool* pool, const config::DispatchConfig& cfg);
+    // 停止写者线程; 之后投递的事件被丢弃
+    void Stop();
+
+    size_t Index() const { return index_; }
+
+    // ---------- 写操作 (投递事件，任意线程) ----------
+    // 入队一个已构造好的任务
+    void AddTask(const spTaskContext& task);
+    // 入队一批任务 : 一个事件
+    void AddTasks(std::vector<spTaskContext>&& tasks);
+
+    // 调整待派任务的优先级 (异步; 不在待派队列时只打日志)
+    void SetTaskPriority(model::TaskHandle taskId, int priority);
+
+    // 处理任务上报 (调用方已按车辆归属路由到本分片)
+    void OnTaskReport(const model::TaskReport& msg);
+
+    // 标脏，唤醒写者线程发起一轮调度
+    void TryDispatch();
+
+    // Init 之前直接装上，之后作为事件投递
+    void SetScheduler(std::shared_ptr<algo::scheduler::ITScheduler> sche);
+    // 只能在 Init 之前或内联模式下调用 (写者线程运行时不可替换)
+    void SetDispatchSink(TaskManager::DispatchSink sink);
+
+    // ---------- 内联模式 ----------
+    bool HasPendingRound() const { return roundDirty_.load(std::memory_order_acquire); }
+    bool RunPendingRound();
+
+    // ---------- 查询 (发布的快照) ----------
+    // 待派任务数
+    size_t PendingCount() const { return pendingPub_.load(std::memory_order_relaxed); }
+
+private:
+    // 一轮调度的输入与结果 : 写者线程拍快照 -> worker 计算 -> ROUND_DONE 回到写者线程
+    struct Round;
+
+    // 类型化事件 : 环里的槽位，按值移动
+    struct Event {
+        enum class Type : uint8_t { ADD_TASK, ADD_TASKS, REPORT, ACK, SET_PRIORITY, ROUND_DONE, SET_SCHEDULER };
+        Type type = Type::ADD_TASK;
+        spTaskContext task;                 // ADD_TASK
+        std::vector<spTaskContext> tasks;   // ADD_TASKS
+        model::TaskReport report{};         // REPORT
+        int agvId = -1;                     // ACK
+        model::TaskHandle taskId;           // ACK / SET_PRIORITY
+        bool ok = false;                    // ACK
+        int priority = 0;                   // SET_PRIORITY
+        std::string reason;                 // ACK 失败原因 (成功时为空，不分配)
+        std::shared_ptr<Round> round;       // ROUND_DONE
+        std::shared_ptr<algo::scheduler::ITScheduler> scheduler;  // SET_SCHEDULER
+    };
+
+    // 投递 : 内联模式直接应用; 环满时自旋让出 CPU 等写者消费 (背压)
+    void Post(Event&& ev);
+    void Apply(Event& ev);
+
+    // 写者线程主循环 : 排空事件 -> 防抖到期则发起一轮 -> 无事可做时休眠
+    void RunLoop();
+    // 唤醒可能在休眠的写者线程
+    void Wake();
+
+    // 以下 Apply* / 调度函数只在写者线程 (内联模式为调用线程) 执行
+    void ApplyAddTask(const spTaskContext& task);
+    void ApplyAddTasks(const std::vector<spTaskContext>& tasks);
+    // 入待派队列 + 记任务侧 delta (不通知调度)
+    void Enqueue(const spTaskContext& task);
+    void ApplySetPriority(model::TaskHandle taskId, int priority);
+    void ApplyReport(const model::TaskReport& msg);
+    // 处理 RPC 发送结果
+    void ApplyAck(int agvId, model::TaskHandle taskId, bool success, const std::string& reason);
+
+    // 发布查询快照
+    void Publish();
+
+    // 排队键 : 创建时间 - 优先级 × 老化窗口 (静态键，老化无需重扫)
+    int64_t ComputeRank(int priority, const myreactor::Timestamp& createTime) const;
+
+    // 发起一轮 : 拍快照 + 跨区借车，计算投给 worker (内联模式同步算完并落地)
+    void BeginRound();
+
+    // 计算 【Worker 线程】: 只读快照 + 调度器，不碰分片状态
+    void ComputeRound(Round& round);
+
+    // 落地 (ROUND_DONE) : 提交决策 + 增量反馈
+    void FinishRound(Round& round);
+
+    // 执行调度 (全量模式) : 返回决策
+    std::vector<algo::scheduler::DispatchResult> ExecuteDispatch(
+        const std::vector<spTaskContext>& tasksSnapst,
+        const std::vector<model::AgvInfo>& agvsSnapst,
+        const algo::scheduler::Backlog& backlog,
+        const std::shared_ptr<algo::scheduler::ITScheduler>& currSche);
+
+    // 任务侧增量 : 进入 / 离开待派队列的任务 (新建 / 回滚 / 改优先级)
+    struct TaskDelta {
+        spTaskContext task;
+        bool requeue;          // 回滚重派
+        bool removed = false;  // true 表示离开待派队列
+    };
+
+    // 执行调度 (增量模式) : resyncTasks 非空表示需要全量重放; 返回决策，反馈在 FinishRound 里做
+    std::vector<algo::scheduler::DispatchResult> ExecuteIncremental(
+        const std::shared_ptr<algo::scheduler::ITScheduler>& sche,
+        const std::vector<model::AgvInfo>& agvsSnapst,
+        const std::vector<char>& occupied,
+        const std::vector<TaskDelta>& deltas,
+        const std::vector<spTaskContext>* resyncTasks);
+
+    // 决策落地 (两种模式共用); committed 中的 followUps 为实际串上的后续任务
+    void CommitDecisions(
+        const std::vector<algo::scheduler::DispatchResult>& decisions,
+        std::vector<algo::scheduler::DispatchResult>* committed,
+        std::vector<int>* rejectedAgvs);
+
+    // 通过 Session 下发一个任务 (RPC)，失败返回 false
+    bool SendTask(int agvId, const spTaskContext& task);
+
+    // 每辆车的任务序列 : 并单 + 预推送
+    struct AgvTaskSeq {
+        std::deque<spTaskContext> tasks;  // front 为正在执行的任务，其后为已排定的后续任务
+        size_t sent = 0;                  // 前 sent 个已下发到车上 (执行中 + 预推送)
+    };
+
+    // 把序列中 [idx, end) 的任务退回等待队列 (记下收回原因)，返回退回的数量
+    size_t RollbackFrom(AgvTaskSeq& seq, size_t idx, ReclaimReason reason);
+
+    // 看门狗 : 给执行中的首单定 (重定) 进度期限; 推进时间轮，收回到期的序列
+    void ArmWatchdog(const spTaskContext& head, int agvId, int64_t nowMs);
+    void CheckStalled();
+
+    // 预测派单 : 把快照里 “快做完最后一单” 的忙车改写成候选 (位置 = 预计空闲点, etaCells = 剩余格数)
+    // 结果记入 predictedAgvs_，返回改写的数量
+    size_t PredictFreeAgvs(std::vector<model::AgvInfo>& agvs);
+
+    // 日志打印封装
+    // 日志类型枚举：
+    enum class LogAction {
+        DISPATCH_SUCCESS,       // 派单成功 (INFO)
+        DOUBLE_CHECK_FAILED,    // 双重检查失败：小车状态变动（物理与逻辑） (WARN)
+        SESSION_LOST,           // 会话丢失：查不到 Session 指针 (WARN)
+        DISPATCH_FAILED,        // 可能多个原因，没登录/没设置回调 (ERROR)
+        BUNDLE_PLANNED,         // 并单：首单后串上了 extraVal 个后续任务 (INFO)
+        PRE_ASSIGNED            // 预测派单：排在忙车当前任务之后 (INFO)
+        // ROLLBACK_FAILED         // 回滚失败 (WARN)
+    };
+
+    // 通用日志条目：包含所有类型可能用到的字段 (定长，入队不分配堆内存)
+    // 写者线程上已无锁可言，仍然先攒后打 : 落地一批决策的循环里不做格式化
+    struct DeferredLog {  // 延迟日志
+        LogAction action;       // 类型
+        model::TaskHandle taskId; // 关联的任务ID
+        int agvId;              // 关联的AGV
+        int extraVal;           // 额外数值 (距离、状态等)
+    };
+
+    void ProcessLogs_TD(const std::vector<DeferredLog>& logs);
+
+private:
+    const size_t index_;
+    TaskManager* const owner_;  // 车辆归属 / 跨区均衡
+
+    // ---------- 写者线程 ----------
+    MpscRing<Event> events_;
+    std::unique_ptr<std::thread> thread_;
+    std::atomic<bool> stop_{true};
+
+    // 休眠 / 唤醒 : 写者线程只在没事可做时才拿 wakeMutex_，生产者只在 sleeping_ 时才通知
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCond_;
+    std::atomic<bool> sleeping_{false};
+
+    // 防抖参数 + 在途标记 (写者线程独占)
+    std::chrono::milliseconds minInterval_{50};
+    int batchSize_ = 32;
+    bool inFlight_ = false;
+    std::chrono::steady_clock::time_point lastRound_{};
+    std::atomic<int> dirtyEvents_{0};  // 上一轮开始后累计的通知数
+
+    // ---------- 发布的快照 ----------
+    std::atomic<size_t> pendingPub_{0};
+
+    // 任务等待队列
+    /*
+    场景特点：随机挑选 + 中间删除 (Scheduling)
+    调度器（TaskManager）不是简单的“先来后到”，它有复杂的逻辑。
+        读操作：需要遍历整个链表，比较哪个任务距离车最近（贪心算法）。
+        写操作：找到那个最佳任务后，需要把它从队列的中间或者任意位置拿走（移入 runningTasks）。
+    std::list 每轮全量拷贝 + remove_if 都是 O(n); 改为带索引的优先队列：
+        按 ID 删除 / 改优先级 O(log n)，每轮只取队首一个窗口 (TopN)，不再拷贝整个积压
+    */
+    IndexedTaskQueue pendingTasks_;
+    // 上一轮发起以来进入等待队列的任务数 (新建 + 回滚)，随轮次交给调度器
+    size_t arrivals_ = 0;
+
+    // 老化窗口 : 每高 1 级优先级，等价于早创建 agingMs_ 毫秒
+    int64_t agingMs_ = 30000;
+
+    // 执行中的任务映射 ： AgvId -> 任务序列
+    /*
+    原来是 1 车 1 任务，车必须上报 IDLE + progress 1.0 才能拿到下一单，每单之间都有一段空档：
+        上报 -> 调度轮次 -> RPC 往返
+    现在每辆车挂一个有序序列：
+        1. 并单：派首单时顺手串上几个顺路任务 (TaskBundler)
+        2. 预推送：当前任务进度超过 prefetchProgress_ 时，就把下一单提前下发，车做完当前单无缝衔接
+    */
+    /*
+    按槽位下标存放 (见 AgvSlotTable)，每次上报 / 派单 / 占用检测都是 O(1) 下标访问
+    slot 记着建序列时的槽位句柄，代数对不上 (槽位已回收给别的车) 当作没有序列
+    */
+    struct SeqEntry {
+        AgvSlot slot;
+        bool active = false;
+        AgvTaskSeq seq;
+    };
+    std::vector<SeqEntry> runningTasks_;
+
+    // AgvId -> 任务序列，没有返回 nullptr
+    AgvTaskSeq* FindSeq(int agvId);
+    // 在槽位上建一个空序列 (派单前已查好槽位)
+    AgvTaskSeq& EmplaceSeq(AgvSlot slot);
+    void EraseSeq(int agvId);
+
+    // 并单器 + 预推送阈值
+    algo::scheduler::TaskBundler bundler_;
+    double prefetchProgress_ = 0.7;
+
+    // 预测派单 : 预计 predictHorizonMs_ 内空闲的忙车也参与调度，派给它的单排在当前任务之后
+    int64_t predictHorizonMs_ = 3000;
+    double nominalSpeed_ = 2.0;
+
+    // 进度看门狗 : 执行中首单 -> 所在车辆，按进度期限挂在分层时间轮上
+    /*
+    原来 updateTime 只记不查，车默默停止上报时任务永远挂在 runningTasks_ 里
+    每次上报都要重新定时，所以不能每秒扫一遍全部执行中任务 : 时间轮的重定时是一次哈希查找 + 链表挪动
+    到期 = stallTimeoutMs_ 内没有首单的上报，整条序列按 STALLED 退回待派队列
+    */
+    using Watchdog = TimingWheel<model::TaskHandle, int>;
+    Watchdog watchdog_;
+    std::vector<Watchdog::Expired> stalled_;
+    int64_t stallTimeoutMs_ = 30000;
+
+    /*
+    目前的逻辑看起来 TaskManager 是独占的，但考虑到：
+        要支持 运行时切换；
+        未来可能接入 Web 监控,打印；
+        AI算法对象可能很 重: 想在两个不同的地方复用同一个 AI 策略（例如：一个是真实的调度器，一个是后台跑的“仿真预测器”）。使用 shared_ptr，可以让 TaskManager 和 SimulationManager 共享同一个 AI 模型实例，而不需要在内存里加载两份几百 MB 的模型。
+
+        使用 std::shared_ptr 是最稳健、容错率最高的选择，也是 C++ 后端开发处理“服务组件”时的惯例。
+    */
+    //持有策略接口指针（基类指针）; 增量调度器带内部状态，每个分片一个实例
+    std::shared_ptr<algo::scheduler::ITScheduler> scheduler_;
+
+    // 初始化为 nullptr，表示“未就绪”
+    myreactor::ThreadPool* workerPool_ = nullptr;
+
+    // 内联模式 : 没有写者线程，TryDispatch 只置脏标记
+    bool inline_ = false;
+    std::atomic<bool> roundDirty_{false};
+
+    // 下发出口; 为空时走 Session
+    TaskManager::DispatchSink dispatchSink_;
+
+    // ---------- 增量调度 ----------
+    // 两轮之间累积的任务增量
+    std::vector<TaskDelta> taskDeltas_;
+
+    // 以下只在调度轮次内访问 (同一时刻最多一轮在途，worker 与写者线程之间经事件环交接)
+    // 上一轮的车辆可派视图，用于差分出 Freed / Busy / Moved
+    struct AgvView {
+        bool available = false;
+        model::Point pos{};
+        int etaCells = 0;
+        uint64_t epoch = 0;
+    };
+    std::unordered_map<int, AgvView> agvView_;
+    // 本轮被预测为即将空闲的车 (CommitDecisions 据此走预分配)
+    std::unordered_set<int> predictedAgvs_;
+    uint64_t viewEpoch_ = 0;
+    // 当前已同步过增量状态的调度器实例
+    std::shared_ptr<algo::scheduler::ITScheduler> syncedScheduler_;
+};
+
+}
+}
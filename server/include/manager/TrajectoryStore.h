@@ -0,0 +1,96 @@
+#pragma once
+
+#include "model/AgvStructs.h"
+#include "manager/AgvSlotTable.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+车辆轨迹 (按槽位下标，每车一个定长环形缓冲)
+原来只有最新位置 (FleetStateStore 里每次心跳整体覆盖)，没有任何历史，事后分析 (某段时间谁经过了某个区域、某车最近怎么走的) 无从查起
+现在 :
+    每辆车一个环 : 容量 capacity 个采样 (时间, x, y, 状态)，写满后覆盖最旧的
+    单写者 : 只在心跳路径写; 同一辆车的心跳都来自它连接所在的 IO 线程 (仿真里只有一个线程)，不需要写者互斥
+    多读者 : 查询不拿锁，也不写共享内存
+        每个单元带序号 seq (= 采样编号 + 1)，写前置 0、写完再置回 (单元级 seqlock，同 FleetStateStore 的写法)
+        读者前后两次读到的 seq 都等于期望编号才算有效，正被覆盖 / 已被覆盖的单元直接丢弃
+    内存有界 : 缓冲在车辆首次登录时按槽位分配 (登录路径，不在心跳路径)，槽位回收给别的车时复用，不释放
+        单元 24 字节 : 2000 辆 × 600 个采样 (10Hz 保留 60s) ≈ 27MB
+    降采样 : 距上一次采样不足 sampleIntervalMs 的心跳不记
+*/
+
+namespace agv{
+namespace manager{
+
+struct TrajSample {
+    int64_t tsMs = 0;
+    model::Point pos;
+    model::AgvStatus status = model::AgvStatus::UNKNOWN;
+};
+
+struct TrajHit {
+    int agvId;
+    TrajSample sample;
+};
+
+class TrajectoryStore{
+public:
+    static constexpr uint32_t kSlots = AgvSlotTable::kMaxSlots;
+
+    TrajectoryStore();
+    ~TrajectoryStore();
+
+    TrajectoryStore(const TrajectoryStore&) = delete;
+    TrajectoryStore& operator=(const TrajectoryStore&) = delete;
+
+    // 启动时调用一次 (在任何车登录之前) ; capacity : 每车采样数 (0 关闭)
+    void Configure(int capacity, int sampleIntervalMs);
+    bool Enabled() const { return capacity_ > 0; }
+
+    // 登录 : 槽位归属这辆车，之前的采样 (上一任车主 / 上一次连接) 不再可见
+    void Attach(AgvSlot slot, int agvId);
+    // 下线 : 查询不再返回这辆车
+    void Detach(AgvSlot slot);
+
+    // 心跳路径 (该车的唯一写者) : 追加一个采样
+    void Record(AgvSlot slot, int64_t nowMs, const model::Point& pos, model::AgvStatus status);
+
+    // 某辆车 sinceMs 之后的采样，按时间先后追加到 out; 槽位已换主返回 0; 返回追加的个数
+    size_t Recent(AgvSlot slot, int agvId, int64_t sinceMs, std::vector<TrajSample>& out) const;
+
+    // 所有在线车 sinceMs 之后落在矩形 [minP, maxP] (闭区间) 内的采样
+    void InRect(const model::Point& minP, const model::Point& maxP, int64_t sinceMs, std::vector<TrajHit>& out) const;
+
+private:
+    struct Cell {
+        std::atomic<uint64_t> seq{0};    // 采样编号 + 1; 0 : 空 / 正在写
+        std::atomic<int64_t> stamp{0};   // 时间 (毫秒) << 8 | 状态
+        std::atomic<uint64_t> pos{0};    // x << 32 | y (各 32 位)
+    };
+
+    struct Ring {
+        std::atomic<Cell*> cells{nullptr};
+        std::atomic<int> agvId{-1};      // -1 : 无主
+        std::atomic<uint64_t> head{0};   // 下一个采样编号 (只增不减)
+        std::atomic<uint64_t> base{0};   // 当前车主的第一个采样编号
+        std::atomic<int64_t> lastMs{0};  // 上一个采样时间 (降采样用)
+    };
+
+    static int64_t PackStamp(int64_t tsMs, model::AgvStatus status);
+    static uint64_t PackPos(const model::Point& p);
+    static void Unpack(int64_t stamp, uint64_t pos, TrajSample& out);
+
+    // 从新到旧遍历 : fn(const TrajSample&) 返回 false 停止
+    template <typename F>
+    void Scan(const Ring& r, int64_t sinceMs, F&& fn) const;
+
+private:
+    uint32_t capacity_ = 0;
+    int sampleIntervalMs_ = 100;
+    std::unique_ptr<Ring[]> rings_;
+};
+
+}
+}
@@ -6,7 +6,15 @@
 #include "algo/planner/IPPlanner.h"
 #include "model/AgvStructs.h"
 #include "map/GridMap.h"
+#include "manager/AgvSlotTable.h"
+#include "manager/FleetStateStore.h"
+#include "manager/LivenessTracker.h"
+#include "manager/TrajectoryStore.h"
+#include "manager/DeadlockDetector.h"
+#include "manager/ReservationTable.h"
 #include <memory>
+#include <mutex>
+#include <atomic>
 
 /*
 全局世界管理器 (单例模式) - AGV 运行的 “数字孪生世界”
@@ -35,6 +43,19 @@ namespace manager{
 using Point = model::Point;
 using Info  = model::AgvInfo;
 
+/*
+车队快照 : 构建之后只读，shared_ptr<const> 引用计数共享
+    调度轮次、监控、调度器拿到的是同一份，取快照只是一次引用计数 +1，不再逐车拷贝 AgvInfo (含 version 字符串)
+    epoch : 构建时的 “结构纪元” (登录 / 下线 / 状态变化计数); writeStamp : 构建时所有槽位写序号之和
+*/
+struct FleetSnapshot {
+    uint64_t epoch = 0;
+    uint64_t writeStamp = 0;
+    int64_t builtMs = 0;
+    std::vector<Info> agvs;  // 在线车辆，按槽位顺序
+};
+using spFleetSnapshot = std::shared_ptr<const FleetSnapshot>;
+
 class WorldManager{
 public:
     // 创建与获取单例实例
@@ -65,17 +86,77 @@ public:
     // 获取单车状态
     model::AgvStatus  GetAgvStatus(int agvId) const;
 
-    // 获取所有车辆快照
+    // 获取所有车辆快照 (现拷一份)
     std::vector<Info> GetAllAgvs() const;
 
+    // 获取已发布的车队快照 (共享，不拷贝)
+    /*
+    重建条件 :
+        登录 / 下线 / 状态变化 (影响能否接单) : 立即重建
+        只有位置 / 电量 / 进度变化 : 距上次构建超过 snapshotIntervalMs 才重建，期间大家共用旧快照
+        什么都没变 : 一直复用
+    同一时刻只有一个线程在重建，其余线程拿现成的
+    */
+    spFleetSnapshot GetFleetSnapshot() const;
+
+    // ---------- 存活检测 (见 LivenessTracker) ----------
+    // 启动时调用一次; missedBeats 为 0 关闭
+    void ConfigureLiveness(int heartbeatIntervalMs, int missedBeats, int offlineBeats);
+
+    // 定时调用 (主 Loop 的 tick) : 失联的车置 UNKNOWN (立即退出派单候选)，返回判定下线、需要踢掉连接的车
+    std::vector<int> CheckLiveness();
+
+    // ---------- 轨迹 (见 TrajectoryStore) ----------
+    // 启动时调用一次 (在任何车登录之前); capacity 为 0 关闭
+    void ConfigureTrajectory(int capacity, int sampleIntervalMs);
+
+    // 某辆车最近 lastMs 毫秒的轨迹 (时间先后)
+    std::vector<TrajSample> QueryTrajectory(int agvId, int64_t lastMs) const;
+
+    // 最近 lastMs 毫秒内经过矩形 [minP, maxP] 的所有采样
+    std::vector<TrajHit> QueryTrajectoryInRect(Point minP, Point maxP, int64_t lastMs) const;
+
+    // ---------- 死锁检测 (见 DeadlockDetector) ----------
+    // 启动时调用一次 (地图加载之后)
+    void ConfigureDeadlock(bool enable, int gridlockMs, int replanHoldMs);
+
+    // PATH_REQ 到达 (IO 线程) : 正常寻路 / 原地等待 / 让路
+    DeadlockDetector::Verdict OnPathRequest(int agvId);
+
+    // 让路路径 : 起点 -> 侧格 -> 终点; 侧格出发找不到路时退回普通寻路
+    std::vector<Point> PlanBackoff(int agvId, Point start, Point side, Point end);
+
+    // 路径已下发 (工作线程)
+    void OnPathPlanned(int agvId, const std::vector<Point>& path);
+
+    // 定时调用 (主 Loop 的 tick) : 上报僵局
+    void CheckGridlock();
+
+    // ---------- 交通管制 (见 ReservationTable) ----------
+    // 启动时调用一次 (地图加载之后)
+    void ConfigureReservation(bool enable, int maxClaim);
+
+    // RESERVE_REQ (IO 线程，无锁) : 先放后拿
+    model::ReserveResponse Reserve(int agvId, const model::ReserveRequest& req);
+
+    // 格子当前的预约者 (-1 : 无)
+    int ReservedBy(Point p) const { return reservations_.Owner(p); }
+
+    // 快照重建间隔 (毫秒，0 : 任何变化都重建)
+    void SetSnapshotInterval(int ms) { snapshotIntervalMs_.store(ms > 0 ? ms : 0, std::memory_order_relaxed); }
+
     // ---------- 写操作 ---------- 按消息类型分类 : 由 AgvSession 调用
     
     // 1. 处理登录 (初始化静态信息 + 初始状态)
     void OnAgvLogin(const model::LoginRequest& req);
 
     // 2. 处理心跳 (更新物理信息：位置、电量、状态)
+    // 单条路径 : 服务端走 OnHeartbeats，这里留给离线仿真 (FleetSimulator) 逐车上报
     void OnHeartbeat(const model::Heartbeat& msg);
 
+    // 2'. 批量心跳 (一轮 IO 收到的全部心跳) : 逐条语义与 OnHeartbeat 相同，固定开销只付一次
+    void OnHeartbeats(const std::vector<model::Heartbeat>& batch);
+
     // 3. 处理任务上报 (更新逻辑信息：任务ID、进度、位置、状态)
     void OnTaskReport(const model::TaskReport& msg);
 
@@ -99,12 +180,54 @@ private:
     */
     WorldManager(const WorldManager&) = delete;
     WorldManager& operator=(const WorldManager&) = delete;
+
+    // 位置变化时更新观测速度 (在 FleetStateStore::Update 的写临界区内调用)
+    static void TrackMotion(AgvState& st, const Point& newPos, int64_t nowMs);
+
+    // 写一条心跳; 车不在线返回 false，状态有变化时置 statusChanged，位置变了置 moved
+    bool ApplyHeartbeat(AgvSlot slot, const model::Heartbeat& msg, int64_t now, bool& statusChanged, bool& moved);
+
+    // 位置变了 : 喂给死锁检测，成环则打日志
+    void TrackBlocking(int agvId, const Point& pos, int64_t now);
+    // 批量版本 (心跳合批) : 死锁检测整批只加一次锁
+    void TrackBlocking(const std::vector<DeadlockDetector::Move>& moves, int64_t now);
+    static void LogCycles(const std::vector<DeadlockDetector::CycleEvent>& events);
+
+    // 存储里的状态 -> 对外的 AgvInfo
+    static Info ToInfo(const AgvState& st);
+
+    // 快照是否仍可复用
+    bool IsSnapshotFresh(const spFleetSnapshot& snap, uint64_t epoch, int64_t nowMs) const;
 private:
     // 静态环境资源
     GridMap gridMap_;
 
-    // 动态环境资源
-    std::map<int, Info> onlineAgvs_;
+    // 动态环境资源 : 按槽位下标存放 (见 AgvSlotTable)，每槽一个 seqlock (见 FleetStateStore)
+    /* 
+    心跳 / 上报 / 登录 / 下线都只写自己那一槽，不拿 agvMutex_; 读者 (占用检查、状态查询、全量快照) 完全无锁
+    槽位代数不一致 (槽位已回收给别的车) 就当作不在线
+    下线只清 online 标记; 遍历按槽位顺序，即首次登录的顺序
+    */
+    FleetStateStore fleet_;
+
+    // 车队快照 : snapshot_ 用 std::atomic_load / atomic_store 读写 (发布后不可变); snapMutex_ 只串行化重建
+    std::atomic<uint64_t> fleetEpoch_{0};  // 登录 / 下线 / 状态变化时 +1 (写后递增)
+    std::atomic<int> snapshotIntervalMs_{0};
+    mutable std::mutex snapMutex_;
+    mutable spFleetSnapshot snapshot_;
+
+    // 心跳期限
+    LivenessTracker liveness_;
+
+    // 位置历史
+    TrajectoryStore trajectory_;
+
+    // 等待图
+    DeadlockDetector deadlock_;
+
+    // 格子预约
+    ReservationTable reservations_;
+    int maxClaim_ = 16;
 
     // 并发控制
     /*shared_mutex ： 读写锁
@@ -118,6 +241,7 @@ private:
             std::shared_lock<>  // 读锁
             std::unique_lock    // 写锁
     允许多个线程同时 PlanPath/IsWalkable (读)，但 UpdateAgvStatus (写) 会阻塞所有读写
+    车辆状态改用 seqlock 之后，这把锁只剩保护 planner_ 指针的热切换
     */
     mutable std::shared_mutex agvMutex_;
 
@@ -1,8 +1,13 @@
 #pragma once
 #include "session/AgvSession.h"
 #include "myreactor/Connection.h"
+#include "manager/AgvSlotTable.h"
+#include "utils/TimingWheel.h"
+#include "utils/RcuPtr.h"
 #include <memory>
 #include <map>
+#include <mutex>
+#include <vector>
 
 /*
 通过维护 “TCP 连接 ↔ AgvSession”“AGV ID ↔ AgvSession” 双映射关系，统一管理所有 AGV 会话的创建、销毁、查找，保证网络连接事件（创建 / 关闭）与业务会话状态（登录 / 下线）的一致性，同时为其他模块（Dispatcher/TaskManager）提供安全、统一的会话查找接口。
@@ -14,7 +19,7 @@ AgvManager 确实是桥梁，但它更重要的作用是 “翻译” 和 “同
 核心职责：
     1. 维护双向映射：[Connection -> Session] (物理层) 和 [AgvId -> Session] (业务层)
     2. 生命周期桥梁：将底层的网络事件 (Connect/Close) 转化为业务层的会话事件 (Login/Logout)
-    3. 线程安全中心：为多线程的 IO 回调和业务调用提供统一的加锁保护
+    3. 线程安全中心：查找走 RCU 快照 (读者只做原子计数，不拿锁)，上下线在写锁内复制发布，IO 回调与业务调用互不阻塞
 */
 
 namespace myreactor{
@@ -81,8 +86,34 @@ public:
     // 身份绑定 : 建立 逻辑映射
     void RegisterAgvId(int agvId, spSession sess);
     
-    // 供 TcpServer 定时调用的检查接口,内含 每个session的heckRpcTimeout
-    void CheckAllTimeouts(int64_t timeoutMils = 5000);
+    // ========== RPC 期限 (全局时间轮)
+    /*
+    原来每秒的 tick 拿着 mutex_ 遍历所有会话，每个会话再锁自己的待确认表、遍历整张 std::map 比较时间
+        车多、在途 RPC 多时，每秒都是 O(会话数 + RPC 数) 的扫描，而绝大部分 RPC 早就确认了
+    现在下发时把期限挂进一个时间轮 (见 utils/TimingWheel.h)，确认时摘掉 : 插入 / 取消 O(1)
+        tick 只推进时间轮，代价只和到期的条目数有关; 到期条目按 weak_ptr 找回会话 (会话已销毁则跳过)
+    */
+    // 启动时调用一次 : 总时限 + 重传策略 (见 AgvSession 的 RTT 估计)
+    void ConfigureRpc(int64_t timeoutMils, int maxRetries, int minRtoMs, int maxRtoMs);
+    const RpcPolicy& GetRpcPolicy() const { return rpcPolicy_; }
+
+    // 下发 / 重传 RPC 时登记期限 (绝对时间 ms，任意线程); 同一 seq 重复登记即改期
+    void ArmRpc(const spSession& sess, int32_t seq, int64_t deadlineMs);
+    // 确认 / 作废时摘掉 (任意线程)
+    void CancelRpc(uint32_t sid, int32_t seq);
+
+    /*
+    RPC 时间轮的节拍 : 由主 Loop 上一个独立的 kRpcTickMs 定时器推进 (见 AgvServer::SetupNecbs)
+        挂在 1s 的主 tick 上时，RTO 再小也要等到下一个整秒才重传，minRtoMs 形同虚设
+    */
+    static constexpr int kRpcTickMs = 100;
+
+    // 每 kRpcTickMs 调用一次 (主 Loop) : 推进期限时间轮，到期的交给各自的会话 (重传或按失败回调)
+    void CheckAllTimeouts();
+
+    // RPC 链路统计 (监控用) : 单车 / 所有已登录的车
+    bool GetRpcStats(int agvId, AgvSession::RpcStats& out);
+    std::vector<std::pair<int, AgvSession::RpcStats>> CollectRpcStats();
 
 
 private:
@@ -96,28 +127,65 @@ private:
     AgvManager& operator=(const AgvManager&) = delete;
 
 private:
-    std::mutex mutex_;
-
-    // 物理映射 Connection -> Session
-    // 持有 Session 的强引用 : 保证连接在, Session就在
-    /* Connection强引用
-    【防止“意外死亡”】：
-        如果没有 connMap_ 持有强引用，那么 Connection 的生命周期完全由底层的 TcpServer (或者 Reactor 的 event loop) 控制。 场景：万一底层逻辑有 Bug，或者某个瞬间所有引用都丢了，Connection 就会析构。 而 AgvManager 持有一份强引用，相当于由 业务层 给 Connection 上了一道 “最后保险”。 Connection 只有在 AgvManager::OnClose 里执行 connMap_.erase 之后，才能真正去死。 这保证了业务清理逻辑（Session 析构、通知 WorldManager）一定发生在 Connection 析构 之前。
-        这也是“回环设计”能生效的基础——必须有人拉住 Connection 不让它死，直到走完 OnClose 流程
-    【技术限制：std::map 的 Key 必须要“稳”】
-        如果用 weak_ptr 做 Key：
-            std::weak_ptr 本身没有重载 < 运算符，不能直接作为 std::map 的 Key。虽然可以通std::owner_less 来实现比较，但使用起来非常麻烦。
-        如果用 Connection* (裸指针) 做 Key：
-            虽然可以用，但裸指针不参与引用计数。
-            存在 ABA 问题（虽然在 64 位系统和内存池下概率极低，但逻辑上不严谨）：旧对象析构了，新对象恰好分配到了同一个内存地址。你的 map 可能会错误地把新连接当成旧连接。
-        使用 shared_ptr 做 Key：
-            shared_ptr 内置了比较机制（基于控制块地址），非常适合做 Key。它保证了 “只要这个 Key 在 map 里，这个 Key 指向的对象就一定活着”。这让代码逻辑变得非常简单的：不需要在使用 map 时判空或检查 expired。
-    */ 
-    std::map<spConnection, spSession> connMap_;
-
-    // 逻辑映射 AgvId -> Session
-    // 提供 O(logN) 的业务查找能力
-    std::map<int, spSession> idMap_;
+    /* 会话表 : RCU (读多写少)
+    原来一把 mutex_ 同时护着 connMap_ 和 idSlots_，每次查找都要抢它 :
+        派单 (ExecuteDispatch) 在 TaskManager 锁内逐条决策调用 GetSession(agvId)，两把全局锁嵌套;
+        超时 / 踢人 / 统计也都走这把锁，登录风暴时 IO 线程和派单线程互相等
+    现在两张表打包成一个不可变的快照 Registry，用 RcuPtr 发布 (见 utils/RcuPtr.h) :
+        读 : registry_.Read() 进入读临界区 (条带计数 +1)，在快照上查到 Session 拷贝出来就离开，不碰 mutex_
+            (不用 std::atomic_load(shared_ptr) : libstdc++ 里它按地址哈希到全局自旋锁上，每次读都要抢锁)
+        写 : 只有 连接建立 / 断开 / 登录注册 三处; 在 mutex_ 下 复制当前快照 -> 改副本 -> Exchange 发布
+            Exchange 等宽限期 (手里可能还拿着旧快照的读者全部离开) 后交回旧快照，调用方在锁外析构
+        复制代价 O(在线车数)，只发生在上下线时，换查找路径上零竞争
+    */
+    // 逻辑映射 AgvId -> Session : 按槽位下标 (见 AgvSlotTable)
+    // AgvId -> 槽位无锁直接寻址，再按下标取，O(1); slot 代数对不上的是过期元素，当作没有
+    struct IdEntry {
+        manager::AgvSlot slot;
+        spSession sess;
+    };
+
+    struct Registry {
+        // 物理映射 Connection -> Session
+        // 持有 Session 的强引用 : 保证连接在, Session就在
+        /* Connection强引用
+        【防止“意外死亡”】：
+            如果没有 connMap 持有强引用，那么 Connection 的生命周期完全由底层的 TcpServer (或者 Reactor 的 event loop) 控制。 场景：万一底层逻辑有 Bug，或者某个瞬间所有引用都丢了，Connection 就会析构。 而 AgvManager 持有一份强引用，相当于由 业务层 给 Connection 上了一道 “最后保险”。 Connection 只有在 AgvManager::OnClose 里从当前快照中删掉（且旧快照过了宽限期被析构）之后，才能真正去死。 这保证了业务清理逻辑（Session 析构、通知 WorldManager）一定发生在 Connection 析构 之前。
+            这也是“回环设计”能生效的基础——必须有人拉住 Connection 不让它死，直到走完 OnClose 流程
+        【技术限制：std::map 的 Key 必须要“稳”】
+            如果用 weak_ptr 做 Key：
+                std::weak_ptr 本身没有重载 < 运算符，不能直接作为 std::map 的 Key。虽然可以通std::owner_less 来实现比较，但使用起来非常麻烦。
+            如果用 Connection* (裸指针) 做 Key：
+                虽然可以用，但裸指针不参与引用计数。
+                存在 ABA 问题（虽然在 64 位系统和内存池下概率极低，但逻辑上不严谨）：旧对象析构了，新对象恰好分配到了同一个内存地址。你的 map 可能会错误地把新连接当成旧连接。
+            使用 shared_ptr 做 Key：
+                shared_ptr 内置了比较机制（基于控制块地址），非常适合做 Key。它保证了 “只要这个 Key 在 map 里，这个 Key 指向的对象就一定活着”。这让代码逻辑变得非常简单的：不需要在使用 map 时判空或检查 expired。
+        */ 
+        std::map<spConnection, spSession> connMap;
+        std::vector<IdEntry> idSlots;
+    };
+    using upRegistry = std::unique_ptr<Registry>;
+
+    // 写 : 复制当前快照 (调用方持有 mutex_)
+    upRegistry CopyLocked() const { return std::make_unique<Registry>(*registry_.Peek()); }
+
+    // AgvId -> 快照里当前有效的元素
+    static const IdEntry* FindId(const Registry& reg, int agvId);
+    static IdEntry* FindId(Registry& reg, int agvId);
+
+    std::mutex mutex_;                                   // 只在写者之间互斥
+    RcuPtr<Registry> registry_{std::make_unique<Registry>()};
+
+    // RPC 期限 : 键 = 会话编号 << 32 | seq; 独立的一把锁，与会话表互不阻塞
+    using RpcWheel = TimingWheel<uint64_t, std::weak_ptr<AgvSession>>;
+    static uint64_t RpcKey(uint32_t sid, int32_t seq) {
+        return (static_cast<uint64_t>(sid) << 32) | static_cast<uint32_t>(seq);
+    }
+
+    std::mutex rpcMutex_;
+    RpcWheel rpcWheel_{kRpcTickMs};
+    std::vector<RpcWheel::Expired> rpcExpired_;  // CheckAllTimeouts 复用 (只在主 Loop)
+    RpcPolicy rpcPolicy_;
 
 
 };
@@ -4,6 +4,7 @@
 #include "model/AgvStructs.h"
 #include "myreactor/Connection.h"
 #include <memory>
+#include <array>
 #include <atomic>
 #include <functional>
 #include <mutex>
@@ -21,6 +22,14 @@ namespace myreactor{
 namespace agv{
 namespace session{
 
+// RPC 重传策略 (AgvManager 启动时配置，各会话只读)
+struct RpcPolicy {
+    int64_t timeoutMs = 5000;  // 总时限 : 首发之后超过该时间还没确认即宣告失败
+    int maxRetries = 0;        // 总时限内最多重传几次 (0 : 不重传)
+    int minRtoMs = 1000;
+    int maxRtoMs = 4000;
+};
+
 /*
 只要一个类的生命周期是被 std::shared_ptr 管理的（AgvSession 就在 AgvManager 的 map 里被 shared_ptr 管理），且它需要在自己的成员函数内部，把自己作为 shared_ptr 传递给别人时，就必须继承 enable_shared_from_this。
 */
@@ -58,9 +67,10 @@ public:
    AGV被动 : “引用确认” (Reference), 目的是让 Server 知道 AGV 收到了哪条指令
    */
     void HandleLogin(const model::LoginRequest& req, int32_t seq); // AGV主动
-    void HandleHbeat(const model::Heartbeat& msg, int32_t seq);    // AGV主动
+    bool CheckHbeat(const model::Heartbeat& msg) const;            // 心跳合批前的会话校验 (已登录、ID 一致)
     void HandleTRepo(const model::TaskReport& msg, int32_t seq);   // AGV被动
     void HandlePRequ(const model::PathRequest& req, int32_t seq);  // AGV主动
+    void HandleReserve(const model::ReserveRequest& req, int32_t seq); // AGV主动
 
     // ---------------------------------------------------------
     // “服务器主动推送”模式 (Server Push) + RPC 支持
@@ -78,8 +88,24 @@ public:
     // 强制下线
     void ForceClose();
 
-    // 超时检查 : AgvManager调用，并一起绑定给TcpServer          【RPC 增强接口】
-    void CheckRpcTimeout(int64_t timeoutMils = 5000);  // 5000ms = 5s
+    // 超时 : AgvManager 的期限时间轮到期时回调 (主 Loop)，该 seq 还没确认就按失败回调     【RPC 增强接口】
+    void ExpireRpc(int32_t seq);
+
+    // 会话编号 (进程内唯一) : 与 seq 拼成全局的 RPC 期限键
+    uint32_t GetSid() const { return sid_; }
+
+    // RPC 链路统计 (监控用，任意线程)
+    struct RpcStats {
+        double srttMs = 0;         // 平滑 RTT
+        double rttvarMs = 0;       // RTT 偏差
+        int64_t rtoMs = 0;         // 当前重传超时
+        uint64_t samples = 0;      // RTT 采样数 (只采未重传过的请求，Karn 算法)
+        uint64_t acked = 0;
+        uint64_t retransmits = 0;
+        uint64_t timeouts = 0;     // 重传用尽仍未确认
+        int inflight = 0;          // 在途请求数
+    };
+    RpcStats GetRpcStats() const;
 
 private:
     // 内部核心工具 ： 借用 Connection 发送; 只服务于内部的 HandleXxx 和 DispatchXxx
@@ -163,20 +189,49 @@ private:
             而callback 保存了逻辑现场，即捕获上下文（Lambda 在创建时，把 this 指针、taskId、agvId 全部拷贝/移动到了这个对象内部），还保存逻辑（调 OnDispatchResult）
     */
     struct PendingRequest {                      // 【RPC 增强接口】
-        int32_t seq;
-        int64_t sendTime;
+        bool used = false;
+        int32_t seq = 0;
+        int64_t sendTime = 0;      // 首发时间 (ms) : 总时限从这里算
+        int64_t lastSendUs = 0;    // 最近一次发送 (us) : RTT 采样
+        int attempts = 0;          // 已发送次数
+        model::TaskRequest req;    // 原样重传 (同 seq、同 taskId，车端按 taskId 去重)
         RpcCallback cb; 
     };
 
-    std::map<int32_t, PendingRequest> pendingReqs_;   // 【RPC 增强接口】
-
-    /* 待确认请求表 
-        Key: 序列号, Value: 请求上下文
+    /* 待确认请求表 : 按 seq 直接寻址的定长环 (原来是 std::map<int32_t, PendingRequest>)
+        seq 是本会话自增的，下标 = seq & (kRpcRing - 1)，查找 / 插入 / 删除都是一次数组访问，不分配节点
+        同一辆车同时在途的 RPC 只有几条 (任务序列长度)，环绕一圈还没确认的最老请求直接按失败回调 (Evicted)
+        超时不再遍历本表 : 期限登记在 AgvManager 的全局时间轮里，到期才回来按 seq 取
     会被 Worker线程（AgvSession::DispatchTask内）Send以前）
-        IO线程 （AgvSession::HandleTRepo -> AgvSession::HandleAck） 使用，
-        因此需要 加锁
+        IO线程 （AgvSession::HandleTRepo -> AgvSession::HandleAck）
+        主 Loop （AgvSession::ExpireRpc） 使用，
+        因此需要 加锁 (临界区只有一次数组访问)
     */
-   std::mutex mapMutex_;                               // 【RPC 增强接口】
+    static constexpr int32_t kRpcRing = 64;
+    std::array<PendingRequest, kRpcRing> pendingReqs_;  // 【RPC 增强接口】
+
+   mutable std::mutex mapMutex_;                       // 【RPC 增强接口】
+
+    // 取走 seq 对应的待确认请求 (调用方持有 mapMutex_); 不在表里返回 false
+    bool TakePendingLocked(int32_t seq, PendingRequest& out);
+
+    /* RTT 估计与重传超时 (与 TCP 相同，RFC 6298)
+        每个确认的请求 (只取没重传过的，否则分不清确认的是哪一次发送) 得到一个 RTT 采样 r :
+            首个采样 : srtt = r, rttvar = r / 2
+            之后     : rttvar = 3/4 rttvar + 1/4 |srtt - r|,  srtt = 7/8 srtt + 1/8 r
+            rto = clamp(srtt + 4 rttvar, minRto, maxRto)
+        第 k 次重传的等待时间 = rto << k (指数退避，封顶 maxRto)，最后一次等到总时限
+        原来只发一次 : 车端一帧没收到 (Wi-Fi 抖动 / 车端卡顿) 就要等满 rpcTimeoutMs、回滚、重新派单
+    以下由 mapMutex_ 保护
+    */
+    void SampleRttLocked(int64_t rttUs);
+    // 本次发送之后的期限 (ms)
+    int64_t NextDeadlineLocked(const PendingRequest& pr, int64_t nowMs) const;
+
+    int64_t srttUs_ = 0;
+    int64_t rttvarUs_ = 0;
+    int64_t rtoMs_ = 1000;     // 还没有采样时按 1s (RFC 6298 的初值)
+    RpcStats stats_;
 
     /* 选择引用成员而不是指针成员
     引用必须绑定到一个真实存在的对象:“必须有线程池才能工作” 的强烈语义;
@@ -185,6 +240,8 @@ private:
     */ 
     myreactor::ThreadPool& workerPool_;
 
+    const uint32_t sid_;  // 进程内唯一的会话编号 (RPC 期限键的高 32 位)
+
 };
 
 }
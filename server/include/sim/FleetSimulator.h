@@ -0,0 +1,160 @@
+#pragma once
+
+#include "model/AgvStructs.h"
+#include "config/ServerConfig.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+离线离散事件仿真器 (Discrete-Event Simulation)
+目的：
+    在线评估要起 AgvServer + AgvSimulator，按真实时间跑 (每步 sleep 500ms)，一次评估动辄几十分钟
+    这里把 “车队 + 网络” 换成事件队列，直接驱动真实的 TaskManager / WorldManager / ITScheduler / IPPlanner
+    虚拟时钟通过 Timestamp::setClock 注入，业务代码里的 Timestamp::now() 全部读到仿真时间
+做法：
+    1. 事件按 (时间, 序号) 排序逐个处理，处理完直接把时钟跳到下一个事件 : 空等的时间不花 CPU
+    2. TaskManager 以内联模式运行 (Init(nullptr))，调度轮次由仿真器按 minIntervalMs 防抖后在本线程执行
+    3. 下发出口替换为 DispatchSink : 任务经 linkLatency 后 “到达” 仿真车辆，车辆行为与 AgvSimulator 一致
+         收单排队 -> WorldMgr.PlanPath 寻路 -> 每 cellTime 走一格并上报进度 -> 到点作业 -> 上报完成
+    4. 订单流 : 录制文件回放 或 泊松过程合成
+简化：不模拟车间碰撞 / 电量消耗 / 断线，车辆之间只通过 PlanPath 的起点占用检查互相影响
+单进程同一时刻只能有一个仿真实例 (TaskManager / WorldManager 都是单例)
+*/
+
+namespace agv {
+namespace sim {
+
+// 一个订单 : 相对仿真开始的到达时间
+struct SimOrder {
+    int64_t arriveMs = 0;
+    model::Point target;
+    int priority = 1;
+};
+
+// 仿真结果
+struct SimReport {
+    size_t orders = 0;
+    size_t completed = 0;
+    size_t failed = 0;              // 被车辆上报 ERROR 退回的次数
+
+    double makespanSec = 0;         // 首单到达 -> 末单完成
+    double tasksPerHour = 0;
+    double utilization = 0;         // 车辆持有任务的时间占比 (均值)
+
+    // 等待 : 到达 -> 首次下发;  交付 : 到达 -> 完成
+    double waitAvgSec = 0, waitP50Sec = 0, waitP95Sec = 0, waitMaxSec = 0;
+    double leadAvgSec = 0, leadP95Sec = 0;
+
+    uint64_t events = 0;
+    uint64_t dispatchRounds = 0;
+    double simSec = 0;              // 仿真时长
+    double wallSec = 0;             // 实际耗时
+    double speedup = 0;             // simSec / wallSec
+};
+
+class FleetSimulator {
+public:
+    // 地图须已由调用方加载进 WorldMgr，调度器 / 规划器也须已注入
+    FleetSimulator(const config::SimConfig& simCfg, const config::DispatchConfig& dispatchCfg);
+    ~FleetSimulator();
+
+    FleetSimulator(const FleetSimulator&) = delete;
+    FleetSimulator& operator=(const FleetSimulator&) = delete;
+
+    // 订单流 (二选一; 都不调用时 Run 会按 SimConfig 自动准备)
+    bool LoadOrders(const std::string& path);
+    void GenerateOrders();
+
+    // 跑到所有订单完成 / 事件耗尽 / 超过 maxSimHours
+    SimReport Run();
+
+    static void PrintReport(const SimReport& r);
+
+private:
+    enum class EvType {
+        ORDER,      // 订单到达
+        DISPATCH,   // 调度轮次
+        RECV,       // 任务到达车辆
+        PLAN,       // 车辆 (重新) 寻路
+        STEP,       // 走一格
+        FINISH      // 到点作业完成
+    };
+
+    struct Event {
+        int64_t atUs;
+        uint64_t seq;      // 同一时刻按插入顺序处理，保证可复现
+        EvType type;
+        int idx;           // 车辆下标 / 订单下标
+        bool operator>(const Event& o) const {
+            return atUs != o.atUs ? atUs > o.atUs : seq > o.seq;
+        }
+    };
+
+    struct SimAgv {
+        int uid = 0;
+        model::Point pos;
+        std::deque<model::TaskRequest> inbox;   // 在途 (网络中) 的下发
+        std::deque<model::TaskRequest> queue;   // 已收到、排队等待执行
+        model::TaskRequest cur;
+        bool hasTask = false;
+        std::vector<model::Point> path;
+        size_t pathIdx = 0;
+        int planFails = 0;
+        int64_t busySinceUs = 0;
+        int64_t busyTotalUs = 0;
+    };
+
+    // 每个任务的时间线
+    struct TaskTrace {
+        int64_t arriveUs = 0;
+        int64_t firstSentUs = -1;
+        int64_t doneUs = -1;
+    };
+
+    void Push(int64_t atUs, EvType type, int idx);
+    void ScheduleDispatch();
+
+    // DispatchSink : 在 TaskManager 落地决策的途中调用 (内联模式即本线程)，只能记账 + 投事件
+    bool OnSend(int agvId, const model::TaskRequest& req);
+
+    void HandleOrder(int idx);
+    void HandleRecv(SimAgv& agv);
+    void StartTask(SimAgv& agv, const model::TaskRequest& req);
+    void HandlePlan(SimAgv& agv);
+    void HandleStep(SimAgv& agv);
+    void HandleFinish(SimAgv& agv);
+    void NextTask(SimAgv& agv);
+
+    void Report(const SimAgv& agv, model::AgvStatus status, double progress, model::TaskHandle taskId);
+
+    SimReport BuildReport(double wallSec) const;
+
+private:
+    config::SimConfig cfg_;
+    config::DispatchConfig dispatchCfg_;
+
+    std::vector<SimOrder> orders_;
+    std::vector<SimAgv> agvs_;
+    std::unordered_map<int, size_t> agvIndex_;  // uid -> 下标
+    std::unordered_map<model::TaskHandle, TaskTrace> traces_;
+
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events_;
+    uint64_t seq_ = 0;
+    int64_t startUs_ = 0;
+    int64_t nowUs_ = 0;
+
+    bool dispatchQueued_ = false;
+    int64_t lastRoundUs_ = INT64_MIN / 2;
+    uint64_t rounds_ = 0;
+    uint64_t handled_ = 0;
+    size_t completed_ = 0;
+    size_t failed_ = 0;
+};
+
+}
+}
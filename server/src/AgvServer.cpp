@@ -3,6 +3,7 @@
 #include "manager/TaskManager.h"
 #include "manager/WorldManager.h"
 #include "utils/Logger.h"
+#include "algo/scheduler/SchedulerFactory.h"
 
 
 
@@ -49,7 +50,13 @@ void AgvServer::Init() {
 
 // 1st. 基础设置 (依赖注入)
 void AgvServer::SetupInfra() {
-    TaskMgr.Init(workerPool_.get());
+    TaskMgr.Init(workerPool_.get(), config_.dispatch);
+
+    // 调度策略注入 : 默认 Greedy 已在 TaskManager 构造时装好，这里只处理需要切换的情况
+    if (config_.scheduler.type != config::SchedulerType::GREEDY) {
+        auto cfg = config_.scheduler;
+        TaskMgr.SetScheduler([cfg] { return algo::scheduler::CreateScheduler(cfg); });
+    }
 }
 
 // 2nd. 系统资源 (地图加载、未来数据库连接等)
@@ -80,7 +87,16 @@ void AgvServer::InitSysRes() {
     }
 
     LOG_INFO("[Init] World Map initialized successfully.");
-    
+    AgvMgr.ConfigureRpc(config_.rpcTimeoutMs, config_.rpcRetry.maxRetries, config_.rpcRetry.minRtoMs, config_.rpcRetry.maxRtoMs);
+    WorldMgr.ConfigureReservation(config_.reservation.enable, config_.reservation.maxClaim);
+    WorldMgr.ConfigureDeadlock(config_.deadlock.enable, config_.deadlock.gridlockMs, config_.deadlock.replanHoldMs);
+    WorldMgr.ConfigureTrajectory(config_.trajectory.capacity, config_.trajectory.sampleIntervalMs);
+    WorldMgr.ConfigureLiveness(config_.liveness.heartbeatIntervalMs, config_.liveness.missedBeats, config_.liveness.offlineBeats);
+
+    // 任务日志 : 分区按地图尺寸算，必须在地图之后; 恢复出来的任务在开始监听之前就已重新入队
+    if (config_.journal.enable) {
+        TaskMgr.OpenJournal(config_.journal);
+    }
 }
 
 // 3rd. 底层回调
@@ -106,8 +122,15 @@ void AgvServer::SetupNecbs(){
     /*成员变量不能直接出现在 lambda 捕获列表中
     lambda 的捕获列表（[]里的内容）只能捕获 “当前作用域的局部变量 / 函数参数”，无法直接捕获 “类的成员变量”—— 因为成员变量属于 “对象实例”，而非 “当前函数作用域”。
     */
+    // RPC 期限 : 按时间轮的节拍单独推进，不跟 1s 的主 tick
+    tcpServer_->runevery(session::AgvManager::kRpcTickMs, [](){
+        AgvMgr.CheckAllTimeouts();
+    });
+
     tcpServer_->setTickcb( [this](){ 
-        AgvMgr.CheckAllTimeouts(this->config_.rpcTimeoutMs);
+        // 心跳期限 : 失联的车已在 WorldManager 内置 UNKNOWN，这里只踢判定下线的连接
+        for (int agvId : WorldMgr.CheckLiveness()) AgvMgr.KickAgv(agvId);
+        WorldMgr.CheckGridlock();
     });
 
     // tcpServer_->seterrorcb();    暂时不需要
@@ -128,12 +151,17 @@ void AgvServer::RegisBnhad() {
         }
     );
 
-    disPatcher_.registerHandler<Heartbeat>(
+    // 心跳合批 : 一轮 IO 收到的心跳先逐条做会话校验，再一次性写入 WorldManager
+    disPatcher_.registerBatchHandler<Heartbeat>(
         MsgType::HEARTBEAT,
-        [](const spConnection& conn, const Heartbeat& hb, int32_t seq){
-            // if(auto sess = AgvMgr.GetSession(conn))
-            if(auto sess = conn->getContext<session::AgvSession>())
-                sess->HandleHbeat(hb, seq);
+        [](std::vector<codec::Batched<Heartbeat>>& batch){
+            static thread_local std::vector<Heartbeat> valid;  // IO 线程各一份，容量复用
+            valid.clear();
+            for (const auto& item : batch) {
+                auto sess = item.conn->getContext<session::AgvSession>();
+                if (sess && sess->CheckHbeat(item.obj)) valid.push_back(item.obj);
+            }
+            WorldMgr.OnHeartbeats(valid);
         }
     );
 
@@ -154,6 +182,14 @@ void AgvServer::RegisBnhad() {
                 sess->HandlePRequ(req, seq);
         }
     );
+
+    disPatcher_.registerHandler<ReserveRequest>(
+        MsgType::RESERVE_REQ,
+        [](const spConnection& conn, const ReserveRequest& req, int32_t seq){
+            if(auto sess = conn->getContext<session::AgvSession>())
+                sess->HandleReserve(req, seq);
+        }
+    );
 }
 
 void AgvServer::Start() {
@@ -167,6 +203,7 @@ void AgvServer::Start() {
 void AgvServer::Stop() {
     LOG_INFO("AgvServer Stopping...");
     tcpServer_->stop();  // 先切断流量入口
+    TaskMgr.Stop();      // 停止发起新的调度轮次
     workerPool_->stop(); // 等待现有任务处理完
     LOG_INFO("AgvServer Stopped.");
 }
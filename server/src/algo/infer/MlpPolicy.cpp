@@ -0,0 +1,131 @@
+#include "algo/infer/MlpPolicy.h"
+#include "utils/Logger.h"
+#include <fstream>
+#include <cmath>
+
+namespace agv {
+namespace algo {
+namespace infer {
+
+namespace {
+
+template <typename T>
+bool ReadPod(std::ifstream& ifs, T& v) {
+    ifs.read(reinterpret_cast<char*>(&v), sizeof(T));
+    return static_cast<bool>(ifs);
+}
+
+}
+
+bool MlpPolicy::Load(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) {
+        LOG_ERROR("[MlpPolicy] Model file not found: %s", path.c_str());
+        return false;
+    }
+
+    uint32_t magic = 0, version = 0, inDim = 0, numLayers = 0;
+    FeatureScale scale;
+    if (!ReadPod(ifs, magic) || !ReadPod(ifs, version) || !ReadPod(ifs, inDim) || !ReadPod(ifs, numLayers) ||
+        !ReadPod(ifs, scale.pos) || !ReadPod(ifs, scale.time) || !ReadPod(ifs, scale.queue)) {
+        LOG_ERROR("[MlpPolicy] Model header truncated: %s", path.c_str());
+        return false;
+    }
+    if (magic != kMagic || version != kVersion) {
+        LOG_ERROR("[MlpPolicy] Bad model header: magic=0x%08X version=%u", magic, version);
+        return false;
+    }
+    // 归一化尺度做除数 : 0 / 负数 / NaN 会让全部特征变成 inf/NaN，logit 全是 NaN
+    if (!std::isfinite(scale.pos) || scale.pos <= 0.0f || !std::isfinite(scale.time) || scale.time <= 0.0f ||
+        !std::isfinite(scale.queue) || scale.queue <= 0.0f) {
+        LOG_ERROR("[MlpPolicy] Bad feature scale: pos=%g time=%g queue=%g", scale.pos, scale.time, scale.queue);
+        return false;
+    }
+    if (numLayers == 0 || numLayers > 16 || inDim == 0 || inDim > 1024) {
+        LOG_ERROR("[MlpPolicy] Unsupported model shape: layers=%u inputDim=%u", numLayers, inDim);
+        return false;
+    }
+
+    // 先读到局部变量，全部校验通过再替换，保证失败时旧模型不受影响
+    std::vector<DenseLayer> layers;
+    layers.reserve(numLayers);
+    uint32_t prevOut = inDim;
+
+    for (uint32_t l = 0; l < numLayers; ++l) {
+        uint32_t in = 0, out = 0, act = 0;
+        if (!ReadPod(ifs, in) || !ReadPod(ifs, out) || !ReadPod(ifs, act)) {
+            LOG_ERROR("[MlpPolicy] Layer %u header truncated", l);
+            return false;
+        }
+        if (in != prevOut || out == 0 || out > 4096 || act > static_cast<uint32_t>(Activation::TANH)) {
+            LOG_ERROR("[MlpPolicy] Layer %u shape mismatch: in=%u (expect %u) out=%u act=%u", l, in, prevOut, out, act);
+            return false;
+        }
+
+        // 文件中是 nn.Linear 的 [out][in] 布局
+        std::vector<float> w(static_cast<size_t>(out) * in);
+        DenseLayer layer;
+        layer.in = static_cast<int>(in);
+        layer.out = static_cast<int>(out);
+        layer.act = static_cast<Activation>(act);
+        layer.bias.resize(out);
+
+        ifs.read(reinterpret_cast<char*>(w.data()), sizeof(float) * w.size());
+        ifs.read(reinterpret_cast<char*>(layer.bias.data()), sizeof(float) * out);
+        if (!ifs) {
+            LOG_ERROR("[MlpPolicy] Layer %u weights truncated", l);
+            return false;
+        }
+
+        // 转置为 [in][out]
+        layer.wt.resize(w.size());
+        for (uint32_t o = 0; o < out; ++o)
+            for (uint32_t i = 0; i < in; ++i)
+                layer.wt[static_cast<size_t>(i) * out + o] = w[static_cast<size_t>(o) * in + i];
+
+        layers.push_back(std::move(layer));
+        prevOut = out;
+    }
+
+    if (prevOut != 1) {
+        LOG_ERROR("[MlpPolicy] Last layer must output 1 logit, got %u", prevOut);
+        return false;
+    }
+
+    layers_.swap(layers);
+    inputDim_ = static_cast<int>(inDim);
+    scale_ = scale;
+
+    LOG_INFO("[MlpPolicy] Model loaded: %s (inputDim=%d, layers=%u, kernel=%s)",
+             path.c_str(), inputDim_, numLayers, GemmKernelName());
+    return true;
+}
+
+void MlpPolicy::Forward(const float* x, int rows, std::vector<float>& out) {
+    out.resize(rows);
+    if (rows <= 0 || layers_.empty()) return;
+
+    const float* input = x;
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const DenseLayer& layer = layers_[l];
+        // 乒乓：偶数层写 A，奇数层写 B; 最后一层直接写进 out
+        bool isLast = (l + 1 == layers_.size());
+        float* dst = nullptr;
+        if (isLast) {
+            dst = out.data();
+        } else {
+            std::vector<float>& buf = (l % 2 == 0) ? bufA_ : bufB_;
+            size_t need = static_cast<size_t>(rows) * layer.out;
+            if (buf.size() < need) buf.resize(need);
+            dst = buf.data();
+        }
+
+        GemmBias(input, layer.wt.data(), layer.bias.data(), dst, rows, layer.out, layer.in);
+        ApplyActivation(dst, static_cast<size_t>(rows) * layer.out, layer.act);
+        input = dst;
+    }
+}
+
+}
+}
+}
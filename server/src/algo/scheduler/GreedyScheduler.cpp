@@ -9,8 +9,10 @@ namespace scheduler{
 
 std::vector<DispatchResult> GreedyScheduler::Dispatch(
         const std::vector<std::shared_ptr<manager::TaskContext>>& tasks,
-        const std::vector<model::AgvInfo>& candidates)
+        const std::vector<model::AgvInfo>& candidates,
+        const Backlog& backlog)
 {
+        (void)backlog; // 贪心只看本轮窗口
         std::vector<DispatchResult> results;
 
         // 决策意图记录：记录本批次已经分配的车，防止一车多单 （存在问题 set）
@@ -24,8 +26,8 @@ std::vector<DispatchResult> GreedyScheduler::Dispatch(
                 // 决策意图检查
                 if (assignedAgvs.count(agv.uid)) continue;
                 
-                // 贪心策略 ： 找最近
-                int dis = CalMhtDis(agv.currentPos, task->req.targetPos);
+                // 贪心策略 ： 找最近 (预测候选还要先走完手上的 etaCells 格)
+                int dis = agv.etaCells + CalMhtDis(agv.currentPos, task->req.targetPos);
                 if (dis< minDistance) {
                     minDistance = dis;
                     bestAgvId = agv.uid;
@@ -34,6 +36,7 @@ std::vector<DispatchResult> GreedyScheduler::Dispatch(
 
             // 记录新增决策意图
             if (bestAgvId != -1) {
+                assignedAgvs.insert(bestAgvId);
                 results.push_back({task, bestAgvId, minDistance});
             }       
         }
@@ -41,6 +44,75 @@ std::vector<DispatchResult> GreedyScheduler::Dispatch(
         return results;
 }
 
+// ================= 增量模式 =================
+
+void GreedyScheduler::Reset() {
+    queue_.Clear();
+    freeAgvs_.clear();
+}
+
+// 回滚任务保留原 rank，按键入堆即回到队首附近，requeue 无需特殊处理
+void GreedyScheduler::OnTaskAdded(const spTask& task, bool requeue) {
+    (void)requeue;
+    queue_.Push(task, task->rank); // 已存在时返回 false，天然幂等
+}
+
+void GreedyScheduler::OnTaskRemoved(model::TaskHandle taskId) {
+    queue_.Remove(taskId);
+}
+
+void GreedyScheduler::OnAgvFreed(const model::AgvInfo& agv) {
+    freeAgvs_[agv.uid] = {agv.currentPos, agv.etaCells};
+}
+
+void GreedyScheduler::OnAgvBusy(int agvId) {
+    freeAgvs_.erase(agvId);
+}
+
+void GreedyScheduler::OnAgvMoved(int agvId, const model::Point& pos) {
+    auto it = freeAgvs_.find(agvId);
+    if (it != freeAgvs_.end()) it->second.pos = pos;
+}
+
+/*
+与全量 Dispatch 语义一致 (按队列顺序，每个任务取剩余车辆中最近的)，区别在于：
+    1. 任一集合为空直接返回 O(1) —— 积压很大但没有车空出时，不再遍历积压
+    2. 车辆分完即停，只取队首 min(T, F) 个任务 : O(min(T,F)·F)，F 为可派车辆数 (通常远小于总车数)
+*/
+std::vector<DispatchResult> GreedyScheduler::DispatchIncremental() {
+    std::vector<DispatchResult> results;
+    if (queue_.Empty() || freeAgvs_.empty()) return results;
+
+    taskScratch_.clear();
+    queue_.TopN(freeAgvs_.size(), taskScratch_);
+
+    freeScratch_.assign(freeAgvs_.begin(), freeAgvs_.end());
+    usedScratch_.assign(freeScratch_.size(), 0);
+    size_t remain = freeScratch_.size();
+
+    for (const auto& task : taskScratch_) {
+        if (remain == 0) break;
+
+        int bestIdx = -1;
+        int minDistance = 9999999;
+        for (size_t i = 0; i < freeScratch_.size(); ++i) {
+            if (usedScratch_[i]) continue;
+            const FreeAgv& agv = freeScratch_[i].second;
+            int dis = agv.etaCells + CalMhtDis(agv.pos, task->req.targetPos);
+            if (dis < minDistance) {
+                minDistance = dis;
+                bestIdx = static_cast<int>(i);
+            }
+        }
+
+        usedScratch_[bestIdx] = 1;
+        --remain;
+        results.push_back({task, freeScratch_[bestIdx].first, minDistance});
+    }
+
+    return results;
+}
+
 
 }
 }
@@ -0,0 +1,161 @@
+#include "algo/scheduler/LyaSACScheduler.h"
+#include "manager/TaskManager.h"
+#include "utils/MathUtils.h"
+#include "utils/Logger.h"
+#include "myreactor/Timestamp.h"
+#include <algorithm>
+#include <numeric>
+
+namespace agv {
+namespace algo {
+namespace scheduler {
+
+LyaSACScheduler::LyaSACScheduler(double lyaV, int topK)
+    : lyaV_(lyaV > 0.0 ? lyaV : 1.0),
+      topK_(topK > 0 ? topK : 1)
+{}
+
+bool LyaSACScheduler::LoadModel(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!policy_.Load(path)) return false;
+
+    if (policy_.InputDim() != kFeatureDim) {
+        LOG_ERROR("[LyaSAC] Model inputDim=%d, scheduler expects %d. Model rejected.", policy_.InputDim(), kFeatureDim);
+        policy_ = infer::MlpPolicy();
+        return false;
+    }
+    return true;
+}
+
+double LyaSACScheduler::VirtualQueue() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return virtualQ_;
+}
+
+/*
+arrivals 由分片直接统计 (两轮之间进入等待队列的任务，回滚回来的也算：它们同样构成积压)
+    不能用 tasks.size() 反推 : 全量模式下 tasks 只是队首窗口，窗口大小随空闲车数变化，与真实积压无关
+carried 是上一轮派完还剩下的积压 : 只累加到达量时，Q 会随派单回落到 0，一个 logit 很低的远单
+    (V·logit + Q 始终 <= 0) 会被永远搁置; 每轮把还在等的任务再计一次，Q 随等待时间线性增长
+*/
+void LyaSACScheduler::UpdateVirtualQueue(const Backlog& backlog) {
+    size_t carried = lastPending_ > lastServed_ ? lastPending_ - lastServed_ : 0;
+    virtualQ_ = std::max(virtualQ_ - static_cast<double>(lastServed_), 0.0)
+              + static_cast<double>(backlog.arrivals) + static_cast<double>(carried);
+    lastPending_ = backlog.pending;
+}
+
+// 候选剪枝：每个任务只保留 topK 辆最近的车  O(T·A) 距离计算 + O(T·A) nth_element
+void LyaSACScheduler::BuildPairs(const std::vector<std::shared_ptr<manager::TaskContext>>& tasks,
+                                 const std::vector<model::AgvInfo>& candidates)
+{
+    pairs_.clear();
+    const int k = std::min<int>(topK_, static_cast<int>(candidates.size()));
+    distScratch_.resize(candidates.size());
+
+    for (int t = 0; t < static_cast<int>(tasks.size()); ++t) {
+        const model::Point& target = tasks[t]->req.targetPos;
+        for (int a = 0; a < static_cast<int>(candidates.size()); ++a) {
+            distScratch_[a] = {candidates[a].etaCells + CalMhtDis(candidates[a].currentPos, target), a};
+        }
+        if (k < static_cast<int>(distScratch_.size())) {
+            std::nth_element(distScratch_.begin(), distScratch_.begin() + k, distScratch_.end());
+        }
+        for (int j = 0; j < k; ++j) {
+            pairs_.push_back({t, distScratch_[j].second, distScratch_[j].first});
+        }
+    }
+}
+
+void LyaSACScheduler::BuildFeatures(const std::vector<std::shared_ptr<manager::TaskContext>>& tasks,
+                                    const std::vector<model::AgvInfo>& candidates,
+                                    const Backlog& backlog)
+{
+    const infer::FeatureScale& s = policy_.Scale();
+    const float invPos = 1.0f / s.pos;
+    const float invTime = 1.0f / s.time;
+    const float qFeat = static_cast<float>(virtualQ_) / s.queue;
+    const float ratio = static_cast<float>(std::max(backlog.pending, tasks.size())) / static_cast<float>(candidates.size());
+    const int64_t nowUs = myreactor::Timestamp::now().usSinceEpoch();
+
+    features_.resize(pairs_.size() * kFeatureDim);
+    float* row = features_.data();
+
+    for (const Pair& p : pairs_) {
+        const manager::TaskContext& task = *tasks[p.taskIdx];
+        const model::AgvInfo& agv = candidates[p.agvIdx];
+
+        float waitSec = static_cast<float>(nowUs - task.createTime.usSinceEpoch()) / 1e6f;
+
+        row[0] = static_cast<float>(task.req.targetPos.x - agv.currentPos.x) * invPos;
+        row[1] = static_cast<float>(task.req.targetPos.y - agv.currentPos.y) * invPos;
+        row[2] = static_cast<float>(p.dist) * invPos;
+        row[3] = static_cast<float>(agv.battery) / 100.0f;
+        row[4] = waitSec * invTime;
+        row[5] = static_cast<float>(task.req.priority);
+        row[6] = qFeat;
+        row[7] = ratio;
+        row += kFeatureDim;
+    }
+}
+
+std::vector<DispatchResult> LyaSACScheduler::Dispatch(
+        const std::vector<std::shared_ptr<manager::TaskContext>>& tasks,
+        const std::vector<model::AgvInfo>& candidates,
+        const Backlog& backlog)
+{
+    std::vector<DispatchResult> results;
+    if (tasks.empty() || candidates.empty()) return results;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 1. Lyapunov 状态推进
+    UpdateVirtualQueue(backlog);
+
+    // 2. 候选剪枝
+    BuildPairs(tasks, candidates);
+
+    // 3. 批量推理 (模型缺失时退化为 -距离，且不设 DPP 门槛 : 纯最近优先)
+    const bool gated = policy_.IsLoaded();
+    if (gated) {
+        BuildFeatures(tasks, candidates, backlog);
+        policy_.Forward(features_.data(), static_cast<int>(pairs_.size()), logits_);
+    } else {
+        logits_.resize(pairs_.size());
+        for (size_t i = 0; i < pairs_.size(); ++i)
+            logits_[i] = -static_cast<float>(pairs_[i].dist);
+    }
+
+    // 4. 漂移加惩罚 + 一对一贪心匹配: 按 logit 降序，满足 V·logit + Q > 0 才接受 (退化模式全部接受)
+    order_.resize(pairs_.size());
+    std::iota(order_.begin(), order_.end(), 0);
+    std::sort(order_.begin(), order_.end(), [this](int a, int b) {
+        return logits_[a] > logits_[b];
+    });
+
+    std::vector<char> taskUsed(tasks.size(), 0);
+    std::vector<char> agvUsed(candidates.size(), 0);
+    size_t maxAssign = std::min(tasks.size(), candidates.size());
+
+    for (int idx : order_) {
+        if (results.size() >= maxAssign) break;
+
+        if (gated && lyaV_ * static_cast<double>(logits_[idx]) + virtualQ_ <= 0.0) break; // 有序，后面的只会更差
+
+        const Pair& p = pairs_[idx];
+        if (taskUsed[p.taskIdx] || agvUsed[p.agvIdx]) continue;
+        taskUsed[p.taskIdx] = 1;
+        agvUsed[p.agvIdx] = 1;
+
+        results.push_back({tasks[p.taskIdx], candidates[p.agvIdx].uid, p.dist});
+    }
+
+    // 5. 本轮派出量，下一轮从 Q 中扣除
+    lastServed_ = results.size();
+
+    return results;
+}
+
+}
+}
+}
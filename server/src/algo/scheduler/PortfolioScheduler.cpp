@@ -0,0 +1,260 @@
+#include "algo/scheduler/PortfolioScheduler.h"
+#include "manager/TaskManager.h"
+#include "utils/MathUtils.h"
+#include "utils/Logger.h"
+#include "myreactor/ThreadPool.h"
+#include <condition_variable>
+#include <unordered_map>
+#include <unordered_set>
+#include <climits>
+
+namespace agv {
+namespace algo {
+namespace scheduler {
+
+using Clock = std::chrono::steady_clock;
+
+static int64_t ElapsedUs(Clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - since).count();
+}
+
+// 已注册的策略 + 统计 (统计字段受 statsMutex_ 保护)
+struct PortfolioScheduler::Strategy {
+    std::shared_ptr<ITScheduler> impl;
+    std::atomic<bool> busy{false};  // 正在某个 worker 上运行 (可能是上一轮超时遗留)
+
+    StrategyStats stats;
+    int64_t latencySumUs = 0;
+    uint64_t runs = 0;              // 完成次数 (含超时后迟到的)
+};
+
+/*
+一轮赛马的共享状态 : 由 shared_ptr 持有
+    实验策略拿到的是快照副本，超时后调用方直接返回，迟到的 worker 仍可安全写入，随最后一个引用一起释放
+*/
+struct PortfolioScheduler::Round {
+    std::vector<std::shared_ptr<manager::TaskContext>> tasks;
+    std::vector<model::AgvInfo> candidates;
+    Backlog backlog;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<std::vector<DispatchResult>> results;  // 按策略下标
+    std::vector<char> done;
+    std::vector<char> failed;                          // 策略抛异常
+    size_t outstanding = 0;
+};
+
+PortfolioScheduler::PortfolioScheduler(int budgetMs, int assignBonus, int statsEveryRounds)
+    : budget_(budgetMs > 0 ? budgetMs : 1),
+      assignBonus_(assignBonus > 0 ? assignBonus : 0),
+      statsEvery_(statsEveryRounds > 0 ? statsEveryRounds : 100)
+{}
+
+// 先停线程池 (会跑完队列里剩余的任务)，再析构统计与策略，保证 worker 不会访问已销毁的成员
+PortfolioScheduler::~PortfolioScheduler() {
+    if (pool_) pool_->stop();
+}
+
+void PortfolioScheduler::AddStrategy(std::shared_ptr<ITScheduler> strategy) {
+    if (!strategy) return;
+    auto s = std::make_shared<Strategy>();
+    s->stats.name = strategy->Name();
+    s->impl = std::move(strategy);
+    strategies_.push_back(std::move(s));
+}
+
+std::string PortfolioScheduler::Name() const {
+    std::string name = "Portfolio[";
+    for (size_t i = 0; i < strategies_.size(); ++i) {
+        if (i) name += " | ";
+        name += strategies_[i]->stats.name;
+    }
+    return name + "]";
+}
+
+bool PortfolioScheduler::Evaluate(const std::vector<DispatchResult>& results,
+                                  const std::vector<model::AgvInfo>& candidates,
+                                  int assignBonus, int64_t& cost)
+{
+    // uid -> 候选车 (预测候选的 etaCells 计入距离)
+    std::unordered_map<int, const model::AgvInfo*> agvs;
+    agvs.reserve(candidates.size());
+    for (const auto& agv : candidates) agvs.emplace(agv.uid, &agv);
+
+    std::unordered_set<int> usedAgvs;
+    std::unordered_set<model::TaskHandle> usedTasks;
+    cost = 0;
+
+    for (const auto& r : results) {
+        if (!r.task) return false;
+        auto it = agvs.find(r.agvId);
+        if (it == agvs.end()) return false;                         // 车不在候选集
+        if (!usedAgvs.insert(r.agvId).second) return false;         // 一车多单
+        if (!usedTasks.insert(r.task->req.taskId).second) return false; // 一单多车
+
+        cost += it->second->etaCells + CalMhtDis(it->second->currentPos, r.task->req.targetPos);
+    }
+    cost -= static_cast<int64_t>(assignBonus) * static_cast<int64_t>(results.size());
+    return true;
+}
+
+void PortfolioScheduler::Record(Strategy& s, int64_t latencyUs) {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    ++s.runs;
+    s.latencySumUs += latencyUs;
+    if (latencyUs > s.stats.maxLatencyUs) s.stats.maxLatencyUs = latencyUs;
+}
+
+std::vector<DispatchResult> PortfolioScheduler::Dispatch(
+        const std::vector<std::shared_ptr<manager::TaskContext>>& tasks,
+        const std::vector<model::AgvInfo>& candidates,
+        const Backlog& backlog)
+{
+    if (strategies_.empty() || tasks.empty() || candidates.empty()) return {};
+
+    const size_t n = strategies_.size();
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point deadline = start + budget_;
+
+    if (!pool_ && n > 1) {
+        pool_ = std::make_unique<myreactor::ThreadPool>(n - 1, "PORTFOLIO");
+        pool_->start();
+    }
+
+    // 1. 实验策略先投递 : 与基线并行
+    auto round = std::make_shared<Round>();
+    round->results.resize(n);
+    round->done.assign(n, 0);
+    round->failed.assign(n, 0);
+    std::vector<char> skipped(n, 0);
+
+    for (size_t i = 1; i < n; ++i) {
+        std::shared_ptr<Strategy> s = strategies_[i];
+        if (s->busy.exchange(true)) { // 上一轮还没跑完
+            skipped[i] = 1;
+            continue;
+        }
+        if (round->tasks.empty()) { // 按需拷贝快照
+            round->tasks = tasks;
+            round->candidates = candidates;
+            round->backlog = backlog;
+        }
+        ++round->outstanding;
+
+        pool_->addtask([this, round, s, i] {
+            Clock::time_point t0 = Clock::now();
+            std::vector<DispatchResult> res;
+            bool ok = true;
+            try {
+                res = s->impl->Dispatch(round->tasks, round->candidates, round->backlog);
+            } catch (...) {
+                ok = false;
+            }
+            Record(*s, ElapsedUs(t0));
+            s->busy.store(false);
+
+            {
+                std::lock_guard<std::mutex> lock(round->mtx);
+                round->results[i] = std::move(res);
+                round->failed[i] = ok ? 0 : 1;
+                round->done[i] = 1;
+                --round->outstanding;
+            }
+            round->cv.notify_one();
+        });
+    }
+
+    // 2. 基线在当前线程同步执行
+    {
+        Strategy& base = *strategies_[0];
+        Clock::time_point t0 = Clock::now();
+        bool ok = true;
+        std::vector<DispatchResult> res;
+        try {
+            res = base.impl->Dispatch(tasks, candidates, backlog);
+        } catch (...) {
+            ok = false;
+        }
+        Record(base, ElapsedUs(t0));
+
+        std::lock_guard<std::mutex> lock(round->mtx);
+        round->results[0] = std::move(res);
+        round->failed[0] = ok ? 0 : 1;
+        round->done[0] = 1;
+    }
+
+    // 3. 等实验策略，最多到预算截止
+    std::vector<std::vector<DispatchResult>> results(n);
+    std::vector<char> done, failed;
+    {
+        std::unique_lock<std::mutex> lock(round->mtx);
+        round->cv.wait_until(lock, deadline, [&round] { return round->outstanding == 0; });
+        for (size_t i = 0; i < n; ++i) {
+            if (round->done[i]) results[i] = std::move(round->results[i]);
+        }
+        done = round->done;
+        failed = round->failed;
+    }
+
+    // 4. 统一打分，择优 (平局时保留先注册的，基线优先)
+    int best = -1;
+    int64_t bestCost = LLONG_MAX;
+    std::vector<char> valid(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        if (!done[i] || failed[i]) continue;
+        int64_t cost = 0;
+        if (!Evaluate(results[i], candidates, assignBonus_, cost)) continue;
+        valid[i] = 1;
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = static_cast<int>(i);
+        }
+    }
+
+    // 5. 统计
+    bool logNow = false;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        for (size_t i = 0; i < n; ++i) {
+            StrategyStats& st = strategies_[i]->stats;
+            if (skipped[i]) ++st.skipped;
+            else if (!done[i]) ++st.timeouts;
+            else if (!valid[i]) ++st.invalid;
+            else ++st.rounds;
+        }
+        if (best >= 0) ++strategies_[best]->stats.wins;
+        logNow = (++totalRounds_ % statsEvery_ == 0);
+    }
+
+    if (logNow) LogStats();
+
+    if (best < 0) {
+        LOG_WARN("[Portfolio] No valid plan this round (%lu tasks, %lu agvs).", tasks.size(), candidates.size());
+        return {};
+    }
+    return std::move(results[best]);
+}
+
+std::vector<PortfolioScheduler::StrategyStats> PortfolioScheduler::GetStats() const {
+    std::vector<StrategyStats> out;
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    out.reserve(strategies_.size());
+    for (const auto& s : strategies_) {
+        StrategyStats st = s->stats;
+        st.avgLatencyUs = s->runs ? static_cast<double>(s->latencySumUs) / static_cast<double>(s->runs) : 0.0;
+        out.push_back(std::move(st));
+    }
+    return out;
+}
+
+void PortfolioScheduler::LogStats() const {
+    for (const auto& st : GetStats()) {
+        LOG_INFO("[Portfolio] %s: wins %lu / rounds %lu, timeouts %lu, skipped %lu, invalid %lu, latency avg %.1fus max %ldus",
+                 st.name.c_str(), st.wins, st.rounds, st.timeouts, st.skipped, st.invalid, st.avgLatencyUs, st.maxLatencyUs);
+    }
+}
+
+}
+}
+}
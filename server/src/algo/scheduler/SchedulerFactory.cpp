@@ -0,0 +1,51 @@
+#include "algo/scheduler/SchedulerFactory.h"
+#include "algo/scheduler/GreedyScheduler.h"
+#include "algo/scheduler/LyaSACScheduler.h"
+#include "algo/scheduler/PortfolioScheduler.h"
+#include "utils/Logger.h"
+
+namespace agv {
+namespace algo {
+namespace scheduler {
+
+std::shared_ptr<ITScheduler> CreateStrategy(const std::string& name, const config::SchedulerConfig& cfg) {
+    if (name == "GREEDY") {
+        return std::make_shared<GreedyScheduler>();
+    }
+    if (name == "LYA_SAC") {
+        auto sac = std::make_shared<LyaSACScheduler>(cfg.lyaV, cfg.topK);
+        // 模型加载失败不致命 : LyaSAC 内部会退化为距离启发式，保证服务可用
+        if (!sac->LoadModel(cfg.modelPath)) {
+            LOG_WARN("[Init] LyaSAC model unavailable (%s). Running in heuristic fallback mode.", cfg.modelPath.c_str());
+        }
+        return sac;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<ITScheduler> CreateScheduler(const config::SchedulerConfig& cfg) {
+    switch (cfg.type) {
+        case config::SchedulerType::LYA_SAC:
+            return CreateStrategy("LYA_SAC", cfg);
+
+        case config::SchedulerType::PORTFOLIO: {
+            auto portfolio = std::make_shared<PortfolioScheduler>(cfg.budgetMs, cfg.assignBonus, cfg.statsEveryRounds);
+            for (const auto& name : cfg.portfolio) {
+                auto strategy = CreateStrategy(name, cfg);
+                if (strategy) portfolio->AddStrategy(strategy);
+                else LOG_WARN("[Init] Unknown portfolio strategy: %s. Ignored.", name.c_str());
+            }
+            // 没有可用策略时保持默认 Greedy
+            if (!portfolio->GetStats().empty()) return portfolio;
+            break;
+        }
+
+        default:
+            break;
+    }
+    return std::make_shared<GreedyScheduler>();
+}
+
+}
+}
+}
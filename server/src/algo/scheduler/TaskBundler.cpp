@@ -0,0 +1,61 @@
+#include "algo/scheduler/TaskBundler.h"
+#include "manager/TaskManager.h"
+#include "utils/MathUtils.h"
+#include <climits>
+
+namespace agv {
+namespace algo {
+namespace scheduler {
+
+void TaskBundler::SetParams(int maxBundle, int maxDetour) {
+    maxBundle_ = maxBundle > 1 ? maxBundle : 1;
+    maxDetour_ = maxDetour > 0 ? maxDetour : 0;
+}
+
+std::vector<TaskBundler::spTask> TaskBundler::Build(const spTask& first, const std::vector<spTask>& pool, const Filter& usable) const {
+    std::vector<spTask> route;  // route[0] = first
+    if (!Enabled() || pool.empty()) return route;
+
+    route.reserve(maxBundle_);
+    route.push_back(first);
+    std::vector<char> taken(pool.size(), 0);
+
+    while (static_cast<int>(route.size()) < maxBundle_) {
+        int bestCand = -1;
+        size_t bestPos = 0;
+        int bestCost = INT_MAX;
+
+        for (size_t c = 0; c < pool.size(); ++c) {
+            if (taken[c] || pool[c] == first || !usable(pool[c])) continue;
+            const model::Point& p = pool[c]->req.targetPos;
+
+            // 插在 route[i] 与 route[i+1] 之间 (i >= 0，即 first 之后); i == size-1 表示追加到末尾
+            for (size_t i = 0; i < route.size(); ++i) {
+                const model::Point& a = route[i]->req.targetPos;
+                int cost = CalMhtDis(a, p);
+                if (i + 1 < route.size()) {
+                    const model::Point& b = route[i + 1]->req.targetPos;
+                    cost += CalMhtDis(p, b) - CalMhtDis(a, b);
+                }
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestCand = static_cast<int>(c);
+                    bestPos = i + 1;
+                }
+            }
+        }
+
+        if (bestCand < 0 || bestCost > maxDetour_) break;
+
+        taken[bestCand] = 1;
+        route.insert(route.begin() + bestPos, pool[bestCand]);
+    }
+
+    // 去掉首单，只返回后续
+    route.erase(route.begin());
+    return route;
+}
+
+}
+}
+}
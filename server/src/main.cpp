@@ -7,6 +7,7 @@
 #include <atomic>
 #include "manager/TaskManager.h"
 #include "manager/WorldManager.h"
+#include "session/AgvManager.h"
 #include "chrono"
 
 //  全局指针，用于在信号函数中访问 AgvServer实例
@@ -44,21 +45,25 @@ void WmsThreadFunc() {
     const auto& gridMap = agv::manager::WorldManager::Instance().GetGridMap();
 
     // 根据在线 AGV 数量生成任务（每辆车 2-3 个任务）
-    int onlineCount = agv::manager::WorldManager::Instance().GetAllAgvs().size();
+    int onlineCount = agv::manager::WorldManager::Instance().GetFleetSnapshot()->agvs.size();
     int taskCount = onlineCount * 2;  // 每辆车平均 2 个任务
 
     LOG_INFO("[WMS] Generating %d tasks for %d AGVs...", taskCount, onlineCount);
 
+    // 波次释放 : 整批一次提交 (一次取号、每个分片一个事件、一次调度通知)
+    std::vector<agv::manager::OrderSpec> wave;
+    wave.reserve(taskCount);
     for (int i = 0; i < taskCount; ++i) {
-        agv::model::Point target = gridMap.GetRandomWalkablePoint();
-        agv::model::ActionType action = static_cast<agv::model::ActionType>(i % 3);  // 循环使用不同动作
-
-        std::string taskId = TaskMgr.AddTask(target, action);
-        LOG_INFO("[WMS] >>> Order %d/%d Created: ID=%s, Target=(%d,%d)",
-                 i + 1, taskCount, taskId.c_str(), target.x, target.y);
+        agv::manager::OrderSpec order;
+        order.targetPos = gridMap.GetRandomWalkablePoint();
+        order.targetAct = static_cast<agv::model::ActionType>(i % 3);  // 循环使用不同动作
+        wave.push_back(order);
+    }
 
-        // 任务间隔 100ms
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::vector<agv::model::TaskHandle> ids = TaskMgr.AddTasks(wave);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        LOG_INFO("[WMS] >>> Order %lu/%d Created: ID=%s, Target=(%d,%d)",
+                 i + 1, taskCount, ids[i].ToText().c_str(), wave[i].targetPos.x, wave[i].targetPos.y);
     }
 
     LOG_INFO("[WMS] All test orders dispatched. Entering Monitor Mode...");
@@ -69,6 +74,13 @@ void WmsThreadFunc() {
         std::this_thread::sleep_for(std::chrono::seconds(5));
         // 可选：打印当前任务队列长度
         // LOG_DEBUG("[WMS] Monitor: System is running...");
+
+        // 各车 RPC 链路 : 平滑 RTT / 重传超时 / 重传与超时次数
+        for (const auto& [agvId, st] : AgvMgr.CollectRpcStats()) {
+            LOG_DEBUG("[WMS] Monitor: AGV %d RPC srtt=%.2fms rttvar=%.2fms rto=%lldms acked=%llu retx=%llu timeout=%llu inflight=%d",
+                      agvId, st.srttMs, st.rttvarMs, (long long)st.rtoMs, (unsigned long long)st.acked,
+                      (unsigned long long)st.retransmits, (unsigned long long)st.timeouts, st.inflight);
+        }
     }
     
     LOG_INFO("[WMS] Simulator Thread Exiting...");
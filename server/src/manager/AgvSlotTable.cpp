@@ -0,0 +1,122 @@
+#include "manager/AgvSlotTable.h"
+#include "utils/Logger.h"
+
+namespace agv{
+namespace manager{
+
+AgvSlotTable& AgvSlotTable::Instance() {
+    static AgvSlotTable instance;
+    return instance;
+}
+
+AgvSlotTable::AgvSlotTable()
+    : direct_(new std::atomic<uint32_t>[kDirectIds]),
+      meta_(new Meta[kMaxSlots])
+{
+    for (int i = 0; i < kDirectIds; ++i) direct_[i].store(0, std::memory_order_relaxed);
+}
+
+/*
+无锁读 (类似 seqlock) :
+    先读代数，奇数说明正被回收改写; 再核对槽位里登记的 AgvId; 最后确认代数没变
+    三步都过才返回 {下标, 代数}，否则当作没找到 (只在回收的一瞬间发生)
+*/
+AgvSlot AgvSlotTable::Find(int agvId) const {
+    uint32_t idxPlus1 = 0;
+    if (IsDirect(agvId)) {
+        idxPlus1 = direct_[agvId].load(std::memory_order_acquire);
+    } else {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = sparse_.find(agvId);
+        if (it != sparse_.end()) idxPlus1 = it->second;
+    }
+    if (idxPlus1 == 0) return {};
+
+    const Meta& m = meta_[idxPlus1 - 1];
+    uint32_t gen = m.gen.load();
+    if (gen & 1u) return {};
+    if (m.agvId.load() != agvId) return {};
+    if (m.gen.load() != gen) return {};
+    return AgvSlot{idxPlus1 - 1, gen};
+}
+
+bool AgvSlotTable::IsCurrent(AgvSlot slot) const {
+    return slot.Valid() && slot.index < Size() && meta_[slot.index].gen.load() == slot.gen;
+}
+
+AgvSlot AgvSlotTable::Acquire(int agvId) {
+    AgvSlot res;
+    int evicted = -1;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+
+        // 1. 重连 : 拿回原槽位
+        uint32_t idxPlus1 = LookupLocked(agvId);
+        if (idxPlus1 != 0) {
+            Meta& m = meta_[idxPlus1 - 1];
+            m.online.store(true);
+            return AgvSlot{idxPlus1 - 1, m.gen.load()};
+        }
+
+        // 2. 新车 : 追加
+        uint32_t used = used_.load(std::memory_order_relaxed);
+        if (used < kMaxSlots) {
+            Meta& m = meta_[used];
+            m.agvId.store(agvId);
+            m.online.store(true);
+            used_.store(used + 1, std::memory_order_release);
+            MapLocked(agvId, used + 1);
+            return AgvSlot{used, m.gen.load()};
+        }
+
+        // 3. 满了 : 回收一个离线槽位，代数 +2 让旧句柄失效
+        for (uint32_t i = 0; i < used; ++i) {
+            Meta& m = meta_[i];
+            if (m.online.load()) continue;
+
+            evicted = m.agvId.load();
+            UnmapLocked(evicted);
+
+            uint32_t gen = m.gen.load();
+            m.gen.store(gen + 1);      // 改写中
+            m.agvId.store(agvId);
+            m.gen.store(gen + 2);      // 改写完成
+            m.online.store(true);
+            MapLocked(agvId, i + 1);
+            res = AgvSlot{i, gen + 2};
+            break;
+        }
+    }
+
+    if (!res.Valid()) {
+        LOG_ERROR("[AgvSlotTable] No free slot for AGV %d (%u AGVs online).", agvId, kMaxSlots);
+    } else {
+        LOG_WARN("[AgvSlotTable] Slot %u recycled: AGV %d -> AGV %d.", res.index, evicted, agvId);
+    }
+    return res;
+}
+
+void AgvSlotTable::Release(int agvId) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    uint32_t idxPlus1 = LookupLocked(agvId);
+    if (idxPlus1 != 0) meta_[idxPlus1 - 1].online.store(false);
+}
+
+uint32_t AgvSlotTable::LookupLocked(int agvId) const {
+    if (IsDirect(agvId)) return direct_[agvId].load(std::memory_order_relaxed);
+    auto it = sparse_.find(agvId);
+    return it == sparse_.end() ? 0 : it->second;
+}
+
+void AgvSlotTable::MapLocked(int agvId, uint32_t idxPlus1) {
+    if (IsDirect(agvId)) direct_[agvId].store(idxPlus1, std::memory_order_release);
+    else sparse_[agvId] = idxPlus1;
+}
+
+void AgvSlotTable::UnmapLocked(int agvId) {
+    if (IsDirect(agvId)) direct_[agvId].store(0, std::memory_order_release);
+    else sparse_.erase(agvId);
+}
+
+}
+}
@@ -0,0 +1,299 @@
+#include "manager/DeadlockDetector.h"
+#include <algorithm>
+
+namespace agv{
+namespace manager{
+
+using namespace model;
+
+namespace {
+constexpr int kMaxChain = 64;  // 沿边最多走多少步 (环 / 链再长就不管了)
+}
+
+void DeadlockDetector::Configure(const GridMap* map, bool enable, int gridlockMs, int replanHoldMs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    map_ = map;
+    enable_ = enable && map != nullptr;
+    gridlockMs_ = std::max(0, gridlockMs);
+    replanHoldMs_ = std::max(0, replanHoldMs);
+}
+
+int DeadlockDetector::OwnerLocked(const Point& cell) const {
+    auto it = owner_.find(Key(cell));
+    return it == owner_.end() ? -1 : it->second;
+}
+
+void DeadlockDetector::SetWaitLocked(int agvId, Node& n, const Point& cell, int64_t nowMs) {
+    if (n.waiting && n.waitCell == cell) return;
+    ClearWaitLocked(agvId, n);
+    n.waiting = true;
+    n.waitCell = cell;
+    n.waitSinceMs = nowMs;
+    n.gridlockReported = false;
+    waiters_[Key(cell)].push_back(agvId);
+    waiting_.insert(agvId);
+}
+
+void DeadlockDetector::ClearWaitLocked(int agvId, Node& n) {
+    if (!n.waiting) return;
+    n.waiting = false;
+    waiting_.erase(agvId);
+
+    auto it = waiters_.find(Key(n.waitCell));
+    if (it == waiters_.end()) return;
+    auto& v = it->second;
+    v.erase(std::remove(v.begin(), v.end(), agvId), v.end());
+    if (v.empty()) waiters_.erase(it);
+}
+
+void DeadlockDetector::DissolveLocked(uint64_t cycleId) {
+    auto it = cycles_.find(cycleId);
+    if (it == cycles_.end()) return;
+    for (int id : it->second.members) {
+        auto nit = nodes_.find(id);
+        if (nit != nodes_.end() && nit->second.cycle == cycleId) nit->second.cycle = 0;
+    }
+    cycles_.erase(it);
+}
+
+// ---------- 位置 ----------
+void DeadlockDetector::OnMove(int agvId, const Point& pos, int64_t nowMs, std::vector<CycleEvent>& events) {
+    if (!enable_) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    MoveLocked(agvId, pos, nowMs, events);
+}
+
+void DeadlockDetector::OnMoves(const std::vector<Move>& moves, int64_t nowMs, std::vector<CycleEvent>& events) {
+    if (!enable_ || moves.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& m : moves) MoveLocked(m.agvId, m.pos, nowMs, events);
+}
+
+void DeadlockDetector::MoveLocked(int agvId, const Point& pos, int64_t nowMs, std::vector<CycleEvent>& events) {
+    Node& n = nodes_[agvId];
+    if (n.placed && n.pos == pos) return;
+
+    // 1. 占用表
+    if (n.placed) {
+        auto it = owner_.find(Key(n.pos));
+        if (it != owner_.end() && it->second == agvId) owner_.erase(it);
+    }
+    owner_[Key(pos)] = agvId;
+    n.pos = pos;
+    n.placed = true;
+    n.lastMoveMs = nowMs;
+    n.gridlockHead = false;
+
+    // 2. 沿路径推进 (上报可能跳过一两格); 偏离路径则作废
+    if (!n.plan.empty()) {
+        size_t end = std::min(n.plan.size(), n.planIdx + 4);
+        size_t k = n.planIdx;
+        while (k < end && !(n.plan[k] == pos)) ++k;
+        if (k < end) n.planIdx = k;
+        else n.plan.clear();
+    }
+
+    // 3. 车动了 : 自己的出边、所在的环都作废
+    ClearWaitLocked(agvId, n);
+    if (n.cycle) DissolveLocked(n.cycle);
+
+    // 4. 开进了别人正在等的格子 : 这些等待边现在指向自己，从边的起点判环
+    auto wit = waiters_.find(Key(pos));
+    if (wit == waiters_.end()) return;
+    std::vector<int> waiters = wit->second;  // 判环过程中不改 waiters_，拷一份防万一
+    for (int w : waiters) {
+        auto nit = nodes_.find(w);
+        if (nit != nodes_.end() && nit->second.cycle == 0) DetectFromLocked(w, nowMs, events);
+    }
+}
+
+void DeadlockDetector::Remove(int agvId) {
+    if (!enable_) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = nodes_.find(agvId);
+    if (it == nodes_.end()) return;
+    Node& n = it->second;
+
+    ClearWaitLocked(agvId, n);
+    if (n.cycle) DissolveLocked(n.cycle);
+    if (n.placed) {
+        auto oit = owner_.find(Key(n.pos));
+        if (oit != owner_.end() && oit->second == agvId) owner_.erase(oit);
+    }
+    nodes_.erase(it);
+}
+
+// ---------- 路径 ----------
+void DeadlockDetector::OnPathPlanned(int agvId, const std::vector<Point>& path) {
+    if (!enable_) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = nodes_.find(agvId);
+    if (it == nodes_.end()) return;
+    Node& n = it->second;
+
+    n.plan = path;
+    n.planIdx = 0;
+    for (size_t k = 0; k < n.plan.size() && k < 4; ++k) {
+        if (n.plan[k] == n.pos) { n.planIdx = k; break; }
+    }
+    // 新路径的下一格不一定还是原来等的那格，等下一次 PATH_REQ 再建边
+    ClearWaitLocked(agvId, n);
+}
+
+/*
+PATH_REQ 判定 :
+    没有路径 / 已到终点 / 下一格没人 : 不是被堵，正常寻路
+    被堵 : 建等待边 (已有则保留原来的起始时间)，然后
+        已在环里 : 环没过期就按环的决定 (让路车 BACKOFF，其他 HOLD); 过期说明让路车没动，作废重判
+        不在环里 : 从自己判环，成环同上
+        都不是 : 同一堵车者、同一格在 replanHoldMs 内再次请求 -> HOLD，否则放行寻路并记下这一次
+*/
+DeadlockDetector::Verdict DeadlockDetector::OnPathRequest(int agvId, int64_t nowMs, std::vector<CycleEvent>& events) {
+    Verdict v;
+    if (!enable_) return v;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = nodes_.find(agvId);
+    if (it == nodes_.end()) return v;
+    Node& n = it->second;
+
+    if (n.plan.empty() || n.planIdx + 1 >= n.plan.size()) return v;
+    const Point next = n.plan[n.planIdx + 1];
+    int blocker = OwnerLocked(next);
+    if (blocker < 0 || blocker == agvId) {
+        ClearWaitLocked(agvId, n);
+        return v;
+    }
+
+    SetWaitLocked(agvId, n, next, nowMs);
+
+    if (n.cycle) {
+        auto cit = cycles_.find(n.cycle);
+        if (cit != cycles_.end() && nowMs - cit->second.detectedMs < gridlockMs_) return VerdictLocked(agvId, cit->second);
+        DissolveLocked(n.cycle);
+    }
+    if (uint64_t id = DetectFromLocked(agvId, nowMs, events)) return VerdictLocked(agvId, cycles_[id]);
+
+    if (n.lastBlocker == blocker && n.lastBlockedCell == next && nowMs - n.lastReplanMs < replanHoldMs_) {
+        v.kind = Verdict::HOLD;
+        v.blocker = blocker;
+        return v;
+    }
+    n.lastBlocker = blocker;
+    n.lastBlockedCell = next;
+    n.lastReplanMs = nowMs;
+    return v;
+}
+
+DeadlockDetector::Verdict DeadlockDetector::VerdictLocked(int agvId, const Cycle& c) const {
+    Verdict v;
+    if (c.victim == agvId) {
+        v.kind = Verdict::BACKOFF;
+        v.side = c.side;
+        return v;
+    }
+    // 等让路车让开; 没有车能让路时也只能原地等 (环过期后重判)
+    v.kind = Verdict::HOLD;
+    v.blocker = c.victim;
+    return v;
+}
+
+// ---------- 判环 ----------
+uint64_t DeadlockDetector::DetectFromLocked(int agvId, int64_t nowMs, std::vector<CycleEvent>& events) {
+    std::vector<int> members{agvId};
+    int cur = agvId;
+    for (int step = 0; step < kMaxChain; ++step) {
+        auto it = nodes_.find(cur);
+        if (it == nodes_.end() || !it->second.waiting) return 0;  // 链头不在等 : 不成环
+
+        int next = OwnerLocked(it->second.waitCell);
+        if (next < 0) return 0;                                   // 等的格子已经空了
+        if (next == agvId) break;                                 // 回到起点 : 成环
+        if (std::find(members.begin(), members.end(), next) != members.end()) return 0;  // 等的是另一个环 (那个环由它自己的成员判出)
+        members.push_back(next);
+        cur = next;
+        if (step + 1 == kMaxChain) return 0;
+    }
+
+    // 选让路车 : 被选中次数少的优先，其次 ID 小的; 必须有空闲侧格
+    std::vector<int> order = members;
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        int ca = nodes_[a].victimCount, cb = nodes_[b].victimCount;
+        return ca != cb ? ca < cb : a < b;
+    });
+
+    Cycle c;
+    c.members = members;
+    c.detectedMs = nowMs;
+    for (int id : order) {
+        Point side;
+        if (FreeSideLocked(nodes_[id], side)) {
+            c.victim = id;
+            c.side = side;
+            ++nodes_[id].victimCount;
+            break;
+        }
+    }
+
+    uint64_t cycleId = nextCycle_++;
+    for (int id : members) nodes_[id].cycle = cycleId;
+    events.push_back(CycleEvent{c.members, c.victim, c.side});
+    cycles_.emplace(cycleId, std::move(c));
+    return cycleId;
+}
+
+// 四邻域里找一格 : 可通行、没车、没人在等
+bool DeadlockDetector::FreeSideLocked(const Node& n, Point& side) const {
+    static const int dx[4] = {1, -1, 0, 0};
+    static const int dy[4] = {0, 0, 1, -1};
+    for (int d = 0; d < 4; ++d) {
+        Point p{n.pos.x + dx[d], n.pos.y + dy[d]};
+        if (map_->IsObstacle(p)) continue;
+        if (owner_.count(Key(p)) || waiters_.count(Key(p))) continue;
+        side = p;
+        return true;
+    }
+    return false;
+}
+
+// ---------- 僵局 ----------
+void DeadlockDetector::CheckGridlock(int64_t nowMs, std::vector<GridlockEvent>& events) {
+    if (!enable_ || gridlockMs_ <= 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::unordered_map<int, GridlockEvent> byHead;  // 同一链头只报最长的那条链
+    for (int w : waiting_) {
+        Node& n = nodes_[w];
+        if (n.cycle || n.gridlockReported || nowMs - n.waitSinceMs < gridlockMs_) continue;
+
+        // 沿边走到链头 (不在等、或者等的格子空了的那辆)
+        int head = w, len = 0;
+        for (; len < kMaxChain; ++len) {
+            const Node& h = nodes_[head];
+            if (!h.waiting) break;
+            int next = OwnerLocked(h.waitCell);
+            if (next < 0 || next == w) break;
+            head = next;
+        }
+        if (head == w) continue;  // 等的格子已经空了，车自己会走
+
+        const Node& h = nodes_[head];
+        int64_t still = nowMs - h.lastMoveMs;
+        if (still < gridlockMs_) continue;
+
+        n.gridlockReported = true;
+        if (h.gridlockHead) continue;
+        auto bit = byHead.find(head);
+        if (bit == byHead.end()) byHead.emplace(head, GridlockEvent{w, head, h.pos, len, still});
+        else if (len > bit->second.chainLen) bit->second = GridlockEvent{w, head, h.pos, len, still};
+    }
+    for (const auto& kv : byHead) {
+        nodes_[kv.first].gridlockHead = true;
+        events.push_back(kv.second);
+    }
+}
+
+}
+}
@@ -0,0 +1,164 @@
+#include "manager/FleetStateStore.h"
+#include <cstring>
+
+namespace agv{
+namespace manager{
+
+using namespace model;
+
+FleetStateStore::FleetStateStore()
+    : hot_(new HotLine[kCapacity]),
+      cold_(new ColdLine[kCapacity])
+{
+    for (uint32_t i = 0; i < kCapacity; ++i) {
+        for (auto& w : cold_[i].version) w.store(0, std::memory_order_relaxed);
+    }
+}
+
+// 写者之间 : seq 偶数 -> 奇数 的 CAS 即互斥; 抢不到说明同一辆车的另一条消息正在写，临界区极短，原地重试
+uint32_t FleetStateStore::BeginWrite(HotLine& h) {
+    uint32_t s = h.seq.load(std::memory_order_relaxed);
+    while ((s & 1u) || !h.seq.compare_exchange_weak(s, s + 1, std::memory_order_relaxed)) {
+        s = h.seq.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);  // 奇数 seq 先于字段可见
+    return s;
+}
+
+void FleetStateStore::EndWrite(HotLine& h, uint32_t s) {
+    h.seq.store(s + 2, std::memory_order_release);  // 字段先于偶数 seq 可见
+}
+
+void FleetStateStore::LoadFields(const HotLine& h, const ColdLine& c, AgvState& st) {
+    st.uid = h.uid.load(std::memory_order_relaxed);
+    st.pos.x = h.x.load(std::memory_order_relaxed);
+    st.pos.y = h.y.load(std::memory_order_relaxed);
+    st.status = static_cast<AgvStatus>(h.status.load(std::memory_order_relaxed));
+    st.battery = h.battery.load(std::memory_order_relaxed);
+    st.heartbeatMs = h.heartbeatMs.load(std::memory_order_relaxed);
+    st.taskId.value = h.taskId.load(std::memory_order_relaxed);
+    st.progress = h.progress.load(std::memory_order_relaxed);
+
+    st.speed = c.speed.load(std::memory_order_relaxed);
+    st.lastMoveMs = c.lastMoveMs.load(std::memory_order_relaxed);
+    st.pathLen = c.pathLen.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < AgvState::kVersionLen / sizeof(uint64_t); ++i) {
+        uint64_t w = c.version[i].load(std::memory_order_relaxed);
+        std::memcpy(st.version + i * sizeof(uint64_t), &w, sizeof(uint64_t));
+    }
+}
+
+void FleetStateStore::StoreFields(const AgvState& st, HotLine& h, ColdLine& c) {
+    h.uid.store(st.uid, std::memory_order_relaxed);
+    h.x.store(st.pos.x, std::memory_order_relaxed);
+    h.y.store(st.pos.y, std::memory_order_relaxed);
+    h.status.store(static_cast<int8_t>(st.status), std::memory_order_relaxed);
+    h.battery.store(st.battery, std::memory_order_relaxed);
+    h.heartbeatMs.store(st.heartbeatMs, std::memory_order_relaxed);
+    h.taskId.store(st.taskId.value, std::memory_order_relaxed);
+    h.progress.store(st.progress, std::memory_order_relaxed);
+
+    c.speed.store(st.speed, std::memory_order_relaxed);
+    c.lastMoveMs.store(st.lastMoveMs, std::memory_order_relaxed);
+    c.pathLen.store(st.pathLen, std::memory_order_relaxed);
+    for (size_t i = 0; i < AgvState::kVersionLen / sizeof(uint64_t); ++i) {
+        uint64_t w = 0;
+        std::memcpy(&w, st.version + i * sizeof(uint64_t), sizeof(uint64_t));
+        c.version[i].store(w, std::memory_order_relaxed);
+    }
+}
+
+void FleetStateStore::Reset(AgvSlot slot, const AgvState& st) {
+    if (!InRange(slot)) return;
+    HotLine& h = hot_[slot.index];
+
+    uint32_t s = BeginWrite(h);
+    StoreFields(st, h, cold_[slot.index]);
+    h.gen.store(slot.gen, std::memory_order_relaxed);
+    h.online.store(true, std::memory_order_relaxed);
+    EndWrite(h, s);
+}
+
+void FleetStateStore::Remove(AgvSlot slot) {
+    if (!InRange(slot)) return;
+    HotLine& h = hot_[slot.index];
+
+    uint32_t s = BeginWrite(h);
+    if (h.gen.load(std::memory_order_relaxed) == slot.gen) h.online.store(false, std::memory_order_relaxed);
+    EndWrite(h, s);
+}
+
+/*
+seqlock 读 :
+    s1 = seq (acquire)，奇数说明写者在临界区，重读
+    relaxed 读字段
+    acquire 栅栏后再读 seq，与 s1 相同说明这期间没有写者进来过，读到的是某一次写完之后的完整状态
+*/
+bool FleetStateStore::ReadSlot(uint32_t index, const AgvSlot* expect, AgvState& out) const {
+    const HotLine& h = hot_[index];
+    const ColdLine& c = cold_[index];
+    for (;;) {
+        uint32_t s1 = h.seq.load(std::memory_order_acquire);
+        if (s1 & 1u) continue;
+
+        bool online = h.online.load(std::memory_order_relaxed);
+        uint32_t gen = h.gen.load(std::memory_order_relaxed);
+        if (online && (expect == nullptr || gen == expect->gen)) LoadFields(h, c, out);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (h.seq.load(std::memory_order_relaxed) != s1) continue;
+        return online && (expect == nullptr || gen == expect->gen);
+    }
+}
+
+bool FleetStateStore::Read(AgvSlot slot, AgvState& out) const {
+    return InRange(slot) && ReadSlot(slot.index, &slot, out);
+}
+
+AgvStatus FleetStateStore::Status(AgvSlot slot) const {
+    if (!InRange(slot)) return AgvStatus::UNKNOWN;
+    const HotLine& h = hot_[slot.index];
+    for (;;) {
+        uint32_t s1 = h.seq.load(std::memory_order_acquire);
+        if (s1 & 1u) continue;
+
+        bool valid = h.online.load(std::memory_order_relaxed) && h.gen.load(std::memory_order_relaxed) == slot.gen;
+        int8_t status = h.status.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (h.seq.load(std::memory_order_relaxed) != s1) continue;
+        return valid ? static_cast<AgvStatus>(status) : AgvStatus::UNKNOWN;
+    }
+}
+
+uint64_t FleetStateStore::WriteStamp() const {
+    uint32_t n = std::min(SlotTbl.Size(), kCapacity);
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < n; ++i) sum += hot_[i].seq.load(std::memory_order_acquire);
+    return sum;
+}
+
+bool FleetStateStore::AnyAt(const Point& pos, int selfId) const {
+    uint32_t n = std::min(SlotTbl.Size(), kCapacity);
+    for (uint32_t i = 0; i < n; ++i) {
+        const HotLine& h = hot_[i];
+        for (;;) {
+            uint32_t s1 = h.seq.load(std::memory_order_acquire);
+            if (s1 & 1u) continue;
+
+            bool hit = h.online.load(std::memory_order_relaxed)
+                    && h.uid.load(std::memory_order_relaxed) != selfId
+                    && h.x.load(std::memory_order_relaxed) == pos.x
+                    && h.y.load(std::memory_order_relaxed) == pos.y;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (h.seq.load(std::memory_order_relaxed) != s1) continue;
+            if (hit) return true;
+            break;
+        }
+    }
+    return false;
+}
+
+}
+}
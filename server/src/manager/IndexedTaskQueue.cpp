@@ -0,0 +1,125 @@
+#include "manager/IndexedTaskQueue.h"
+#include "manager/TaskManager.h"
+#include <queue>
+#include <algorithm>
+
+namespace agv{
+namespace manager{
+
+bool IndexedTaskQueue::Push(const spTaskContext& task, int64_t rank) {
+    model::TaskHandle id = task->req.taskId;
+    if (pos_.count(id)) return false;
+
+    heap_.push_back({rank, seq_++, task});
+    pos_[id] = heap_.size() - 1;
+    SiftUp(heap_.size() - 1);
+    return true;
+}
+
+bool IndexedTaskQueue::Remove(model::TaskHandle taskId) {
+    auto it = pos_.find(taskId);
+    if (it == pos_.end()) return false;
+
+    RemoveAt(it->second);
+    return true;
+}
+
+bool IndexedTaskQueue::Update(model::TaskHandle taskId, int64_t rank) {
+    auto it = pos_.find(taskId);
+    if (it == pos_.end()) return false;
+
+    size_t i = it->second;
+    int64_t old = heap_[i].rank;
+    heap_[i].rank = rank;
+    if (rank < old) SiftUp(i);
+    else SiftDown(i);
+    return true;
+}
+
+IndexedTaskQueue::spTaskContext IndexedTaskQueue::Find(model::TaskHandle taskId) const {
+    auto it = pos_.find(taskId);
+    return it == pos_.end() ? nullptr : heap_[it->second].task;
+}
+
+IndexedTaskQueue::spTaskContext IndexedTaskQueue::Top() const {
+    return heap_.empty() ? nullptr : heap_.front().task;
+}
+
+/*
+TopN : 在原堆上做一次 “有界的 best-first 展开”
+    辅助堆里放的是原堆下标，初始只有根;每弹出一个，把它的两个孩子压进来
+    堆序保证：孩子一定排在父亲之后，因此弹出顺序就是全局派单顺序
+    只访问 k 个结点及其孩子 (<= 2k+1)，与积压总量 n 无关
+*/
+void IndexedTaskQueue::TopN(size_t n, std::vector<spTaskContext>& out) const {
+    if (n == 0 || heap_.empty()) return;
+    n = std::min(n, heap_.size());
+    out.reserve(out.size() + n);
+
+    auto later = [this](size_t a, size_t b) { return Before(heap_[b], heap_[a]); };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> frontier(later);
+    frontier.push(0);
+
+    while (n-- > 0 && !frontier.empty()) {
+        size_t i = frontier.top();
+        frontier.pop();
+        out.push_back(heap_[i].task);
+
+        size_t l = 2 * i + 1, r = 2 * i + 2;
+        if (l < heap_.size()) frontier.push(l);
+        if (r < heap_.size()) frontier.push(r);
+    }
+}
+
+void IndexedTaskQueue::Clear() {
+    heap_.clear();
+    pos_.clear();
+}
+
+void IndexedTaskQueue::SiftUp(size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!Before(heap_[i], heap_[parent])) break;
+        SwapNode(i, parent);
+        i = parent;
+    }
+}
+
+void IndexedTaskQueue::SiftDown(size_t i) {
+    const size_t n = heap_.size();
+    while (true) {
+        size_t l = 2 * i + 1, r = l + 1, best = i;
+        if (l < n && Before(heap_[l], heap_[best])) best = l;
+        if (r < n && Before(heap_[r], heap_[best])) best = r;
+        if (best == i) break;
+        SwapNode(i, best);
+        i = best;
+    }
+}
+
+void IndexedTaskQueue::SwapNode(size_t i, size_t j) {
+    std::swap(heap_[i], heap_[j]);
+    pos_[heap_[i].task->req.taskId] = i;
+    pos_[heap_[j].task->req.taskId] = j;
+}
+
+// 与末尾交换后弹出，再对换上来的结点做一次上浮或下沉
+void IndexedTaskQueue::RemoveAt(size_t i) {
+    pos_.erase(heap_[i].task->req.taskId);
+
+    size_t last = heap_.size() - 1;
+    if (i != last) {
+        heap_[i] = std::move(heap_[last]);
+        pos_[heap_[i].task->req.taskId] = i;
+        heap_.pop_back();
+
+        if (i > 0 && Before(heap_[i], heap_[(i - 1) / 2])) SiftUp(i);
+        else SiftDown(i);
+    }
+    else {
+        heap_.pop_back();
+    }
+}
+
+}
+}
@@ -0,0 +1,58 @@
+#include "manager/LivenessTracker.h"
+
+namespace agv{
+namespace manager{
+
+void LivenessTracker::Configure(int intervalMs, int missedBeats, int offlineBeats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    intervalMs_ = intervalMs > 0 ? intervalMs : 1000;
+    missedBeats_ = missedBeats > 0 ? missedBeats : 0;
+    // 下线门限必须在失联门限之后
+    offlineBeats_ = (offlineBeats > missedBeats_) ? offlineBeats : 0;
+}
+
+void LivenessTracker::ArmLocked(int agvId, AgvSlot slot, int64_t nowMs) {
+    if (wheel_.Empty()) {  // 轮子空 : 先对齐时间起点
+        std::vector<Wheel::Expired> none;
+        wheel_.Advance(nowMs, none);
+    }
+    wheel_.Arm(agvId, Entry{slot, Stage::SUSPECT}, nowMs + SuspectAfterMs());
+}
+
+void LivenessTracker::Beat(int agvId, AgvSlot slot, int64_t nowMs) {
+    if (!Enabled()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    ArmLocked(agvId, slot, nowMs);
+}
+
+void LivenessTracker::Beat(const std::vector<std::pair<int, AgvSlot>>& agvs, int64_t nowMs) {
+    if (!Enabled() || agvs.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [agvId, slot] : agvs) ArmLocked(agvId, slot, nowMs);
+}
+
+void LivenessTracker::Remove(int agvId) {
+    if (!Enabled()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    wheel_.Cancel(agvId);
+}
+
+void LivenessTracker::Advance(int64_t nowMs, std::vector<Expired>& out) {
+    if (!Enabled()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    expired_.clear();
+    wheel_.Advance(nowMs, expired_);
+    for (const auto& e : expired_) {
+        out.push_back(Expired{e.key, e.value.slot, e.value.stage});
+
+        // 失联 -> 挂下线期限 (期限从失联时刻起算剩下的心跳数)
+        if (e.value.stage == Stage::SUSPECT && offlineBeats_ > 0) {
+            int64_t rest = static_cast<int64_t>(intervalMs_) * (offlineBeats_ - missedBeats_);
+            wheel_.Arm(e.key, Entry{e.value.slot, Stage::OFFLINE}, nowMs + rest);
+        }
+    }
+}
+
+}
+}
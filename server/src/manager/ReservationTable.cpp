@@ -0,0 +1,157 @@
+#include "manager/ReservationTable.h"
+#include <algorithm>
+
+namespace agv{
+namespace manager{
+
+using namespace model;
+
+void ReservationTable::Reset(const GridMap* map) {
+    map_ = map;
+    width_ = map ? map->GetWidth() : 0;
+    height_ = map ? map->GetHeight() : 0;
+    if (width_ <= 0 || height_ <= 0) {
+        cells_.reset();
+        return;
+    }
+
+    size_t n = static_cast<size_t>(width_) * height_;
+    cells_.reset(new std::atomic<uint32_t>[n]);
+    for (size_t i = 0; i < n; ++i) cells_[i].store(0, std::memory_order_relaxed);
+    lanes_.reset(new Lane[AgvSlotTable::kMaxSlots]);
+}
+
+ReservationTable::Lane* ReservationTable::LaneOf(AgvSlot slot) {
+    if (!slot.Valid() || slot.index >= AgvSlotTable::kMaxSlots) return nullptr;
+    return &lanes_[slot.index];
+}
+
+void ReservationTable::ResetLaneLocked(Lane& lane, int agvId) {
+    if (lane.agvId == agvId) return;
+    lane.agvId = agvId;  // 上一任车主的格子已在它下线时放掉
+    lane.cells.clear();
+}
+
+bool ReservationTable::ReleaseCell(long idx, uint32_t me) {
+    uint32_t expected = me;
+    return cells_[idx].compare_exchange_strong(expected, 0, std::memory_order_release, std::memory_order_relaxed);
+}
+
+/*
+逐格 CAS :
+    acq_rel : 拿到格子 (成功) 与上一任车主放格子 (release) 配对; 失败时 acquire 读到当前车主
+    allOrNothing 回滚只放 “这一批新拿到的” 格子，之前就是自己的保持不动
+*/
+ReservationTable::ClaimResult ReservationTable::Claim(int agvId, AgvSlot slot, const Point& from,
+                                                     const std::vector<Point>& path, bool allOrNothing) {
+    ClaimResult res;
+    Lane* lane = Enabled() && agvId >= 0 ? LaneOf(slot) : nullptr;
+    if (!lane) return res;
+    const uint32_t me = Word(agvId);
+
+    std::lock_guard<std::mutex> lock(lane->mutex);
+    ResetLaneLocked(*lane, agvId);
+
+    std::vector<long> fresh;  // 这一批新拿到的格子 (回滚用)
+    if (allOrNothing) fresh.reserve(path.size());
+
+    Point prev = from;
+    for (const auto& p : path) {
+        long idx = IndexOf(p);
+        bool linked = Adjacent(prev, p) || (res.granted == 0 && p == from);  // 首格可以是脚下这格
+        if (idx < 0 || !linked || map_->IsObstacle(p)) {
+            res.conflictCell = p;
+            res.conflictAgv = -1;
+            break;
+        }
+        prev = p;
+
+        uint32_t expected = 0;
+        if (cells_[idx].compare_exchange_strong(expected, me, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            if (allOrNothing) fresh.push_back(idx);
+        } else if (expected != me) {
+            res.conflictCell = p;
+            res.conflictAgv = static_cast<int>(expected) - 1;
+            break;
+        }
+        ++res.granted;
+    }
+
+    res.all = (res.granted == static_cast<int>(path.size()));
+    if (!res.all && allOrNothing) {
+        for (long idx : fresh) ReleaseCell(idx, me);
+        res.granted = 0;
+    }
+
+    // 记入车道 (按行驶顺序接在后面; 已在车道里的是重试)
+    for (int i = 0; i < res.granted; ++i) {
+        if (std::find(lane->cells.begin(), lane->cells.end(), path[i]) == lane->cells.end())
+            lane->cells.push_back(path[i]);
+    }
+    return res;
+}
+
+int ReservationTable::Release(int agvId, AgvSlot slot, const std::vector<Point>& path) {
+    Lane* lane = Enabled() && agvId >= 0 ? LaneOf(slot) : nullptr;
+    if (!lane) return 0;
+    const uint32_t me = Word(agvId);
+
+    std::lock_guard<std::mutex> lock(lane->mutex);
+    ResetLaneLocked(*lane, agvId);
+
+    int released = 0;
+    for (const auto& p : path) {
+        long idx = IndexOf(p);
+        if (idx < 0) continue;
+        if (ReleaseCell(idx, me)) ++released;
+        lane->cells.erase(std::remove(lane->cells.begin(), lane->cells.end(), p), lane->cells.end());
+    }
+    return released;
+}
+
+int ReservationTable::ReleaseBehind(int agvId, AgvSlot slot, const Point& pos) {
+    Lane* lane = Enabled() && agvId >= 0 ? LaneOf(slot) : nullptr;
+    if (!lane) return 0;
+    const uint32_t me = Word(agvId);
+
+    std::lock_guard<std::mutex> lock(lane->mutex);
+    if (lane->agvId != agvId) return 0;
+
+    auto at = std::find(lane->cells.begin(), lane->cells.end(), pos);
+    if (at == lane->cells.end() || at == lane->cells.begin()) return 0;
+
+    int released = 0;
+    for (auto it = lane->cells.begin(); it != at; ++it) {
+        long idx = IndexOf(*it);
+        if (idx >= 0 && ReleaseCell(idx, me)) ++released;
+    }
+    lane->cells.erase(lane->cells.begin(), at);
+    return released;
+}
+
+int ReservationTable::ReleaseAll(int agvId, AgvSlot slot) {
+    if (!Enabled() || agvId < 0) return 0;
+    const uint32_t me = Word(agvId);
+
+    if (Lane* lane = LaneOf(slot)) {
+        std::lock_guard<std::mutex> lock(lane->mutex);
+        if (lane->agvId == agvId) lane->cells.clear();
+    }
+
+    int released = 0;
+    size_t n = static_cast<size_t>(width_) * height_;
+    for (size_t i = 0; i < n; ++i) {
+        if (cells_[i].load(std::memory_order_relaxed) != me) continue;
+        if (ReleaseCell(static_cast<long>(i), me)) ++released;
+    }
+    return released;
+}
+
+int ReservationTable::Owner(const Point& p) const {
+    long idx = Enabled() ? IndexOf(p) : -1;
+    if (idx < 0) return -1;
+    return static_cast<int>(cells_[idx].load(std::memory_order_acquire)) - 1;
+}
+
+}
+}
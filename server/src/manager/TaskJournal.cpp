@@ -0,0 +1,382 @@
+#include "manager/TaskJournal.h"
+#include "myreactor/Timestamp.h"
+#include "utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace agv{
+namespace manager{
+
+using namespace model;
+
+namespace {
+// 缓冲上限 : 磁盘长时间卡住时前端也不能被拖住，超出的记录丢弃并计数
+constexpr size_t kMaxPendingRecords = 1u << 20;
+// 前端攒够这么多条就提前叫醒后端，不必等满组提交窗口
+constexpr size_t kWakeRecords = 4096;
+// 重放时每次读取的记录数
+constexpr size_t kReadChunk = 4096;
+// CRC 覆盖的字节数 (crc 字段之前)
+constexpr size_t kCrcBytes = offsetof(JournalRecord, crc);
+
+const uint32_t* CrcTable() {
+    static uint32_t table[256] = {0};
+    static bool init = [] {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return true;
+    }();
+    (void)init;
+    return table;
+}
+
+bool WriteAll(int fd, const void* data, size_t len) {
+    const char* p = static_cast<const char*>(data);
+    while (len > 0) {
+        ssize_t n = ::write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;  // 被信号打断 : 什么都没写，重试
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// rename 只改目录项 : 目录本身也要落盘，否则掉电后可能还是旧文件
+bool SyncParentDir(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+}
+
+TaskJournal::TaskJournal(const config::JournalConfig& cfg)
+    : cfg_(cfg) {}
+
+TaskJournal::~TaskJournal() {
+    Stop();  // 兜底
+}
+
+uint32_t TaskJournal::Crc(const JournalRecord& rec) {
+    const uint32_t* table = CrcTable();
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(&rec);
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < kCrcBytes; ++i) c = table[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+JournalRecord TaskJournal::Make(JournalOp op, TaskHandle taskId, int agvId) {
+    JournalRecord rec;
+    rec.op = static_cast<uint8_t>(op);
+    rec.taskId = taskId.value;
+    rec.agvId = agvId;
+    rec.timeMs = myreactor::Timestamp::now().toMilliseconds();
+    return rec;
+}
+
+// ================= 重放 =================
+
+bool TaskJournal::Recover(std::vector<RecoveredTask>& out) {
+    int fd = ::open(cfg_.path.c_str(), O_RDWR);
+    if (fd < 0) return true;  // 没有日志 : 全新启动
+
+    std::vector<JournalRecord> buf(kReadChunk);
+    int64_t good = 0;
+    size_t records = 0;
+    bool torn = false;
+    while (!torn) {
+        ssize_t n = ::read(fd, buf.data(), buf.size() * sizeof(JournalRecord));
+        if (n <= 0) break;
+        size_t count = static_cast<size_t>(n) / sizeof(JournalRecord);
+        if (static_cast<size_t>(n) % sizeof(JournalRecord) != 0) torn = true;  // 最后一条没写完
+        for (size_t i = 0; i < count; ++i) {
+            if (buf[i].crc != Crc(buf[i])) { torn = true; break; }
+            ApplyLocked(buf[i]);
+            good += static_cast<int64_t>(sizeof(JournalRecord));
+            ++records;
+        }
+    }
+
+    // 残缺尾部 : 截断，之后的追加从完好的边界开始
+    if (torn && ::ftruncate(fd, good) != 0) {
+        LOG_ERROR("[Journal] Failed to truncate torn tail of %s.", cfg_.path.c_str());
+    }
+    ::close(fd);
+    fileBytes_ = good;
+
+    out.clear();
+    out.reserve(live_.size());
+    for (const auto& [id, t] : live_) {
+        RecoveredTask r;
+        r.req.taskId.value = id;
+        r.req.targetAgvId = -1;
+        r.req.targetPos = Point{t.created.x, t.created.y};
+        r.req.targetAct = static_cast<ActionType>(t.created.act);
+        r.req.priority = t.created.priority;
+        r.createdMs = t.created.timeMs;
+        r.agvId = t.agvId;
+        r.progress = t.progress;
+        out.push_back(r);
+    }
+    std::sort(out.begin(), out.end(),
+              [](const RecoveredTask& a, const RecoveredTask& b) { return a.req.taskId.value < b.req.taskId.value; });
+
+    LOG_INFO("[Journal] Replayed %lu records from %s: %lu unfinished tasks%s.",
+             records, cfg_.path.c_str(), out.size(), torn ? " (torn tail truncated)" : "");
+    return true;
+}
+
+void TaskJournal::ApplyLocked(const JournalRecord& rec) {
+    switch (static_cast<JournalOp>(rec.op)) {
+        case JournalOp::CREATED: {
+            LiveTask& t = live_[rec.taskId];
+            t.created = rec;
+            break;
+        }
+        case JournalOp::DISPATCHED:
+        case JournalOp::ACKED: {
+            auto it = live_.find(rec.taskId);
+            if (it != live_.end()) it->second.agvId = rec.agvId;
+            break;
+        }
+        case JournalOp::PROGRESS: {
+            auto it = live_.find(rec.taskId);
+            if (it != live_.end()) {
+                it->second.agvId = rec.agvId;
+                it->second.progress = rec.progress;
+            }
+            break;
+        }
+        case JournalOp::DONE:
+            live_.erase(rec.taskId);
+            break;
+        case JournalOp::ROLLED_BACK: {
+            auto it = live_.find(rec.taskId);
+            if (it != live_.end()) {
+                it->second.agvId = -1;
+                it->second.progress = 0.0f;
+            }
+            break;
+        }
+        case JournalOp::PRIORITY: {
+            auto it = live_.find(rec.taskId);
+            if (it != live_.end()) {
+                it->second.created.priority = rec.priority;
+                it->second.created.crc = Crc(it->second.created);
+            }
+            break;
+        }
+    }
+}
+
+// ================= 后端线程 =================
+
+bool TaskJournal::OpenForAppend() {
+    fd_ = ::open(cfg_.path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0) {
+        LOG_ERROR("[Journal] Failed to open %s for append.", cfg_.path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool TaskJournal::Start() {
+    if (!stop_) return true;  // 重复启动
+    if (!OpenForAppend()) return false;
+
+    stop_ = false;
+    thread_ = std::make_unique<std::thread>(&TaskJournal::ThreadFunc, this);
+    LOG_INFO("[Journal] Writing to %s (group commit %dms, compact at %dMB).",
+             cfg_.path.c_str(), cfg_.groupCommitMs, cfg_.compactMb);
+    return true;
+}
+
+void TaskJournal::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) return;  // 重复停止
+        stop_ = true;
+    }
+    cond_.notify_one();
+    if (thread_ && thread_->joinable()) thread_->join();
+
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void TaskJournal::Append(JournalRecord rec) {
+    rec.crc = Crc(rec);  // 锁外算校验
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (current_.size() >= kMaxPendingRecords) {
+            ++dropped_;
+            return;
+        }
+        current_.push_back(rec);
+        wake = current_.size() == kWakeRecords;
+    }
+    if (wake) cond_.notify_one();
+}
+
+/*
+组提交 : 与 AsyncLogging::ThreadFunc 同样的双缓冲
+    前端只 push_back; 后端每个窗口 swap 一次，整批 write + 一次 fdatasync
+    批越大，每条记录分摊到的 fsync 越少; 空闲时不写盘
+*/
+void TaskJournal::ThreadFunc() {
+    std::vector<JournalRecord> batch;
+    const int64_t compactBytes = static_cast<int64_t>(std::max(1, cfg_.compactMb)) * 1024 * 1024;
+    const auto window = std::chrono::milliseconds(std::max(1, cfg_.groupCommitMs));
+
+    while (true) {
+        size_t dropped = 0;
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (current_.size() < kWakeRecords && !stop_) {
+                cond_.wait_for(lock, window);
+            }
+            if (current_.empty() && stop_) break;
+            batch.swap(current_);
+            std::swap(dropped, dropped_);
+            stopping = stop_;
+        }
+
+        /*
+        写失败时文件尾可能留下半条记录 : 截回上一个完好的边界，否则之后的批次都接在残片后面，
+        重放在残片处截断，后面完好的记录跟着全丢
+        */
+        if (!batch.empty()) {
+            if (!WriteAll(fd_, batch.data(), batch.size() * sizeof(JournalRecord))) {
+                LOG_ERROR("[Journal] Write to %s failed (%s), %lu records lost.", cfg_.path.c_str(), strerror(errno), batch.size());
+                if (::ftruncate(fd_, fileBytes_) != 0) {
+                    LOG_ERROR("[Journal] Failed to truncate %s back to %lld bytes.", cfg_.path.c_str(), static_cast<long long>(fileBytes_));
+                }
+            } else {
+                if (::fdatasync(fd_) != 0) {
+                    LOG_ERROR("[Journal] fdatasync on %s failed (%s), last %lu records may not be durable.",
+                              cfg_.path.c_str(), strerror(errno), batch.size());
+                }
+                fileBytes_ += static_cast<int64_t>(batch.size() * sizeof(JournalRecord));
+            }
+            for (const auto& rec : batch) ApplyLocked(rec);
+            batch.clear();
+        }
+        if (dropped > 0) {
+            LOG_ERROR("[Journal] Buffer full, %lu records dropped.", dropped);
+        }
+
+        if (fileBytes_ > compactBytes && !stopping) Compact();
+    }
+}
+
+/*
+压缩 : 影子状态里每个活任务写 1 ~ 2 条记录 (CREATED [+ PROGRESS，带所在车辆])
+    先写临时文件并 fdatasync，再 rename 覆盖并 fsync 所在目录 : 任何时刻崩溃，磁盘上要么是旧日志，要么是完整的新日志
+*/
+bool TaskJournal::Compact() {
+    int64_t before = fileBytes_;
+    std::string tmp = cfg_.path + ".compact";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("[Journal] Compaction failed: cannot open %s.", tmp.c_str());
+        return false;
+    }
+
+    std::vector<JournalRecord> snap;
+    snap.reserve(live_.size() * 2);
+    for (const auto& [id, t] : live_) {
+        snap.push_back(t.created);
+        if (t.agvId < 0) continue;
+        JournalRecord rec = t.created;
+        rec.op = static_cast<uint8_t>(JournalOp::PROGRESS);
+        rec.agvId = t.agvId;
+        rec.progress = t.progress;
+        rec.crc = Crc(rec);
+        snap.push_back(rec);
+    }
+
+    bool ok = WriteAll(fd, snap.data(), snap.size() * sizeof(JournalRecord)) && ::fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok || ::rename(tmp.c_str(), cfg_.path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        LOG_ERROR("[Journal] Compaction of %s failed, keep appending to the old file.", cfg_.path.c_str());
+        return false;
+    }
+
+    if (!SyncParentDir(cfg_.path)) {
+        LOG_ERROR("[Journal] Failed to sync directory of %s after compaction.", cfg_.path.c_str());
+    }
+
+    ::close(fd_);
+    if (!OpenForAppend()) return false;
+    fileBytes_ = static_cast<int64_t>(snap.size() * sizeof(JournalRecord));
+    LOG_INFO("[Journal] Compacted %s: %lld -> %lld bytes (%lu live tasks).",
+             cfg_.path.c_str(), static_cast<long long>(before), static_cast<long long>(fileBytes_), live_.size());
+    return true;
+}
+
+// ================= 前端便捷接口 =================
+
+void TaskJournal::Created(const TaskRequest& req, int64_t createdMs) {
+    JournalRecord rec;
+    rec.op = static_cast<uint8_t>(JournalOp::CREATED);
+    rec.taskId = req.taskId.value;
+    rec.timeMs = createdMs;
+    rec.x = req.targetPos.x;
+    rec.y = req.targetPos.y;
+    rec.act = static_cast<uint8_t>(req.targetAct);
+    rec.priority = static_cast<uint8_t>(req.priority);
+    Append(rec);
+}
+
+void TaskJournal::Dispatched(TaskHandle taskId, int agvId) {
+    Append(Make(JournalOp::DISPATCHED, taskId, agvId));
+}
+
+void TaskJournal::Acked(TaskHandle taskId, int agvId) {
+    Append(Make(JournalOp::ACKED, taskId, agvId));
+}
+
+void TaskJournal::Progress(TaskHandle taskId, int agvId, double progress) {
+    JournalRecord rec = Make(JournalOp::PROGRESS, taskId, agvId);
+    rec.progress = static_cast<float>(progress);
+    Append(rec);
+}
+
+void TaskJournal::Done(TaskHandle taskId, int agvId) {
+    Append(Make(JournalOp::DONE, taskId, agvId));
+}
+
+void TaskJournal::RolledBack(TaskHandle taskId, uint8_t reason) {
+    JournalRecord rec = Make(JournalOp::ROLLED_BACK, taskId, -1);
+    rec.reason = reason;
+    Append(rec);
+}
+
+void TaskJournal::Priority(TaskHandle taskId, int priority) {
+    JournalRecord rec = Make(JournalOp::PRIORITY, taskId, -1);
+    rec.priority = static_cast<uint8_t>(priority);
+    Append(rec);
+}
+
+}
+}
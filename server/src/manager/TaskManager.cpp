@@ -1,10 +1,12 @@
 #include "manager/TaskManager.h"
+#include "manager/TaskShard.h"
+#include "manager/TaskJournal.h"
 #include "manager/WorldManager.h"
-#include "session/AgvManager.h"
-#include "protocol/MsgType.h"
 #include "utils/Logger.h"
-#include <sstream>
-#include <myreactor/ThreadPool.h>
+#include "utils/MathUtils.h"
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
 #include "algo/scheduler/GreedyScheduler.h"  // 默认实现
 
 namespace agv{
@@ -12,604 +14,432 @@ namespace manager{
 
 using namespace model;
 
+namespace {
+// 每轮最多为一个分片借多少辆车 : 借车只改归属，量大了会让对方分区短时间内无车可派
+constexpr size_t kMaxBorrowPerRound = 4;
+}
+
 TaskManager& TaskManager::Instance() {
     static TaskManager instance;
     return instance;
 }
 
-TaskManager::TaskManager() // 基类指针指向派生类对象
-    : scheduler_(std::make_shared<algo::scheduler::GreedyScheduler>()) {}
+TaskManager::TaskManager()
+    : schedulerMaker_([] { return std::make_shared<algo::scheduler::GreedyScheduler>(); }) {}
 
-void TaskManager::Init(myreactor::ThreadPool* pool) {
-    if (workerPool_ != nullptr) {
+// TaskShard 在头文件里只有前置声明，析构放到这里
+TaskManager::~TaskManager() = default;
+
+void TaskManager::Init(myreactor::ThreadPool* pool, const config::DispatchConfig& cfg) {
+    if (initialized_) {
         LOG_WARN("TaskManager already initialized!");
         return;
     }
+    initialized_ = true;
+
+    zoneCols_ = std::max(1, cfg.zoneCols);
+    zoneRows_ = std::max(1, cfg.zoneRows);
+    // 分区号要放进任务句柄的分片位
+    if (static_cast<size_t>(zoneCols_) * static_cast<size_t>(zoneRows_) > TaskHandle::kMaxShards) {
+        LOG_WARN("TaskManager: %dx%d zones exceed the %lu-shard limit of task handles, falling back to 1x1.",
+                 zoneCols_, zoneRows_, TaskHandle::kMaxShards);
+        zoneCols_ = zoneRows_ = 1;
+    }
+    size_t n = static_cast<size_t>(zoneCols_) * static_cast<size_t>(zoneRows_);
+
+    shards_.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        auto shard = std::make_unique<TaskShard>(i, this);
+        shard->SetScheduler(schedulerMaker_());
+        if (dispatchSink_) shard->SetDispatchSink(dispatchSink_);
+        shard->Init(pool, cfg);
+        shards_.push_back(std::move(shard));
+    }
+
+    // 每轮调度都取车队快照 : 位置类变化按该间隔合并重建
+    WorldMgr.SetSnapshotInterval(cfg.fleetSnapshotMs);
 
-    workerPool_ = pool;
-    LOG_INFO("TaskManager initialized with ThreadPool.");
+    LOG_INFO("TaskManager initialized with %s. [Zones: %dx%d, Dispatch debounce: %dms / batch %d, aging: %dms per priority, bundle: %d (detour %d), prefetch at %.2f, predict horizon: %dms, stall timeout: %dms, fleet snapshot: %dms]",
+             pool == nullptr ? "inline rounds" : "ThreadPool",
+             zoneCols_, zoneRows_,
+             cfg.minIntervalMs, cfg.batchSize, cfg.agingMs, cfg.bundleSize, cfg.bundleDetour, cfg.prefetchProgress, cfg.predictHorizonMs, cfg.stallTimeoutMs, cfg.fleetSnapshotMs);
 }
 
-void TaskManager::SetScheduler(std::shared_ptr<algo::scheduler::ITScheduler> sche) {
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        scheduler_ = sche;
+void TaskManager::Stop() {
+    for (auto& shard : shards_) shard->Stop();
+    if (journalOwner_) journalOwner_->Stop();  // 分片停了不再产生记录，刷完最后一批
+}
+
+/*
+打开任务日志
+    1. 重放 : 得到崩溃前未完成的任务 (按句柄即创建顺序)
+    2. 取号 : lastStamp_ 推进到旧句柄之后，重启后时钟回拨也不会与旧任务撞号
+    3. 重新入队 : 全部回到待派队列 (车辆会话都已断开，执行中的任务无法确认); 保留原创建时间，老化照常累计
+       分区配置变了 (句柄里的分片号与目标点现在所在分区不一致) 的任务换发新句柄，日志里记一对 DONE(旧) / CREATED(新)
+地图加载之后调用 (分区要按地图尺寸算)
+*/
+bool TaskManager::OpenJournal(const config::JournalConfig& cfg) {
+    if (shards_.empty()) {
+        LOG_ERROR("[TaskManager] OpenJournal before Init.");
+        return false;
+    }
+    if (journalOwner_) {
+        LOG_WARN("[TaskManager] Task journal already opened.");
+        return true;
+    }
+
+    auto journal = std::make_unique<TaskJournal>(cfg);
+    std::vector<RecoveredTask> recovered;
+    if (!journal->Recover(recovered) || !journal->Start()) {
+        LOG_ERROR("[TaskManager] Task journal %s unavailable, running without persistence.", cfg.path.c_str());
+        return false;
     }
-    LOG_INFO("Scheduler switched to: %s", scheduler_->Name().c_str()); // 多态，调用派生类方法
+
+    uint64_t maxStamp = 0;
+    for (const auto& r : recovered) maxStamp = std::max(maxStamp, r.req.taskId.value & TaskHandle::kStampMask);
+    uint64_t last = lastStamp_.load(std::memory_order_relaxed);
+    while (last < maxStamp && !lastStamp_.compare_exchange_weak(last, maxStamp, std::memory_order_relaxed)) {}
+
+    journalOwner_ = std::move(journal);
+    journal_.store(journalOwner_.get(), std::memory_order_release);
+    if (recovered.empty()) return true;
+
+    // 地图可能变了 (随机地图每次启动重新生成 / 换了地图文件) : 目标点已不可达的任务作废，记一条完成，不再重放
+    const GridMap& map = WorldMgr.GetGridMap();
+    std::vector<std::vector<spTaskContext>> byShard(shards_.size());
+    size_t running = 0;
+    size_t rezoned = 0;
+    size_t dropped = 0;
+    for (const auto& r : recovered) {
+        if (map.IsObstacle(r.req.targetPos)) {
+            LOG_WARN("[TaskManager] Recovered task %s dropped: target (%d,%d) is not walkable on the current map.",
+                     r.req.taskId.ToText().c_str(), r.req.targetPos.x, r.req.targetPos.y);
+            journalOwner_->Done(r.req.taskId, -1);
+            ++dropped;
+            continue;
+        }
+        TaskRequest req = r.req;
+        size_t zone = ZoneOf(req.targetPos);
+        if (req.taskId.Shard() != zone) {
+            TaskHandle old = req.taskId;
+            req.taskId = GenerateTaskId(zone);
+            journalOwner_->Done(old, -1);
+            journalOwner_->Created(req, r.createdMs);
+            ++rezoned;
+        }
+        if (r.agvId >= 0) ++running;
+        byShard[zone].push_back(std::make_shared<TaskContext>(req, myreactor::Timestamp(r.createdMs * 1000)));
+    }
+    for (size_t z = 0; z < byShard.size(); ++z) {
+        if (!byShard[z].empty()) shards_[z]->AddTasks(std::move(byShard[z]));
+    }
+
+    LOG_INFO("[TaskManager] Recovered %lu unfinished tasks from journal (%lu were running, %lu re-zoned, %lu dropped).",
+             recovered.size() - dropped, running, rezoned, dropped);
+    return true;
+}
+
+void TaskManager::SetDispatchSink(DispatchSink sink) {
+    dispatchSink_ = sink;
+    for (auto& shard : shards_) shard->SetDispatchSink(sink);
+}
+
+bool TaskManager::HasPendingRound() const {
+    for (const auto& shard : shards_)
+        if (shard->HasPendingRound()) return true;
+    return false;
+}
+
+// 按分片下标顺序执行，保证离线仿真可复现
+bool TaskManager::RunPendingRound() {
+    bool ran = false;
+    for (auto& shard : shards_)
+        ran = shard->RunPendingRound() || ran;
+    return ran;
+}
+
+void TaskManager::SetScheduler(SchedulerMaker maker) {
+    if (!maker) return;
+    schedulerMaker_ = std::move(maker);
+    if (shards_.empty()) return;
+
+    // 分片在自己的写者线程上换装 (SET_SCHEDULER 事件)，名字从新实例上取
+    std::string name;
+    for (auto& shard : shards_) {
+        auto sche = schedulerMaker_();
+        if (name.empty() && sche) name = sche->Name(); // 多态，调用派生类方法
+        shard->SetScheduler(std::move(sche));
+    }
+    LOG_INFO("Scheduler switched to: %s (x%lu shards)", name.c_str(), shards_.size());
 }
 
 /*
 业务层：`TaskManager::GenerateTaskId` : 给人和数据库看的
-目标：生成一个 全局唯一、可追溯、人类可读 的业务凭证。
+目标：生成一个 全局唯一、可追溯 的业务凭证; 内部是 64 位句柄，只在日志 / JSON 边缘格式化成人类可读的字符串。
     为什么加时间戳？（防止重启冲突）
         `TaskManager` 是单例，但程序可能会重启。如果只用 `taskSeq_`（比如从 0 开始），今天发的第 1 个任务叫 `T-1`，明天重启后第 1 个任务还叫 `T-1`。当去查日志或数据库时，就会搞不清这到底是今天的任务还是昨天的任务。
         加上毫秒级时间戳，保证了 跨越进程生命周期 的唯一性。
-    为什么是 String？（可读性与灵活性）
-        `T-` 前缀让人一眼就能看出这是个“任务 ID”，而不是“AGV ID”或“地图 ID”。
-        它通常会出现在 UI 界面、日志文件、数据库主键中。字符串虽然占内存大一点，但在低频的任务调度场景（一秒钟几十个）下，性能损耗可以忽略， 可读性 价值更高。
+    为什么不再是 String？（热路径）
+        `T-` 前缀的字符串在 UI 界面、日志文件、数据库主键中可读性好，但车队规模上来后，任务每流转一次 (入队/出堆/上报匹配/回调/日志)
+        都要拷贝、哈希一次长字符串，超出 SSO 就是一次堆分配。现在 ID 是一个 uint64，字符串格式 `T-{毫秒}-{分片}-{序号}` 只在边缘生成。
     原子性需求
-        `++taskSeq_` 必须是原子的（或加锁），因为可能有多个线程（如 HTTP 接口线程、ROS 接口线程）同时请求创建任务。
+        `lastStamp_` 用 CAS 推进，因为可能有多个线程（如 HTTP 接口线程、ROS 接口线程）同时请求创建任务。
 */
 
-std::string TaskManager::GenerateTaskId() {
-    // 格式：T-{毫秒时间戳}-{序号}
-    int64_t now = myreactor::Timestamp::now().toMilliseconds();
-    std::stringstream ss;
-    ss << "T-" << now << "-" << ++taskSeq_;
-    return ss.str();  // sstream -> string
+TaskHandle TaskManager::GenerateTaskId(size_t shard) {
+    return TaskHandle::Make(ReserveStamps(1), shard);
 }
 
-void TaskManager::OnDispatchResult(int agvId, const std::string& taskId, bool success, const std::string& failreason) {
-    if(success) {
-        LOG_INFO("[RPC-ACK] Task %s dispatched to AGV %d confirmed.", taskId.c_str(), agvId);
-        return;
-    }
-
-    LOG_WARN("[RPC-FAIL] Task %s to AGV %d failed: %s. Rolling back...", taskId.c_str(), agvId, failreason.c_str());
-    bool rollbackSuccess = false;
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        // RollBack
-        auto it = runningTasks_.find(agvId);
-        // 双重检查：防止 AGV 已经换了别的任务
-        if(it != runningTasks_.end() && it->second->req.taskId == taskId) {
-            auto task = it->second;
-
-            // 回滚任务状态
-            task->req.targetAgvId = -1;  // -1 表示未分配
-
-            // 回滚队列状态 【回到头部】
-            pendingTasks_.push_front(task); // 在erase之前，避免迭代器失效
-            runningTasks_.erase(it);
+uint64_t TaskManager::ReserveStamps(size_t n) {
+    uint64_t floor = TaskHandle::StampFloor(myreactor::Timestamp::now().toMilliseconds());
+    uint64_t last = lastStamp_.load(std::memory_order_relaxed);
+    uint64_t first = 0;
+    do {
+        first = std::max(last + 1, floor);  // 同一毫秒递增序号; 溢出借位到毫秒
+    } while (!lastStamp_.compare_exchange_weak(last, first + n - 1, std::memory_order_relaxed));
+    return first;
+}
 
-            rollbackSuccess = true;
-        }
-    }
+size_t TaskManager::ZoneOf(const Point& pos) const {
+    if (zoneCols_ == 1 && zoneRows_ == 1) return 0;
 
+    const GridMap& map = WorldMgr.GetGridMap();
+    int w = std::max(1, map.GetWidth());
+    int h = std::max(1, map.GetHeight());
+    int cx = std::min(zoneCols_ - 1, std::max(0, pos.x * zoneCols_ / w));
+    int cy = std::min(zoneRows_ - 1, std::max(0, pos.y * zoneRows_ / h));
+    return static_cast<size_t>(cy * zoneCols_ + cx);
+}
 
-    if(rollbackSuccess){
-        LOG_WARN("[RPC-FAIL] Task %s to AGV %d failed. Rollback successful", taskId.c_str(), agvId); 
-    }else {
-        LOG_ERROR("Rollback failed: Task %s for AGV %d not found or mismatch.", taskId.c_str(), agvId);
+TaskHandle TaskManager::AddTask(Point targetPos, ActionType targetAct, int priority) {
+    if (shards_.empty()) {
+        LOG_ERROR("[TaskManager] AddTask before Init, task dropped.");
+        return {};
     }
-}
 
-std::string TaskManager::AddTask(Point targetPos, ActionType targetAct) {
-    // 1.构造网络包（任务核心提炼）
+    // 1.构造网络包（任务核心提炼）; 分区号写进句柄
+    size_t zone = ZoneOf(targetPos);
     TaskRequest req;
-    req.taskId = GenerateTaskId();
+    req.taskId = GenerateTaskId(zone);
     req.targetAgvId = -1;  // -1 表示未分配
     req.targetPos = targetPos;
     req.targetAct = targetAct;
-    req.priority = 1;
+    req.priority = std::max(kMinPriority, std::min(priority, kMaxPriority));
 
-    // 2.包装成上下文
+    // 2.包装成上下文，按目标点所在分区入片
     spTaskContext task = std::make_shared<TaskContext>(req);
 
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        // 3.入队
-        pendingTasks_.push_back(task);
-    }
-
-    LOG_INFO("[TaskManager] New Task Added: %s -> Target(%d, %d), CreatedAt: %s",
-        req.taskId.c_str(),
+    LOG_INFO("[TaskManager] New Task Added: %s -> Target(%d, %d), Priority: %d, Zone: %lu, CreatedAt: %s",
+        req.taskId.ToText().c_str(),
         targetPos.x, targetPos.y,
+        req.priority,
+        zone,
         task->createTime.toFormattedString().c_str()
     );
 
-    // 4. 尝试立即调度(内部含锁)
-    TryDispatch(); 
+    // 3.先落日志再入队 : 分片上的后续流转记录一定排在 CREATED 之后
+    if (TaskJournal* journal = Journal()) journal->Created(req, task->createTime.toMilliseconds());
+
+    // 4.入队 + 尝试立即调度
+    shards_[zone]->AddTask(task);
 
     return req.taskId;
 }
 
-
-
-
-void TaskManager::ProcessLogs_TD(const std::vector<DeferredLog>& logs) {
-    for (const auto& log : logs) {
-        switch (log.action) {
-            case LogAction::DISPATCH_SUCCESS:
-                LOG_INFO("[TaskManager] Dispatch Success: Task=%s -> AGV=%d (Dist=%d)", log.taskId.c_str(), log.agvId, log.extraVal);
-                break;
-
-            case LogAction::DOUBLE_CHECK_FAILED:
-                LOG_WARN("[TaskManager] Dispatch Skipped: AGV %d status changed to %d during double check. Task=%s", log.agvId, log.extraVal, log.taskId.c_str());
-                break;
-
-            case LogAction::SESSION_LOST:
-                LOG_WARN("[TaskManager] Dispatch Failed: Session lost for AGV %d. Rolling back Task=%s", log.agvId, log.taskId.c_str());
-                break;
-
-            case LogAction::DISPATCH_FAILED:
-            LOG_ERROR("[TaskManager] Dispatch failed for unknown reason: AGV %d , Task=%s", log.agvId, log.taskId.c_str());
-                break; 
-            default:
-                break;
-        }
+/*
+批量发布
+    1. 取号 : 一次 CAS 预留 orders.size() 个连续 stamp
+    2. 分配 : 所有 TaskContext 放在同一个 deque 里，每个任务的 shared_ptr 用别名构造共享这一块的引用计数
+       —— 一次控制块，而不是每单一次。别名指针直接指向元素，要求元素地址在整批构造期间不变:
+       deque 尾插不搬动已有元素，vector 扩容会搬走 (const createTime 只禁赋值，不妨碍移动)
+       代价 : 整块内存在这一波最后一个任务释放时才归还
+    3. 入片 : 按目标点分区分组，每个分片一个 ADD_TASKS 事件
+*/
+std::vector<TaskHandle> TaskManager::AddTasks(const std::vector<OrderSpec>& orders) {
+    std::vector<TaskHandle> ids;
+    if (shards_.empty()) {
+        LOG_ERROR("[TaskManager] AddTasks before Init, %lu tasks dropped.", orders.size());
+        return ids;
     }
-}
+    if (orders.empty()) return ids;
 
-void TaskManager::TryDispatch() {
-    // 1. 【IO 线程】获取观测世界快照 (读操作，快)
-    auto onlineAgvs = WorldMgr.GetAllAgvs();
-    if (onlineAgvs.empty()) return;
-
-    // 2. 【IO 线程】加锁获取任务快照 + 策略快照
-    // 这里只拷贝指针，速度极快，不会阻塞 IO 很久
-    std::vector<spTaskContext> taskInput;
-    std::shared_ptr<algo::scheduler::ITScheduler> currentScheduler; 
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (pendingTasks_.empty()) return;
-
-        taskInput.reserve(pendingTasks_.size());
-        for (const auto& t : pendingTasks_) taskInput.push_back(t);
-
-        /*
-        单例的稳定性 vs 组件的动态性
-            WorldManager 作为单例，其自身的内存生命周期贯穿整个进程，是稳定的‘容器’。但它持有的组件（如 planner_）是动态的，允许在运行时被替换（Replaced）
-        指针快照（Snapshot）机制
-            “我们在执行计算时，利用 shared_ptr 的引用计数机制建立了一个**‘局部快照’。 currentPlanner = planner_; 这一行代码，让局部变量也持有了策略对象的引用（引用计数 +1）。这就相当于给当前的策略对象买了一份‘临时保险’**。”
-        生命周期延长（Life Extension）
-            “此时，即使其他线程调用 SetPlanner 修改了成员变量 planner_ 的指向（让它指向新算法），旧的算法对象也不会被销毁。 因为我们的局部快照依然持有它。直到当前计算函数结束，局部变量离开作用域，旧对象的引用计数归零，它才会真正析构。这完美实现了无锁且安全的算法热切换。”
-        */
-        // 在锁内顺便把调度策略指针也拷贝一份，且引用技计数+1，保活到任务当前调度结束
-        currentScheduler = scheduler_;
+    uint64_t stamp = ReserveStamps(orders.size());
+    myreactor::Timestamp now = myreactor::Timestamp::now();
+    TaskJournal* journal = Journal();
+
+    auto block = std::make_shared<std::deque<TaskContext>>();
+    std::vector<std::vector<spTaskContext>> byShard(shards_.size());
+    ids.reserve(orders.size());
+
+    for (size_t i = 0; i < orders.size(); ++i) {
+        const OrderSpec& o = orders[i];
+        size_t zone = ZoneOf(o.targetPos);
+
+        TaskRequest req;
+        req.taskId = TaskHandle::Make(stamp + i, zone);
+        req.targetAgvId = -1;  // -1 表示未分配
+        req.targetPos = o.targetPos;
+        req.targetAct = o.targetAct;
+        req.priority = std::max(kMinPriority, std::min(o.priority, kMaxPriority));
+
+        if (journal) journal->Created(req, now.toMilliseconds());
+        block->emplace_back(req, now);
+        byShard[zone].emplace_back(block, &block->back());  // 别名构造 : 共享整块的引用计数
+        ids.push_back(req.taskId);
     }
 
-    // 万一还没设置算法
-    if(!currentScheduler) return;
+    size_t zones = 0;
+    for (size_t z = 0; z < byShard.size(); ++z) {
+        if (byShard[z].empty()) continue;
+        ++zones;
+        shards_[z]->AddTasks(std::move(byShard[z]));
+    }
 
-    // 3. 【IO 线程】投递任务到工作线程池
-    // 捕获 taskInput 和 onlineAgvs (按值拷贝(获取栈对象与跨线程)); 值拷贝调度算法的shared_ptr，引入计数+1
-    workerPool_->addtask([this, taskInput, onlineAgvs, currentScheduler]() {
-        this->ExecuteDispatch(taskInput, onlineAgvs, currentScheduler);
-    });
+    LOG_INFO("[TaskManager] Wave of %lu tasks added: %s .. %s across %lu zones.",
+             orders.size(), ids.front().ToText().c_str(), ids.back().ToText().c_str(), zones);
+    return ids;
 }
 
-// 【Worker 线程】
-void TaskManager::ExecuteDispatch(
-    const std::vector<spTaskContext>& tasksSnapst,
-    const std::vector<model::AgvInfo>& agvsSnapst,
-    std::shared_ptr<algo::scheduler::ITScheduler> currSche) 
-{
-        // ---------------- 数据准备 ----------------
-      
-        // 可用的车辆列表 ：从备选列表筛选
-        std::vector<AgvInfo> candiAgvs;
-        candiAgvs.reserve(agvsSnapst.size());
-
-        for (const auto& agv : agvsSnapst) {
-        // 物理状态
-            // 1.必须空闲
-            if (agv.status != AgvStatus::IDLE) continue;
-            // 2.有电
-            if (agv.battery < 20.0) continue;
-        // 逻辑状态
-            // 3.占用检测，无法访问 runningTasks_ (因为没锁)，在后面决策完后再检查的锁内做检查
-            // if (runningTasks_.find(agv.uid)!=runningTasks_.end()) continue;
-
-            candiAgvs.push_back(agv);
-        }
+// 句柄里带着分区号，直接路由到所在分片
+bool TaskManager::SetTaskPriority(TaskHandle taskId, int priority) {
+    if (!taskId.Valid() || taskId.Shard() >= shards_.size()) return false;
 
-        if (candiAgvs.empty()) {
-            LOG_WARN("[TaskManager] No candidate AGVs available for dispatch. Total AGVs: %lu", agvsSnapst.size());
-            return;
-        }
+    priority = std::max(kMinPriority, std::min(priority, kMaxPriority));
+    shards_[taskId.Shard()]->SetTaskPriority(taskId, priority);
+    return true;
+}
 
-        // 待调度的任务列表 : pendingTasks 里面的全部被存入 快照， 只要在等待队列里的，都需要执行，无需筛选
+// 车有任务序列时归属不会变 (被占住的车借不走; 重新归属只发生在序列做完时)，路由到的分片一定持有它的序列
+void TaskManager::OnTaskReport(const TaskReport& msg) {
+    if (shards_.empty()) return;
+    shards_[OwnerOf(msg.agvId, msg.currentPos)]->OnTaskReport(msg);
+}
 
-        // ---------------- 核心调度 ----------------
-        // 调用调度算法
-        LOG_INFO("[TaskManager] Dispatching: %lu tasks, %lu candidate AGVs", tasksSnapst.size(), candiAgvs.size());
-        auto decisions = currSche->Dispatch(tasksSnapst, candiAgvs);
-        LOG_INFO("[TaskManager] Scheduler returned %lu decisions", decisions.size());
+void TaskManager::TryDispatch() {
+    for (auto& shard : shards_) shard->TryDispatch();
+}
 
-        // ---------------- 执行决策 ----------------
-        // 锁前准备
-        std::vector<DeferredLog> logs;
-        logs.reserve(16); // 预估容量,减少扩容开销
-        bool hasAssignment = false; // 【优化标记】, 以便 pendingTasks链表批量清除
-        
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-
-        for (const auto& dec : decisions) {
-            auto task = dec.task;
-            int agvId = dec.agvId;
-
-            // 【1.Double Check : 车辆状态检测】
-            // 物理状态 
-            /*
-            状态 (IDLE -> BUSY)：这是 瞬态变化。前 1 毫秒是空闲，后 1 毫秒可能就被另一个线程或者心跳包置为 BUSY。如果不检查，会撞车（逻辑撞车）。必须检查！
-            电量 (20.0V -> 19.99V)：这是 缓变物理量;即使掉了一点电，也不会导致逻辑错误（只是车稍微亏电一点去干活了） 【工程取舍】
-            */
-            auto currentStatus = WorldMgr.GetAgvStatus(agvId);
-            if (currentStatus != AgvStatus::IDLE) {
-                logs.push_back({LogAction::DOUBLE_CHECK_FAILED, task->req.taskId, agvId, (int)currentStatus});
-                continue;
-            }
-            // 逻辑状态（占用状态）
-            if (runningTasks_.count(agvId) > 0) continue;  // 算完做一次总的占用检测
-
-            // 【2. 任务状态检测】
-            // 在 无锁的 计算期间，任务的状态发生变化了
-            // 任务本身是否被分配
-            if (task->req.targetAgvId != -1) continue;
-            
-            
-            // 网络下发
-            //定义回调
-            /* Lambda 是 C++ 中连接 异步操作 和 上下文保持 的最强胶水。
-                    捕获列表，捕获的的就是上下文，而参数列表式就是对外提供的参数表现，lambda函数内部既可以是自己现场定义的，也可以调用别的已经写好的函数
-            Lambda 的一个作用是“调整参数列表”，但这只是表象。
-            它在底层的核心作用是：“携带上下文（Context Capture）”。
-            */
-            /*
-            Session 定义的回调接口 (RpcCallback)： Session 是底层通用的，它根本不知道什么是 taskId，也不知道现在的 agvId 是多少。它只管通信结果。
-                // Session 只提供两个参数：结果好坏、原因
-                using RpcCallback = std::function<void(bool success, string reason)>;
-            TaskManager 真正需要的处理函数 (OnDispatchResult)： TaskManager 想要回滚任务，它必须知道：是哪辆车、哪个任务失败了。
-                // TaskManager 需要四个参数
-                void OnDispatchResult(int agvId, string taskId, bool success, string reason);
-            */
-            auto callback = [this, agvId, taskId = task->req.taskId](bool success, const std::string& reason) {
-                this->OnDispatchResult(agvId, taskId, success, reason);
-            };
-
-            // sess 检查
-            auto sess = AgvMgr.GetSession(agvId);
-            if (sess == nullptr) { // Session 丢失
-                logs.push_back({LogAction::SESSION_LOST, task->req.taskId, agvId, 0});
-                continue;
-            }
-
-            // sess->Send(protocol::MsgType::TASK_REQUEST, task->req);
-            // 调用业务接口
-            bool isSend = sess->DispatchTask(task->req, callback);
-            if (!isSend) {
-                logs.push_back({LogAction::DISPATCH_FAILED, task->req.taskId, agvId, 0});
-                continue;
-            }
-
-            // 下发成功入队 (Send内部丢给IO线程了)
-            /*
-            一致性保障：runningTasks_[bestAgvId] = task; 这一行就是核心。在网络包到达前，先在内存里占住了坑位。即使网络发送慢了，下一轮循环也不会把这辆车派给别人。
-            */
-            task->req.targetAgvId = agvId; // 更新 task 状态
-            runningTasks_[agvId] = task;
-            logs.push_back({LogAction::DISPATCH_SUCCESS, task->req.taskId, agvId, dec.Distance});
-            
-            hasAssignment = true;
-        }
+void TaskManager::NotifyShard(size_t shard) {
+    if (shard < shards_.size()) shards_[shard]->TryDispatch();
+}
 
-        // ---------------- 批量清理 ----------------
-        // pendingTask 是 list , 无键，利用 结点信息 [task 状态是否更新] 判断是否要清除 remove_if
-        if (hasAssignment) {
-            pendingTasks_.remove_if([](const spTaskContext& t) {
-                return t->req.targetAgvId != -1; // 更新过的都要清掉
-            });
-        }
-        
+void TaskManager::NotifyBacklogged(size_t idle) {
+    for (auto& shard : shards_) {
+        if (shard->Index() != idle && shard->PendingCount() > 0) shard->TryDispatch();
     }
-
-    // 锁外打印日志
-    ProcessLogs_TD(logs);
-
 }
 
-/*
-std::list::remove_if 是 C++ 双向链表 std::list 的成员函数，用于批量删除链表中所有满足自定义条件的元素，直接在原链表上修改，无需额外内存。
-    template <class Predicate>
-        void remove_if (Predicate pred);
-    参数为可调用谓词， O(N)  ; 谓词 lambda 表达式的 参数为 list中单个元素的代表，保证与list原色类型一致
-*/
-
-/*
-范围 for 是 “简洁遍历的语法糖”，设计目标是 “只读 / 修改元素内容”；而代码需要 “遍历中修改容器（删元素）+ 精准控制迭代器”，这超出了范围 for 的能力边界；需要用 显式迭代器遍历
-*/
-
-/*void TaskManager::TryDispatch() {
-    // 【Snapshot : 快照】 : 备选车辆列表
-    auto onlineAgvs = WorldMgr.GetAllAgvs();
-    if(onlineAgvs.empty()) return;
-
-    // 锁外准备日志容器
-    std::vector<DeferredLog> logs;
-    logs.reserve(16); // 预估容量,减少扩容开销
+// ================= 车辆归属 =================
 
+size_t TaskManager::OwnerOf(int agvId, const Point& pos) {
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-
-        if(pendingTasks_.empty()) return;
-        
-        // ---------------- 数据准备 ----------------
-        // 待调度任务列表 list -> vector ：指针拷贝, O(N)
-        std::vector<spTaskContext> taskInput;
-        taskInput.reserve(pendingTasks_.size()); // reserve 避免 push_back 时的多次内存重分配
-        for (const auto& t : pendingTasks_) taskInput.push_back(t);  
-
-        // 可用的车辆列表 ：从备选列表筛选
-        std::vector<AgvInfo> candiAgvs;
-        candiAgvs.reserve(onlineAgvs.size());
-
-        for (const auto& agv : onlineAgvs) {
-            // 1.必须空闲
-            if (agv.status != AgvStatus::IDLE) continue;
-            // 2.有电
-            if (agv.battery < 20.0) continue;
-            // 3.占用检测
-            if (runningTasks_.find(agv.uid)!=runningTasks_.end()) continue;
-
-            candiAgvs.push_back(agv);
-        }
-
-        if (candiAgvs.empty()) return;
-
-        // ---------------- 核心调度 ----------------
-        // 调用调度算法
-        auto decisions = scheduler_->Dispatch(taskInput, candiAgvs);
-
-        // ---------------- 执行决策 ----------------
-        bool hasAssignment = false; // 【优化标记】, 以便 pendingTasks链表批量清除
-
-        for (const auto& dec : decisions) {
-            auto task = dec.task;
-            int agvId = dec.agvId;
-            
-            // 【1.Double Check : 再确认物理状态】
-            auto currentStatus = WorldMgr.GetAgvStatus(agvId);
-            if (currentStatus != AgvStatus::IDLE) {
-                logs.push_back({LogAction::DOUBLE_CHECK_FAILED, task->req.taskId, agvId, (int)currentStatus});
-                continue;
-            }
-
-            // 工作队列检测
-            // GreedyScheduler 内部已经保证了不重复分配(决策意图限制)
-            // AI算法内部写复杂的解码逻辑来去重，或者 ：
-            // if (runningTasks_.count(agvId) > 0) continue; 
-            
-            // 网络下发
-            auto sess = AgvMgr.GetSession(agvId);
-            if (sess == nullptr) { // Session 丢失
-                logs.push_back({LogAction::SESSION_LOST, task->req.taskId, agvId, 0});
-                continue;
-            }
-            
-            sess->Send(protocol::MsgType::TASK_REQUEST, task->req);
-
-            // 下发成功入队 
-            task->req.targetAgvId = agvId; // 更新 task 状态
-            runningTasks_[agvId] = task;
-            logs.push_back({LogAction::DISPATCH_SUCCESS, task->req.taskId, agvId, dec.Distance});
-            
-            hasAssignment = true;
-        }
-
-        // ---------------- 批量清理 ----------------
-        // pendingTask 是 list , 无键，利用 结点信息 [task 状态是否更新] 判断是否要清除 remove_if
---------------------------------------------------------------------------------  
---------------------------------------------------------------------------------
-std::list::remove_if 是 C++ 双向链表 std::list 的成员函数，用于批量删除链表中所有满足自定义条件的元素，直接在原链表上修改，无需额外内存。
-    template <class Predicate>
-        void remove_if (Predicate pred);
-    参数为可调用谓词， O(N)  ; 谓词 lambda 表达式的 参数为 list中单个元素的代表，保证与list原色类型一致
---------------------------------------------------------------------------------
---------------------------------------------------------------------------------
-        
-        if (hasAssignment) {
-            pendingTasks_.remove_if([](const spTaskContext& t) {
-                return t->req.targetAgvId != -1; // 更新过的都要清掉
-            });
-        }
-        
+        std::shared_lock<std::shared_mutex> lock(ownerMutex_);
+        auto it = agvOwner_.find(agvId);
+        if (it != agvOwner_.end()) return it->second.shard;
     }
+    std::unique_lock<std::shared_mutex> lock(ownerMutex_);
+    return agvOwner_.emplace(agvId, OwnerSlot{ZoneOf(pos), false}).first->second.shard;  // 已被别人登记则保留
+}
 
-    // 锁外打印日志
-    ProcessLogs_TD(logs);
-
-}*/
-
-/*void TaskManager::TryDispatch() {
-    // 【Snapshot : 快照筛选】
-    auto onlineAgvs = WorldMgr.GetAllAgvs();
+bool TaskManager::HoldAgv(size_t shard, int agvId) {
+    std::unique_lock<std::shared_mutex> lock(ownerMutex_);
+    auto it = agvOwner_.find(agvId);
+    if (it == agvOwner_.end() || it->second.shard != shard) return false;
+    it->second.held = true;
+    return true;
+}
 
-    // 锁外准备日志容器
-    std::vector<DeferredLog> logs;
-    logs.reserve(16); // 预估容量,减少扩容开销
+void TaskManager::UnholdAgv(int agvId) {
+    std::unique_lock<std::shared_mutex> lock(ownerMutex_);
+    auto it = agvOwner_.find(agvId);
+    if (it != agvOwner_.end()) it->second.held = false;
+}
 
+void TaskManager::CollectOwned(size_t shard, const std::vector<AgvInfo>& fleet, std::vector<AgvInfo>& out) {
+    bool unknown = false;
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-
-        if(pendingTasks_.empty()) return;
-        if(onlineAgvs.empty()) return;
-
-        // 遍历等待任务
-        for (auto it = pendingTasks_.begin(); it != pendingTasks_.end(); ) { // 
-            auto task = *it;
-
-            int bestAgvId = -1;
-
-            // ---------- 调度算法 ----------
-            int minDistance = 9999999;
-
-            for (const auto& agv : onlineAgvs) {
-                // 1.必须空闲
-                if (agv.status != AgvStatus::IDLE) continue;
-                // 2.有电
-                if (agv.battery < 20.0) continue;
-                // 3.决策意图检查
-                if (runningTasks_.find(agv.uid)!=runningTasks_.end()) continue;
-
-                // 贪心策略 ： 找最近
-                int dis = CalMhtDis(agv.currentPos, task->req.targetPos);
-                if (dis< minDistance) {
-                    minDistance = dis;
-                    bestAgvId = agv.uid;
-                }
-            }
-
-            // ---------- 派单执行 ----------
-            if (bestAgvId == -1) { // 当前任务找不到合适的车，看下一个任务
-                ++it;
-            }
-            else{
-                // 【1.Double Check : 再确认】
-                auto currentStatus = WorldMgr.GetAgvStatus(bestAgvId);
-                if (currentStatus != AgvStatus::IDLE) {
-                    // LOG_WARN("[TaskManager] Double check failed for AGV %d (Status changed to %d). Skip.", bestAgvId, (int)currentStatus);
-                    logs.emplace_back(LogAction::DOUBLE_CHECK_FAILED, task->req.taskId, bestAgvId, (int)currentStatus);
-
-                    ++it;
-                    continue;
-                }
-                // 【2.Reservation : 资源预占】
-                // 防止在发包以及车辆响应之前,其他线程/下次循环也不会再考虑这辆车
-                task->req.targetAgvId = bestAgvId;
-                runningTasks_[bestAgvId] = task;
-                
-                // 网络下发
-                auto sess = AgvMgr.GetSession(bestAgvId);
-                if (sess == nullptr) { // Session 丢失
-                    // 【3.RollBack : 异常回滚】
-                    logs.emplace_back(LogAction::SESSION_LOST, task->req.taskId, bestAgvId, 0);
-
-                    runningTasks_.erase(bestAgvId);
-                    ++it;   
-                }
-                else {
-                    sess->Send(protocol::MsgType::TASK_REQUEST, task->req);
-
-                    // LOG_INFO("[TaskManager] Dispatch Task %s to AGV %d (Dist=%d)", task->req.taskId.c_str(), bestAgvId, minDistance);
-                    logs.emplace_back(LogAction::DISPATCH_SUCCESS, task->req.taskId, bestAgvId, minDistance);
-                    
-                    // 成功下发，清理等待队列
-                        it = pendingTasks_.erase(it);
-                }
-            }
+        std::shared_lock<std::shared_mutex> lock(ownerMutex_);
+        for (const auto& agv : fleet) {
+            auto it = agvOwner_.find(agv.uid);
+            if (it == agvOwner_.end()) unknown = true;
+            else if (it->second.shard == shard) out.push_back(agv);
         }
     }
+    if (!unknown) return;
 
-    // 锁外打印日志
-    ProcessLogs_TD(logs);
+    // 新上线的车 : 按当前位置登记，写锁只在有新车时才拿
+    std::unique_lock<std::shared_mutex> lock(ownerMutex_);
+    for (const auto& agv : fleet) {
+        auto res = agvOwner_.emplace(agv.uid, OwnerSlot{ZoneOf(agv.currentPos), false});
+        if (res.second && res.first->second.shard == shard) out.push_back(agv);
+    }
+}
 
-}*/
+bool TaskManager::TransferOwner(int agvId, size_t from, size_t to) {
+    std::unique_lock<std::shared_mutex> lock(ownerMutex_);
+    auto it = agvOwner_.find(agvId);
+    if (it == agvOwner_.end() || it->second.shard != from || it->second.held) return false;
+    it->second.shard = to;
+    return true;
+}
 
+size_t TaskManager::RehomeAgv(int agvId, const Point& pos) {
+    size_t zone = ZoneOf(pos);
+    std::unique_lock<std::shared_mutex> lock(ownerMutex_);
+    agvOwner_[agvId] = OwnerSlot{zone, false};
+    return zone;
+}
 
 /*
-目的是根据 任务汇报消息结构体 来更新 数字任务全景的状态：
-    1.找到运行中的任务 
-        TaskManager的map的key： 结构体中的agvId 
-        if_1:是否找到 ： 找到迭代器并【if_2判断任务序号】，匹配才更新
-    2.更新任务数据
-        if_3：任务是否完成 ： 完成则 移除
+跨区借车
+    需求方 : 待派任务数 > 本区可派车数 的分片 (在自己的调度轮次开头调用)
+    供给方 : 空闲车数 > 待派任务数 的分片，只借出富余部分，不会把对方借空
+    挑车   : 离需求方队首任务最近的优先，每轮最多 kMaxBorrowPerRound 辆
+    借车 = 改归属 (TransferOwner)，只借没被占住的车; 供给方这期间正在给这辆车派单的话，
+           HoldAgv 与 TransferOwner 在 ownerMutex_ 上串行，先到的一方赢，另一方放弃
+    供给方的待派数量读的是它发布的快照 (PendingCount)，不打扰它的写者线程
 */
-void TaskManager::OnTaskReport(const TaskReport& msg) {
-    // 栈变量 ：临时指针,用于在锁外的接管生命周期) ; 状态标记; 临时数据容器
-    bool istask = false;
-    bool isTaskFinished = false;
-    bool isTaskRejected = false;  // 实现回滚
-    double durationSec = 0.0;
-    spTaskContext taskToRetry = nullptr;
-
-    myreactor::Timestamp now = myreactor::Timestamp::now();
-    
-
+size_t TaskManager::BorrowAgvs(size_t needy, size_t want, const Point& near, const std::vector<AgvInfo>& fleet) {
+    want = std::min(want, kMaxBorrowPerRound);
+    if (want == 0) return 0;
+
+    // 1. 其他分片的空闲车
+    struct Cand {
+        int dist;
+        const AgvInfo* agv;
+        size_t from;
+    };
+    std::vector<Cand> cands;
+    std::unordered_map<size_t, int64_t> surplus;        // 分片 -> 可借出的数量
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-
-        auto it = runningTasks_.find(msg.agvId);
-        if (it != runningTasks_.end()) {
-            spTaskContext taskinmap = it->second;
-            if (msg.taskId == taskinmap->req.taskId){ //1
-                istask = true; 
-
-                // 任务报错/决绝 -> Rollback
-                if (msg.status == AgvStatus::ERROR) { //2
-                    isTaskRejected = true;
-
-                    // 恢复任务下派前的状态：
-                    taskToRetry = taskinmap; // 等待队列
-                    runningTasks_.erase(it);
-                }
-                // 正常更新/完成
-                else { 
-                    // 核心更新                       //3
-                    taskinmap->status = msg.status;
-                    taskinmap->progress = msg.progress;
-                    taskinmap->updateTime = now;
-
-                    // 计算耗时
-                    durationSec = (now.usSinceEpoch()- taskinmap->createTime.usSinceEpoch())/1000000.0;
-
-                    // 任务是否完成                   //4
-                    if(msg.status == AgvStatus::IDLE && msg.progress >= 1.0) {
-                        isTaskFinished = true;
-                        runningTasks_.erase(it);
-                    }
-                }    
-            }     
+        std::shared_lock<std::shared_mutex> lock(ownerMutex_);
+        for (const auto& agv : fleet) {
+            if (agv.status != AgvStatus::IDLE || agv.battery < 20.0) continue;
+            auto it = agvOwner_.find(agv.uid);
+            if (it == agvOwner_.end() || it->second.shard == needy || it->second.held) continue;
+            ++surplus[it->second.shard];
+            cands.push_back({CalMhtDis(agv.currentPos, near), &agv, it->second.shard});
         }
     }
+    if (cands.empty()) return 0;
 
-    // 1.没找到任务或任务不匹配
-    if(!istask) {
-        LOG_WARN("[TaskManager] Ignored report from AGV %d: No matching running task.", msg.agvId);
-        return;
+    // 2. 扣掉供给方自己要派的
+    for (auto& [shard, n] : surplus) {
+        n -= static_cast<int64_t>(shards_[shard]->PendingCount());
     }
 
-    // 2. 处理拒绝/失败
-    if(isTaskRejected) {
-        LOG_WARN("[TaskManager] Task %s REJECTED/FAILED by AGV %d. Rolling back...", msg.taskId.c_str(), msg.agvId);
-
-        if(taskToRetry) {
-            // 恢复状态
-            taskToRetry->req.targetAgvId = -1;  // -1 表示未分配
-            taskToRetry->status = AgvStatus::IDLE;
-            taskToRetry->progress = 0.0;
-
-            // 返回等待队列
-            std::lock_guard<std::mutex> lock(mutex_);
-            pendingTasks_.push_front(taskToRetry);
-        }
-
-        // 换车或者唤车
-        TryDispatch();
-        return;
-    }
-
-    // 3.未完成：打印进度
-    LOG_INFO("[TaskManager] Task Update: ID=%s, AGV=%d, Progress=%.2f, Elapsed=%.2fs", msg.taskId.c_str(), msg.agvId, msg.progress, durationSec);
-
-    // 4.已完成：打印结算
-    if(isTaskFinished){
-        LOG_INFO("[TaskManager] Task %s COMPLETED by AGV %d. Total Time: %.2fs", msg.taskId.c_str(), msg.agvId, durationSec);
+    // 3. 就近借
+    std::sort(cands.begin(), cands.end(), [](const Cand& a, const Cand& b) { return a.dist < b.dist; });
+    size_t got = 0;
+    for (const auto& c : cands) {
+        if (surplus[c.from] <= 0) continue;
+        if (!TransferOwner(c.agv->uid, c.from, needy)) continue;  // 归属已变 / 已被占住
 
-        // 有小车空出，下一轮调度
-        TryDispatch();
+        --surplus[c.from];
+        LOG_INFO("[TaskManager] Zone %lu lent AGV %d to zone %lu (Dist=%d)", c.from, c.agv->uid, needy, c.dist);
+        if (++got >= want) break;
     }
+    return got;
 }
 
 
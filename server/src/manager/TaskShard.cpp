@@ -0,0 +1,1342 @@
+#include "manager/TaskShard.h"
+#include "manager/TaskJournal.h"
+#include "manager/WorldManager.h"
+#include "session/AgvManager.h"
+#include "protocol/MsgType.h"
+#include "utils/Logger.h"
+#include "utils/MathUtils.h"
+#include <cmath>
+#include <algorithm>
+#include <unordered_set>
+#include <myreactor/ThreadPool.h>
+#include "algo/scheduler/GreedyScheduler.h"  // 默认实现
+
+namespace agv{
+namespace manager{
+
+using namespace model;
+
+namespace {
+// 全量模式派单窗口 : max(kMinDispatchWindow, 空闲车辆数 × kDispatchWindowFactor)
+constexpr size_t kMinDispatchWindow = 32;
+constexpr size_t kDispatchWindowFactor = 4;
+// 并单候选窗口
+constexpr size_t kBundleWindow = 64;
+// 单车同时下发到车上的任务数上限 : 执行中 1 + 预推送 1
+constexpr size_t kMaxSentPerAgv = 2;
+// 写者事件环的槽位数 : 环满时生产者自旋等待 (背压)
+constexpr size_t kEventRingSize = 4096;
+// 写者线程每批最多应用的事件数 : 事件持续涌入时也要按时发起调度轮次
+constexpr size_t kDrainBatch = 256;
+// 看门狗时间轮的 tick : 期限的精度，也是写者线程有执行中任务时的最长休眠
+constexpr int64_t kWatchdogTickMs = 500;
+// 任务日志的进度检查点间隔
+constexpr double kJournalProgressStep = 0.25;
+
+// 任务快照 : 交给 worker 的是副本，写者线程之后改原任务 (改优先级 / 回滚 / 上报) 不会与调度器的读并发
+std::shared_ptr<TaskContext> SnapshotTask(const std::shared_ptr<TaskContext>& task) {
+    return std::make_shared<TaskContext>(*task);
+}
+}
+
+/*
+一轮调度 : 快照由写者线程拍好，worker 只读; 决策写回 decisions 后以 ROUND_DONE 投回
+    tasks / deltas 里的任务都是副本 (SnapshotTask)，决策在 CommitDecisions 里按 taskId 找回原任务
+    超时的组合策略在轮次结束后仍可能读自己那份快照，原任务因此不能交出去
+*/
+struct TaskShard::Round {
+    std::shared_ptr<algo::scheduler::ITScheduler> sche;
+    bool incremental = false;
+    bool resync = false;                    // 增量模式 : tasks 为全量重放的待派任务
+    std::vector<spTaskContext> tasks;
+    std::vector<AgvInfo> agvs;
+    std::vector<char> occupied;             // 与 agvs 对齐 : 是否已有在途任务 (增量模式用)
+    std::vector<TaskDelta> deltas;
+    algo::scheduler::Backlog backlog;       // 全量模式 : 真实积压 (tasks 只是窗口)
+    std::vector<algo::scheduler::DispatchResult> decisions;
+};
+
+TaskShard::TaskShard(size_t index, TaskManager* owner) // 基类指针指向派生类对象
+    : index_(index),
+      owner_(owner),
+      events_(kEventRingSize),
+      watchdog_(kWatchdogTickMs),
+      scheduler_(std::make_shared<algo::scheduler::GreedyScheduler>()) {}
+
+// 写者线程启动前调用，之后参数只由写者线程读
+void TaskShard::Init(myreactor::ThreadPool* pool, const config::DispatchConfig& cfg) {
+    workerPool_ = pool;
+    inline_ = (pool == nullptr);
+    agingMs_ = cfg.agingMs > 0 ? cfg.agingMs : 1;
+    bundler_.SetParams(cfg.bundleSize, cfg.bundleDetour);
+    prefetchProgress_ = cfg.prefetchProgress;
+    predictHorizonMs_ = cfg.predictHorizonMs > 0 ? cfg.predictHorizonMs : 0;
+    nominalSpeed_ = cfg.nominalSpeed > 0.0 ? cfg.nominalSpeed : 1.0;
+    stallTimeoutMs_ = cfg.stallTimeoutMs > 0 ? cfg.stallTimeoutMs : 0;
+    minInterval_ = std::chrono::milliseconds(cfg.minIntervalMs > 0 ? cfg.minIntervalMs : 0);
+    batchSize_ = cfg.batchSize > 0 ? cfg.batchSize : 1;
+
+    if (!inline_) {
+        stop_.store(false, std::memory_order_release);
+        thread_ = std::make_unique<std::thread>(&TaskShard::RunLoop, this);
+    }
+}
+
+void TaskShard::Stop() {
+    if (stop_.exchange(true, std::memory_order_acq_rel)) return; // 重复停止 / 内联模式
+    {
+        // 写者线程可能正阻塞在 wait 上，必须叫醒它
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakeCond_.notify_one();
+    }
+    if (thread_ && thread_->joinable())
+        thread_->join();
+}
+
+void TaskShard::SetDispatchSink(TaskManager::DispatchSink sink) {
+    dispatchSink_ = std::move(sink);
+}
+
+bool TaskShard::RunPendingRound() {
+    if (!inline_) return false;
+    CheckStalled();
+    if (!roundDirty_.exchange(false, std::memory_order_acq_rel)) return false;
+    BeginRound();
+    Publish();
+    return true;
+}
+
+void TaskShard::SetScheduler(std::shared_ptr<algo::scheduler::ITScheduler> sche) {
+    // 写者线程还没启动 (或已停止) : 直接装上
+    if (!inline_ && stop_.load(std::memory_order_acquire)) {
+        scheduler_ = std::move(sche);
+        return;
+    }
+    Event ev;
+    ev.type = Event::Type::SET_SCHEDULER;
+    ev.scheduler = std::move(sche);
+    Post(std::move(ev));
+}
+
+// ================= 事件环 / 写者线程 =================
+
+void TaskShard::Post(Event&& ev) {
+    if (inline_) {
+        Apply(ev);
+        Publish();
+        return;
+    }
+    while (!events_.TryPush(ev)) {
+        if (stop_.load(std::memory_order_acquire)) return;  // 已停止 : 丢弃
+        Wake();
+        std::this_thread::yield();
+    }
+    Wake();
+}
+
+/*
+休眠 / 唤醒 (Dekker 式握手)
+    写者 : sleeping_ = true -> fence -> 再检查一遍环和脏标记 -> 都没有才 wait
+    生产者 : 入环 / 置脏 -> fence -> 看到 sleeping_ 才加锁 notify
+两边都有 seq_cst fence，至少一方能看到对方的写入 : 要么写者看到新事件不睡，要么生产者看到它在睡并叫醒
+写者忙的时候生产者只付出一次 fence + 一次原子读，不碰锁
+*/
+void TaskShard::Wake() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!sleeping_.load(std::memory_order_relaxed)) return;
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    wakeCond_.notify_one();
+}
+
+void TaskShard::Apply(Event& ev) {
+    switch (ev.type) {
+        case Event::Type::ADD_TASK:      ApplyAddTask(ev.task); break;
+        case Event::Type::ADD_TASKS:     ApplyAddTasks(ev.tasks); break;
+        case Event::Type::REPORT:        ApplyReport(ev.report); break;
+        case Event::Type::ACK:           ApplyAck(ev.agvId, ev.taskId, ev.ok, ev.reason); break;
+        case Event::Type::SET_PRIORITY:  ApplySetPriority(ev.taskId, ev.priority); break;
+        case Event::Type::ROUND_DONE:    FinishRound(*ev.round); break;
+        case Event::Type::SET_SCHEDULER: scheduler_ = std::move(ev.scheduler); break;
+    }
+}
+
+void TaskShard::Publish() {
+    pendingPub_.store(pendingTasks_.Size(), std::memory_order_relaxed);
+}
+
+/*
+写者线程主循环 (取代原来的 DispatchCoordinator 线程)
+    1. 排空事件环 : 按入环顺序逐个应用，每批有上限
+    2. 防抖 : 有脏标记、没有在途轮次，且距上一轮满 minInterval 或攒够 batchSize 个通知，才发起一轮
+       首个事件 (空闲期之后) 不会被人为延迟 : 上一轮早已超过 minInterval，立即触发
+    3. 无事可做时休眠，直到新事件 / 新通知 / 防抖到期
+*/
+void TaskShard::RunLoop() {
+    while (!stop_.load(std::memory_order_acquire)) {
+        size_t n = 0;
+        for (; n < kDrainBatch; ++n) {
+            Event ev;
+            if (!events_.TryPop(ev)) break;
+            Apply(ev);
+        }
+        CheckStalled();
+        if (n > 0) Publish();
+
+        bool waitDue = false;
+        std::chrono::steady_clock::time_point due{};
+        if (!inFlight_ && roundDirty_.load(std::memory_order_acquire)) {
+            auto now = std::chrono::steady_clock::now();
+            due = lastRound_ + minInterval_;
+            if (now >= due || dirtyEvents_.load(std::memory_order_relaxed) >= batchSize_) {
+                roundDirty_.store(false, std::memory_order_relaxed);
+                dirtyEvents_.store(0, std::memory_order_relaxed);
+                lastRound_ = now;
+                BeginRound();
+                Publish();
+                continue;
+            }
+            waitDue = true;
+        }
+        if (n > 0) continue;  // 环里可能还有
+
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ready = stop_.load(std::memory_order_relaxed) || !events_.Empty()
+                  || (!inFlight_ && roundDirty_.load(std::memory_order_relaxed)
+                      && (!waitDue || dirtyEvents_.load(std::memory_order_relaxed) >= batchSize_));
+        if (!ready) {
+            // 有执行中任务时每个 tick 至少醒一次，推进看门狗
+            if (!watchdog_.Empty()) {
+                auto tick = std::chrono::steady_clock::now() + std::chrono::milliseconds(kWatchdogTickMs);
+                if (!waitDue || tick < due) {
+                    due = tick;
+                    waitDue = true;
+                }
+            }
+            if (waitDue) wakeCond_.wait_until(lock, due);
+            else wakeCond_.wait(lock);
+        }
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+}
+
+/*
+优先级 + 老化 : 用一个“静态键”同时表达两者
+    rank = createTimeMs - priority × agingMs     (越小越先派)
+等价理解：高 1 级优先级 = 假装早来了 agingMs 毫秒
+    1. 热单插队：新来的高优先级任务 rank 直接落在队首附近，O(log n) 入堆即可，不用重扫积压
+    2. 防饿死：低优先级任务的 rank 不变，而后来者的 createTime 单调增大;
+       最多再过 (kMaxPriority - priority) × agingMs，任何新任务都排不到它前面了
+    3. 老化不需要定时器去“涨优先级”，因为时间本身已经编码进键里
+回滚的任务保留原 createTime，自然排回队首附近 (对应原来 push_front 的语义)
+*/
+int64_t TaskShard::ComputeRank(int priority, const myreactor::Timestamp& createTime) const {
+    return createTime.toMilliseconds() - static_cast<int64_t>(priority) * agingMs_;
+}
+
+void TaskShard::ApplyAck(int agvId, TaskHandle taskId, bool success, const std::string& failreason) {
+    if(success) {
+        if (TaskJournal* journal = owner_->Journal()) journal->Acked(taskId, agvId);
+        LOG_INFO("[RPC-ACK] Task %s dispatched to AGV %d confirmed.", taskId.ToText().c_str(), agvId);
+        return;
+    }
+
+    LOG_WARN("[RPC-FAIL] Task %s to AGV %d failed: %s. Rolling back...", taskId.ToText().c_str(), agvId, failreason.c_str());
+    size_t rolledBack = 0;
+    // RollBack
+    if (AgvTaskSeq* run = FindSeq(agvId)) {
+        AgvTaskSeq& seq = *run;
+        // 双重检查：防止 AGV 已经换了别的任务 ; 只在已下发的部分里找
+        for (size_t i = 0; i < seq.sent; ++i) {
+            if (seq.tasks[i]->req.taskId != taskId) continue;
+            // 该单及其后续全部退回 (后续单依赖它先完成)
+            rolledBack = RollbackFrom(seq, i, ReclaimReason::RPC_FAILED);
+            break;
+        }
+        if (seq.tasks.empty()) {
+            EraseSeq(agvId);
+            owner_->UnholdAgv(agvId);
+        }
+    }
+
+    if(rolledBack > 0){
+        TryDispatch();  // 退回的任务换车
+        LOG_WARN("[RPC-FAIL] Task %s to AGV %d failed. Rollback successful (%lu tasks back to pending)", taskId.ToText().c_str(), agvId, rolledBack); 
+    }else {
+        LOG_ERROR("Rollback failed: Task %s for AGV %d not found or mismatch.", taskId.ToText().c_str(), agvId);
+    }
+}
+
+// 下发一个任务 : 回调里带上 agvId / taskId 上下文 (见 CommitDecisions 中的说明)
+// 回调在 IO 线程触发，只投递 ACK 事件，由写者线程处理
+bool TaskShard::SendTask(int agvId, const spTaskContext& task) {
+    bool ok = false;
+    if (dispatchSink_) {
+        ok = dispatchSink_(agvId, task->req);
+    }
+    else if (auto sess = AgvMgr.GetSession(agvId)) {
+        auto callback = [this, agvId, taskId = task->req.taskId](bool success, const std::string& reason) {
+            Event ev;
+            ev.type = Event::Type::ACK;
+            ev.agvId = agvId;
+            ev.taskId = taskId;
+            ev.ok = success;
+            if (!success) ev.reason = reason;
+            this->Post(std::move(ev));
+        };
+        ok = sess->DispatchTask(task->req, callback);
+    }
+
+    if (ok) {
+        if (TaskJournal* journal = owner_->Journal()) journal->Dispatched(task->req.taskId, agvId);
+    }
+    return ok;
+}
+
+// 回滚 : 恢复下派前的状态，按原 rank 回堆 (自然排回队首附近)
+size_t TaskShard::RollbackFrom(AgvTaskSeq& seq, size_t idx, ReclaimReason reason) {
+    TaskJournal* journal = owner_->Journal();
+    size_t n = 0;
+    while (seq.tasks.size() > idx) {
+        spTaskContext task = seq.tasks.back();
+        seq.tasks.pop_back();
+        watchdog_.Cancel(task->req.taskId);
+
+        task->reclaimReason = reason;
+        ++task->reclaimCount;
+        if (journal) journal->RolledBack(task->req.taskId, static_cast<uint8_t>(reason));
+
+        task->req.targetAgvId = -1;  // -1 表示未分配
+        task->status = AgvStatus::IDLE;
+        task->progress = 0.0;
+        pendingTasks_.Push(task, task->rank);
+        taskDeltas_.push_back({task, true});
+        ++arrivals_;
+        ++n;
+    }
+    seq.sent = std::min(seq.sent, seq.tasks.size());
+    return n;
+}
+
+// 看门狗 : 时间轮空时先对齐时间起点，再定期限 (已有则挪到新期限)
+void TaskShard::ArmWatchdog(const spTaskContext& head, int agvId, int64_t nowMs) {
+    if (stallTimeoutMs_ <= 0) return;
+    if (watchdog_.Empty()) watchdog_.Advance(nowMs, stalled_);
+    watchdog_.Arm(head->req.taskId, agvId, nowMs + stallTimeoutMs_);
+}
+
+/*
+推进看门狗 (写者线程每轮循环 / 内联模式每次 RunPendingRound)
+    到期的首单 : 车在 stallTimeoutMs_ 内没有任何关于它的上报，整条序列按 STALLED 退回待派队列，
+    解除占用，下一轮调度换车。车之后再上报这些任务会因为对不上序列被忽略
+    取消漏掉的过期条目 (已不是这辆车的首单) 直接跳过
+*/
+void TaskShard::CheckStalled() {
+    if (watchdog_.Empty()) return;
+
+    int64_t now = myreactor::Timestamp::now().toMilliseconds();
+    stalled_.clear();
+    watchdog_.Advance(now, stalled_);
+    if (stalled_.empty()) return;
+
+    struct Stall {
+        TaskHandle taskId;
+        int agvId;
+        int64_t silentMs;
+        size_t reclaimed;
+    };
+    std::vector<Stall> stalls;
+    for (const auto& e : stalled_) {
+        AgvTaskSeq* seq = FindSeq(e.value);
+        if (seq == nullptr || seq->sent == 0 || seq->tasks.front()->req.taskId != e.key) continue;
+
+        int64_t silentMs = now - seq->tasks.front()->updateTime.toMilliseconds();
+        size_t n = RollbackFrom(*seq, 0, ReclaimReason::STALLED);
+        EraseSeq(e.value);
+        owner_->UnholdAgv(e.value);
+        stalls.push_back({e.key, e.value, silentMs, n});
+    }
+    if (stalls.empty()) return;
+
+    for (const auto& s : stalls) {
+        LOG_WARN("[Watchdog] Task %s on AGV %d made no progress for %lldms. Reclaimed %lu tasks (reason=%s).",
+                 s.taskId.ToText().c_str(), s.agvId, static_cast<long long>(s.silentMs), s.reclaimed,
+                 ReclaimReasonName(ReclaimReason::STALLED));
+    }
+    TryDispatch();
+}
+
+// 任务序列 : 槽位下标 + 代数校验
+TaskShard::AgvTaskSeq* TaskShard::FindSeq(int agvId) {
+    AgvSlot slot = SlotTbl.Find(agvId);
+    if (!slot.Valid() || slot.index >= runningTasks_.size()) return nullptr;
+    SeqEntry& entry = runningTasks_[slot.index];
+    return (entry.active && entry.slot == slot) ? &entry.seq : nullptr;
+}
+
+TaskShard::AgvTaskSeq& TaskShard::EmplaceSeq(AgvSlot slot) {
+    if (slot.index >= runningTasks_.size()) runningTasks_.resize(slot.index + 1);
+    SeqEntry& entry = runningTasks_[slot.index];
+    if (!entry.active || entry.slot != slot) {
+        entry.slot = slot;
+        entry.active = true;
+        entry.seq = AgvTaskSeq{};
+    }
+    return entry.seq;
+}
+
+void TaskShard::EraseSeq(int agvId) {
+    AgvSlot slot = SlotTbl.Find(agvId);
+    if (!slot.Valid() || slot.index >= runningTasks_.size()) return;
+    SeqEntry& entry = runningTasks_[slot.index];
+    if (entry.slot != slot) return;
+    entry.active = false;
+    entry.seq = AgvTaskSeq{};
+}
+
+/*
+预测派单 (ETA)
+    忙车只有在 “只剩最后一单且已下发” 时才有可能被预测 : 空闲点 = 该单目标点
+    剩余格数优先用规划路径长度 × (1 - 进度)，没有路径信息时退化为到目标点的曼哈顿距离
+    速度优先用观测值，还没观测到时用标称速度
+    预计在 horizon 内空闲的车改写为 IDLE 候选，etaCells 让调度器把 “还要多走的路” 计入代价
+*/
+size_t TaskShard::PredictFreeAgvs(std::vector<AgvInfo>& agvs) {
+    size_t n = 0;
+    for (auto& agv : agvs) {
+        if (agv.status != AgvStatus::MOVING || agv.battery < 20.0) continue;
+
+        const AgvTaskSeq* run = FindSeq(agv.uid);
+        if (run == nullptr) continue;
+        const AgvTaskSeq& seq = *run;
+        if (seq.tasks.size() != 1 || seq.sent != 1) continue;
+
+        const spTaskContext& head = seq.tasks.front();
+        if (agv.currentTaskId != head->req.taskId) continue;  // 车上还没切到这一单
+
+        double remain = agv.pathLen > 0 ? (1.0 - agv.taskProgress) * agv.pathLen
+                                        : static_cast<double>(CalMhtDis(agv.currentPos, head->req.targetPos));
+        int cells = std::max(0, static_cast<int>(std::ceil(remain)));
+        double speed = agv.speed > 0 ? agv.speed : nominalSpeed_;
+        double etaMs = cells / speed * 1000.0;
+        if (etaMs > static_cast<double>(predictHorizonMs_)) continue;
+
+        agv.currentPos = head->req.targetPos;
+        agv.etaCells = cells;
+        agv.status = AgvStatus::IDLE;
+        predictedAgvs_.insert(agv.uid);
+        ++n;
+    }
+    return n;
+}
+
+// ================= 投递接口 (任意线程) =================
+
+void TaskShard::AddTask(const spTaskContext& task) {
+    Event ev;
+    ev.type = Event::Type::ADD_TASK;
+    ev.task = task;
+    Post(std::move(ev));
+}
+
+void TaskShard::AddTasks(std::vector<spTaskContext>&& tasks) {
+    Event ev;
+    ev.type = Event::Type::ADD_TASKS;
+    ev.tasks = std::move(tasks);
+    Post(std::move(ev));
+}
+
+void TaskShard::SetTaskPriority(TaskHandle taskId, int priority) {
+    Event ev;
+    ev.type = Event::Type::SET_PRIORITY;
+    ev.taskId = taskId;
+    ev.priority = priority;
+    Post(std::move(ev));
+}
+
+void TaskShard::OnTaskReport(const TaskReport& msg) {
+    Event ev;
+    ev.type = Event::Type::REPORT;
+    ev.report = msg;
+    Post(std::move(ev));
+}
+
+// ================= 写者线程 =================
+
+void TaskShard::Enqueue(const spTaskContext& task) {
+    // 入队 O(log n)
+    int64_t rank = ComputeRank(task->req.priority, task->createTime);
+    task->rank = rank;
+    pendingTasks_.Push(task, rank);
+    taskDeltas_.push_back({task, false});
+    ++arrivals_;
+}
+
+void TaskShard::ApplyAddTask(const spTaskContext& task) {
+    Enqueue(task);
+
+    // 尝试立即调度
+    TryDispatch();
+}
+
+void TaskShard::ApplyAddTasks(const std::vector<spTaskContext>& tasks) {
+    for (const auto& task : tasks) Enqueue(task);
+
+    // 整批只通知一次
+    if (!tasks.empty()) TryDispatch();
+}
+
+void TaskShard::ApplySetPriority(TaskHandle taskId, int priority) {
+    spTaskContext task = pendingTasks_.Find(taskId);
+    if (!task) {  // 已派出 / 不存在
+        LOG_WARN("[TaskManager] Task %s is not pending, priority unchanged.", taskId.ToText().c_str());
+        return;
+    }
+
+    int oldPriority = task->req.priority;
+    if (oldPriority == priority) return;
+
+    int64_t rank = ComputeRank(priority, task->createTime);
+    task->req.priority = priority;
+    task->rank = rank;
+    pendingTasks_.Update(taskId, rank);  // O(log n) 就地上浮/下沉
+    if (TaskJournal* journal = owner_->Journal()) journal->Priority(taskId, priority);
+
+    // 增量调度器 : 先移出再按新键放回
+    taskDeltas_.push_back({task, false, true});
+    taskDeltas_.push_back({task, false});
+    LOG_INFO("[TaskManager] Task %s priority changed: %d -> %d", taskId.ToText().c_str(), oldPriority, priority);
+
+    // 提升后可能进入派单窗口
+    TryDispatch();
+}
+
+
+
+
+void TaskShard::ProcessLogs_TD(const std::vector<DeferredLog>& logs) {
+    for (const auto& log : logs) {
+        switch (log.action) {
+            case LogAction::DISPATCH_SUCCESS:
+                LOG_INFO("[TaskManager] Dispatch Success: Task=%s -> AGV=%d (Dist=%d)", log.taskId.ToText().c_str(), log.agvId, log.extraVal);
+                break;
+
+            case LogAction::DOUBLE_CHECK_FAILED:
+                LOG_WARN("[TaskManager] Dispatch Skipped: AGV %d status changed to %d during double check. Task=%s", log.agvId, log.extraVal, log.taskId.ToText().c_str());
+                break;
+
+            case LogAction::SESSION_LOST:
+                LOG_WARN("[TaskManager] Dispatch Failed: Session lost for AGV %d. Rolling back Task=%s", log.agvId, log.taskId.ToText().c_str());
+                break;
+
+            case LogAction::DISPATCH_FAILED:
+            LOG_ERROR("[TaskManager] Dispatch failed for unknown reason: AGV %d , Task=%s", log.agvId, log.taskId.ToText().c_str());
+                break; 
+
+            case LogAction::PRE_ASSIGNED:
+                LOG_INFO("[TaskManager] Pre-assigned: Task=%s -> AGV=%d (queued behind current task, Dist=%d)", log.taskId.ToText().c_str(), log.agvId, log.extraVal);
+                break;
+
+            case LogAction::BUNDLE_PLANNED:
+                LOG_INFO("[TaskManager] Bundle Planned: AGV=%d, Head=%s, +%d follow-up tasks", log.agvId, log.taskId.ToText().c_str(), log.extraVal);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/*
+TryDispatch 只负责“通知”
+    旧实现每次调用都拷贝全量快照并投递一轮，突发 N 个事件 = N 轮全量调度；
+    现在只置脏标记，由写者线程合并：等待期间 / 上一轮执行期间到达的事件统一折叠进下一轮
+*/
+void TaskShard::TryDispatch() {
+    roundDirty_.store(true, std::memory_order_release);
+    if (inline_) return;
+
+    // 只在可能改变写者决策时唤醒：首个通知 (从空闲等待中唤醒) 或 攒够一批 (提前结束防抖)
+    int n = dirtyEvents_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (n == 1 || n >= batchSize_) Wake();
+}
+
+// 【写者线程】快照在轮次开始时才拍，保证拿到最新状态
+void TaskShard::BeginRound() {
+    // 1. 获取观测世界快照 (共享已发布的快照，不拷贝)，只挑出归属本分片的车 (预测派单会改写，这部分要拷)
+    spFleetSnapshot snap = WorldMgr.GetFleetSnapshot();
+    const std::vector<AgvInfo>& fleet = snap->agvs;
+    std::vector<AgvInfo> onlineAgvs;
+    owner_->CollectOwned(index_, fleet, onlineAgvs);
+
+    // 1.5 跨区均衡 : 待派任务多于本区可派车时，向有富余空闲车的分片借车
+    if (owner_->ShardCount() > 1) {
+        size_t pending = pendingTasks_.Size(), idle = 0;
+        Point head{};
+        if (pending > 0) head = pendingTasks_.Top()->req.targetPos;
+        for (const auto& agv : onlineAgvs)
+            if (agv.status == AgvStatus::IDLE && agv.battery >= 20.0 && FindSeq(agv.uid) == nullptr) ++idle;
+        if (pending > idle && owner_->BorrowAgvs(index_, pending - idle, head, fleet) > 0) {
+            onlineAgvs.clear();
+            owner_->CollectOwned(index_, fleet, onlineAgvs);
+        }
+    }
+
+    // 2. 任务快照 + 策略快照
+    // 任务只拷调度需要的那一小段 (窗口 / 增量)，见 SnapshotTask
+    auto round = std::make_shared<Round>();
+    std::vector<spTaskContext>& taskInput = round->tasks;
+    std::vector<TaskDelta>& deltas = round->deltas;
+    std::vector<char>& occupied = round->occupied;
+    std::shared_ptr<algo::scheduler::ITScheduler>& currentScheduler = round->sche;
+    bool& incremental = round->incremental;
+    bool& resync = round->resync;
+    {
+
+        /*
+        单例的稳定性 vs 组件的动态性
+            WorldManager 作为单例，其自身的内存生命周期贯穿整个进程，是稳定的‘容器’。但它持有的组件（如 planner_）是动态的，允许在运行时被替换（Replaced）
+        指针快照（Snapshot）机制
+            “我们在执行计算时，利用 shared_ptr 的引用计数机制建立了一个**‘局部快照’。 currentPlanner = planner_; 这一行代码，让局部变量也持有了策略对象的引用（引用计数 +1）。这就相当于给当前的策略对象买了一份‘临时保险’**。”
+        生命周期延长（Life Extension）
+            “此时，即使其他线程调用 SetPlanner 修改了成员变量 planner_ 的指向（让它指向新算法），旧的算法对象也不会被销毁。 因为我们的局部快照依然持有它。直到当前计算函数结束，局部变量离开作用域，旧对象的引用计数归零，它才会真正析构。这完美实现了无锁且安全的算法热切换。”
+        */
+        // 把调度策略指针也拷贝一份，且引用技计数+1，保活到任务当前调度结束 (期间可能被 SET_SCHEDULER 替换)
+        currentScheduler = scheduler_;
+
+        // 任务增量 : 无论哪种模式都要取走，避免堆积
+        deltas.swap(taskDeltas_);
+
+        // 预测派单 : 快做完的忙车在快照里改写成候选
+        predictedAgvs_.clear();
+        if (predictHorizonMs_ > 0) PredictFreeAgvs(onlineAgvs);
+
+        incremental = currentScheduler && currentScheduler->SupportsIncremental();
+        if (incremental) {
+            // 调度器换过 (或首次) : 需要全量重放一次
+            resync = (currentScheduler != syncedScheduler_);
+            if (resync) {
+                pendingTasks_.TopN(pendingTasks_.Size(), taskInput);
+            }
+            // 逻辑占用 : 只有写者线程能看 runningTasks_
+            occupied.resize(onlineAgvs.size());
+            for (size_t i = 0; i < onlineAgvs.size(); ++i)
+                occupied[i] = FindSeq(onlineAgvs[i].uid) != nullptr && predictedAgvs_.count(onlineAgvs[i].uid) == 0;
+        }
+        else {
+            if (pendingTasks_.Empty()) return;
+            /*
+            派单窗口 : 一轮最多派出 “空闲车辆数” 个任务，只把队首一个窗口交给调度器即可
+            窗口放宽到空闲车的若干倍，给调度器留出按距离挑选的余地; 与积压总量无关
+            */
+            size_t idle = 0;
+            for (const auto& agv : onlineAgvs)
+                if (agv.status == AgvStatus::IDLE && agv.battery >= 20.0) ++idle;
+            size_t window = std::max(kMinDispatchWindow, idle * kDispatchWindowFactor);
+            pendingTasks_.TopN(window, taskInput);
+        }
+    }
+
+    // 万一还没设置算法
+    if(!currentScheduler) return;
+
+    if (!incremental) {
+        syncedScheduler_.reset(); // 全量模式不维护增量状态，下次切回增量时重新同步
+        if (onlineAgvs.empty()) return;
+    }
+    round->agvs = std::move(onlineAgvs);
+    // 积压 : 这一轮确实发出去才清零到达计数，提前返回的轮次留给下一轮
+    round->backlog = {pendingTasks_.Size(), arrivals_};
+    arrivals_ = 0;
+    for (auto& t : taskInput) t = SnapshotTask(t);
+    for (auto& d : deltas) d.task = SnapshotTask(d.task);
+
+    // 3. 计算 : 内联模式就地算完落地; 否则投给 worker，结果以 ROUND_DONE 回来 (同一时刻只有一轮在途)
+    if (inline_) {
+        ComputeRound(*round);
+        FinishRound(*round);
+        return;
+    }
+    inFlight_ = true;
+    workerPool_->addtask([this, round]() {
+        try {
+            ComputeRound(*round);
+        } catch (const std::exception& e) {
+            LOG_ERROR("[TaskManager] Zone %lu dispatch round failed: %s", index_, e.what());
+            round->decisions.clear();
+        }
+        Event ev;
+        ev.type = Event::Type::ROUND_DONE;
+        ev.round = round;
+        Post(std::move(ev));  // 无论成败都要回去清在途标记
+    });
+}
+
+// 【Worker 线程】
+void TaskShard::ComputeRound(Round& round) {
+    if (round.incremental) {
+        round.decisions = ExecuteIncremental(round.sche, round.agvs, round.occupied, round.deltas,
+                                             round.resync ? &round.tasks : nullptr);
+    }
+    else {
+        round.decisions = ExecuteDispatch(round.tasks, round.agvs, round.backlog, round.sche);
+    }
+}
+
+// 【写者线程】ROUND_DONE
+void TaskShard::FinishRound(Round& round) {
+    inFlight_ = false;
+    if (round.decisions.empty()) return;
+
+    if (!round.incremental) {
+        CommitDecisions(round.decisions, nullptr, nullptr);
+        return;
+    }
+
+    // 增量模式 : 执行 + 反馈 ; 派出去的移出待派集合; 派不出去的车本轮视为不可派，等下一次差分再放回
+    // 这一轮已结束、下一轮还没开始，调度器与 agvView_ 此时只有写者线程在碰
+    const auto& sche = round.sche;
+    std::vector<algo::scheduler::DispatchResult> committed;
+    std::vector<int> rejectedAgvs;
+    CommitDecisions(round.decisions, &committed, &rejectedAgvs);
+
+    for (const auto& dec : committed) {
+        sche->OnTaskRemoved(dec.task->req.taskId);
+        for (const auto& f : dec.followUps) sche->OnTaskRemoved(f->req.taskId);
+        sche->OnAgvBusy(dec.agvId);
+        agvView_[dec.agvId].available = false;
+    }
+    for (int agvId : rejectedAgvs) {
+        sche->OnAgvBusy(agvId);
+        agvView_[agvId].available = false;
+    }
+}
+
+/*
+增量调度 【Worker 线程】
+    任务侧 delta : 由 AddTask / 回滚 在写者线程记录，精确 O(1)
+    车辆侧 delta : 与上一轮的可派视图 agvView_ 做差分 (线性扫描，只做比较，不做调度计算)
+调度器只在有变化的集合上工作，没有车空出时一轮几乎零开销
+*/
+std::vector<algo::scheduler::DispatchResult> TaskShard::ExecuteIncremental(
+    const std::shared_ptr<algo::scheduler::ITScheduler>& sche,
+    const std::vector<model::AgvInfo>& agvsSnapst,
+    const std::vector<char>& occupied,
+    const std::vector<TaskDelta>& deltas,
+    const std::vector<spTaskContext>* resyncTasks)
+{
+    // 1. 任务侧
+    if (resyncTasks) {
+        sche->Reset();
+        agvView_.clear();
+        for (const auto& t : *resyncTasks) sche->OnTaskAdded(t, false);
+        syncedScheduler_ = sche;
+        LOG_INFO("[TaskManager] Incremental scheduler %s synced: %lu pending tasks", sche->Name().c_str(), resyncTasks->size());
+    }
+    else {
+        for (const auto& d : deltas) {
+            if (d.removed) sche->OnTaskRemoved(d.task->req.taskId);
+            else sche->OnTaskAdded(d.task, d.requeue);
+        }
+    }
+
+    // 2. 车辆侧差分
+    ++viewEpoch_;
+    for (size_t i = 0; i < agvsSnapst.size(); ++i) {
+        const AgvInfo& agv = agvsSnapst[i];
+        bool avail = agv.status == AgvStatus::IDLE && agv.battery >= 20.0 && !occupied[i];
+
+        AgvView& v = agvView_[agv.uid];
+        v.epoch = viewEpoch_;
+        if (avail && (!v.available || v.etaCells != agv.etaCells)) {
+            sche->OnAgvFreed(agv);  // 新空出 / 预测的剩余量变了 : 整条更新
+        }
+        else if (!avail && v.available) {
+            sche->OnAgvBusy(agv.uid);
+        }
+        else if (avail && !(v.pos == agv.currentPos)) {
+            sche->OnAgvMoved(agv.uid, agv.currentPos);
+        }
+        v.available = avail;
+        v.pos = agv.currentPos;
+        v.etaCells = agv.etaCells;
+    }
+    // 本轮快照里消失的车 (已下线)
+    for (auto it = agvView_.begin(); it != agvView_.end(); ) {
+        if (it->second.epoch != viewEpoch_) {
+            if (it->second.available) sche->OnAgvBusy(it->first);
+            it = agvView_.erase(it);
+        }
+        else ++it;
+    }
+
+    // 3. 调度 (执行 + 反馈见 FinishRound)
+    auto decisions = sche->DispatchIncremental();
+    if (!decisions.empty()) {
+        LOG_INFO("[TaskManager] Incremental dispatch: %lu task deltas, %lu decisions", deltas.size(), decisions.size());
+    }
+    return decisions;
+}
+
+// 【Worker 线程】
+std::vector<algo::scheduler::DispatchResult> TaskShard::ExecuteDispatch(
+    const std::vector<spTaskContext>& tasksSnapst,
+    const std::vector<model::AgvInfo>& agvsSnapst,
+    const algo::scheduler::Backlog& backlog,
+    const std::shared_ptr<algo::scheduler::ITScheduler>& currSche) 
+{
+        // ---------------- 数据准备 ----------------
+      
+        // 可用的车辆列表 ：从备选列表筛选
+        std::vector<AgvInfo> candiAgvs;
+        candiAgvs.reserve(agvsSnapst.size());
+
+        for (const auto& agv : agvsSnapst) {
+        // 物理状态
+            // 1.必须空闲
+            if (agv.status != AgvStatus::IDLE) continue;
+            // 2.有电
+            if (agv.battery < 20.0) continue;
+        // 逻辑状态
+            // 3.占用检测，worker 线程不能访问 runningTasks_，在决策落地时由写者线程检查
+            // if (runningTasks_.find(agv.uid)!=runningTasks_.end()) continue;
+
+            candiAgvs.push_back(agv);
+        }
+
+        if (candiAgvs.empty()) {
+            LOG_WARN("[TaskManager] No candidate AGVs available for dispatch. Total AGVs: %lu", agvsSnapst.size());
+            return {};
+        }
+
+        // 待调度的任务列表 : pendingTasks 里面的全部被存入 快照， 只要在等待队列里的，都需要执行，无需筛选
+
+        // ---------------- 核心调度 ----------------
+        // 调用调度算法
+        LOG_INFO("[TaskManager] Dispatching: %lu tasks (%lu pending), %lu candidate AGVs", tasksSnapst.size(), backlog.pending, candiAgvs.size());
+        auto decisions = currSche->Dispatch(tasksSnapst, candiAgvs, backlog);
+        LOG_INFO("[TaskManager] Scheduler returned %lu decisions", decisions.size());
+
+        // ---------------- 执行决策 (写者线程，见 FinishRound) ----------------
+        return decisions;
+}
+
+// 【写者线程】决策落地 : Double Check + 网络下发 + 入 runningTasks_
+// committed / rejectedAgvs 可为空，增量模式用来回馈调度器
+void TaskShard::CommitDecisions(
+    const std::vector<algo::scheduler::DispatchResult>& decisions,
+    std::vector<algo::scheduler::DispatchResult>* committed,
+    std::vector<int>* rejectedAgvs)
+{
+        std::vector<DeferredLog> logs;
+        logs.reserve(16); // 预估容量,减少扩容开销
+
+        // 本轮决策里的首单不能被别的车并走
+        std::unordered_set<TaskHandle> decided;
+        if (bundler_.Enabled()) {
+            for (const auto& dec : decisions) decided.insert(dec.task->req.taskId);
+        }
+        auto usable = [&decided](const spTaskContext& t) {
+            return t->req.targetAgvId == -1 && decided.count(t->req.taskId) == 0;
+        };
+        
+    {
+        // 并单候选窗口 : 优先队列队首的一小段
+        std::vector<spTaskContext> bundlePool;
+        if (bundler_.Enabled() && !decisions.empty()) {
+            pendingTasks_.TopN(kBundleWindow, bundlePool);
+        }
+
+        // 【3. 并单】调度器给了就用调度器的，否则插入启发式补全; 后续单先占住，不下发，等预推送
+        // 正常派单与预分配共用 : 串在 dec.task 之后
+        // 调度器给的是快照 : 后续单按 taskId 找回原任务
+        auto appendBundle = [&](int agvId, AgvTaskSeq& seq, const spTaskContext& head, const algo::scheduler::DispatchResult& dec) {
+            std::vector<spTaskContext> followUps;
+            for (const auto& f : dec.followUps) {
+                spTaskContext live = pendingTasks_.Find(f->req.taskId);
+                if (live && usable(live)) followUps.push_back(live);
+            }
+            if (dec.followUps.empty())
+                followUps = bundler_.Build(head, bundlePool, usable);
+
+            for (const auto& f : followUps) {
+                f->req.targetAgvId = agvId;
+                seq.tasks.push_back(f);
+                pendingTasks_.Remove(f->req.taskId);
+            }
+            if (!followUps.empty())
+                logs.push_back({LogAction::BUNDLE_PLANNED, dec.task->req.taskId, agvId, (int)followUps.size()});
+
+            if (committed) {
+                committed->push_back(dec);
+                committed->back().followUps = std::move(followUps);
+            }
+        };
+
+        for (const auto& dec : decisions) {
+            // 原任务 : 计算期间已离开待派队列 (被派出 / 并走) 则为空
+            spTaskContext task = pendingTasks_.Find(dec.task->req.taskId);
+            int agvId = dec.agvId;
+
+            // 【0. 预测候选 : 预分配】车还在做最后一单，本单排到它后面，不下发;
+            // 等车完成 (或进度过预推送阈值) 时由 OnTaskReport 推送。期间车已空出 (序列已清) 则按普通派单处理
+            if (predictedAgvs_.count(agvId) > 0) {
+                if (AgvTaskSeq* run = FindSeq(agvId)) {
+                    if (run->tasks.size() != 1 || !task || task->req.targetAgvId != -1) {
+                        if (rejectedAgvs) rejectedAgvs->push_back(agvId);
+                        continue;
+                    }
+                    task->req.targetAgvId = agvId;
+                    run->tasks.push_back(task);
+                    pendingTasks_.Remove(task->req.taskId);
+                    logs.push_back({LogAction::PRE_ASSIGNED, task->req.taskId, agvId, dec.Distance});
+                    appendBundle(agvId, *run, task, dec);
+                    continue;
+                }
+            }
+
+            // 【1.Double Check : 车辆状态检测】
+            // 物理状态 
+            /*
+            状态 (IDLE -> BUSY)：这是 瞬态变化。前 1 毫秒是空闲，后 1 毫秒可能就被另一个线程或者心跳包置为 BUSY。如果不检查，会撞车（逻辑撞车）。必须检查！
+            电量 (20.0V -> 19.99V)：这是 缓变物理量;即使掉了一点电，也不会导致逻辑错误（只是车稍微亏电一点去干活了） 【工程取舍】
+            */
+            auto currentStatus = WorldMgr.GetAgvStatus(agvId);
+            if (currentStatus != AgvStatus::IDLE) {
+                logs.push_back({LogAction::DOUBLE_CHECK_FAILED, dec.task->req.taskId, agvId, (int)currentStatus});
+                if (rejectedAgvs) rejectedAgvs->push_back(agvId);
+                continue;
+            }
+            // 逻辑状态（占用状态）
+            if (FindSeq(agvId) != nullptr) {  // 算完做一次总的占用检测
+                if (rejectedAgvs) rejectedAgvs->push_back(agvId);
+                continue;
+            }
+
+            // 【2. 任务状态检测】
+            // 在 worker 计算期间，任务的状态发生变化了
+            // 任务本身是否被分配
+            if (!task || task->req.targetAgvId != -1) continue;
+            
+            
+            // 网络下发
+            //定义回调
+            /* Lambda 是 C++ 中连接 异步操作 和 上下文保持 的最强胶水。
+                    捕获列表，捕获的的就是上下文，而参数列表式就是对外提供的参数表现，lambda函数内部既可以是自己现场定义的，也可以调用别的已经写好的函数
+            Lambda 的一个作用是“调整参数列表”，但这只是表象。
+            它在底层的核心作用是：“携带上下文（Context Capture）”。
+            */
+            /*
+            Session 定义的回调接口 (RpcCallback)： Session 是底层通用的，它根本不知道什么是 taskId，也不知道现在的 agvId 是多少。它只管通信结果。
+                // Session 只提供两个参数：结果好坏、原因
+                using RpcCallback = std::function<void(bool success, string reason)>;
+            TaskManager 真正需要的处理函数 (ApplyAck)： TaskManager 想要回滚任务，它必须知道：是哪辆车、哪个任务失败了。
+                // TaskManager 需要四个参数 ; 回调只把它们打包成 ACK 事件投回写者线程
+                void ApplyAck(int agvId, TaskHandle taskId, bool success, string reason);
+            */
+            // 回调的构造见 SendTask
+
+            // sess 检查
+            if (!dispatchSink_ && AgvMgr.GetSession(agvId) == nullptr) { // Session 丢失
+                logs.push_back({LogAction::SESSION_LOST, dec.task->req.taskId, agvId, 0});
+                if (rejectedAgvs) rejectedAgvs->push_back(agvId);
+                continue;
+            }
+
+            // 槽位 : 序列按槽位存放，车已下线且槽位被回收给别的车则放弃
+            AgvSlot slot = SlotTbl.Find(agvId);
+            if (!slot.Valid()) {
+                if (rejectedAgvs) rejectedAgvs->push_back(agvId);
+                continue;
+            }
+
+            // 【归属 : 占住车辆】计算期间这辆车可能已被借走; 占住之后别的分片借不走，直到序列做完
+            if (!owner_->HoldAgv(index_, agvId)) {
+                if (rejectedAgvs) rejectedAgvs->push_back(agvId);
+                continue;
+            }
+
+            // sess->Send(protocol::MsgType::TASK_REQUEST, task->req);
+            // 调用业务接口
+            bool isSend = SendTask(agvId, task);
+            if (!isSend) {
+                owner_->UnholdAgv(agvId);
+                logs.push_back({LogAction::DISPATCH_FAILED, task->req.taskId, agvId, 0});
+                if (rejectedAgvs) rejectedAgvs->push_back(agvId);
+                continue;
+            }
+
+            // 下发成功入队 (Send内部丢给IO线程了)
+            /*
+            一致性保障：runningTasks_[bestAgvId] = task; 这一行就是核心。在网络包到达前，先在内存里占住了坑位。即使网络发送慢了，下一轮循环也不会把这辆车派给别人。
+            */
+            task->req.targetAgvId = agvId; // 更新 task 状态
+            AgvTaskSeq& seq = EmplaceSeq(slot);
+            seq.tasks.assign(1, task);
+            seq.sent = 1;
+            ArmWatchdog(task, agvId, myreactor::Timestamp::now().toMilliseconds());
+            pendingTasks_.Remove(task->req.taskId); // 按 ID 出堆 O(log n)，替代原来整表 remove_if
+            logs.push_back({LogAction::DISPATCH_SUCCESS, task->req.taskId, agvId, dec.Distance});
+
+            appendBundle(agvId, seq, task, dec);
+        }
+
+    }
+
+    // 落地完成后统一打印
+    ProcessLogs_TD(logs);
+
+}
+
+/*
+std::list::remove_if 是 C++ 双向链表 std::list 的成员函数，用于批量删除链表中所有满足自定义条件的元素，直接在原链表上修改，无需额外内存。
+    template <class Predicate>
+        void remove_if (Predicate pred);
+    参数为可调用谓词， O(N)  ; 谓词 lambda 表达式的 参数为 list中单个元素的代表，保证与list原色类型一致
+*/
+
+/*
+范围 for 是 “简洁遍历的语法糖”，设计目标是 “只读 / 修改元素内容”；而代码需要 “遍历中修改容器（删元素）+ 精准控制迭代器”，这超出了范围 for 的能力边界；需要用 显式迭代器遍历
+*/
+
+/*void TaskManager::TryDispatch() {
+    // 【Snapshot : 快照】 : 备选车辆列表
+    auto onlineAgvs = WorldMgr.GetAllAgvs();
+    if(onlineAgvs.empty()) return;
+
+    // 锁外准备日志容器
+    std::vector<DeferredLog> logs;
+    logs.reserve(16); // 预估容量,减少扩容开销
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if(pendingTasks_.empty()) return;
+        
+        // ---------------- 数据准备 ----------------
+        // 待调度任务列表 list -> vector ：指针拷贝, O(N)
+        std::vector<spTaskContext> taskInput;
+        taskInput.reserve(pendingTasks_.size()); // reserve 避免 push_back 时的多次内存重分配
+        for (const auto& t : pendingTasks_) taskInput.push_back(t);  
+
+        // 可用的车辆列表 ：从备选列表筛选
+        std::vector<AgvInfo> candiAgvs;
+        candiAgvs.reserve(onlineAgvs.size());
+
+        for (const auto& agv : onlineAgvs) {
+            // 1.必须空闲
+            if (agv.status != AgvStatus::IDLE) continue;
+            // 2.有电
+            if (agv.battery < 20.0) continue;
+            // 3.占用检测
+            if (runningTasks_.find(agv.uid)!=runningTasks_.end()) continue;
+
+            candiAgvs.push_back(agv);
+        }
+
+        if (candiAgvs.empty()) return;
+
+        // ---------------- 核心调度 ----------------
+        // 调用调度算法
+        auto decisions = scheduler_->Dispatch(taskInput, candiAgvs);
+
+        // ---------------- 执行决策 ----------------
+        bool hasAssignment = false; // 【优化标记】, 以便 pendingTasks链表批量清除
+
+        for (const auto& dec : decisions) {
+            auto task = dec.task;
+            int agvId = dec.agvId;
+            
+            // 【1.Double Check : 再确认物理状态】
+            auto currentStatus = WorldMgr.GetAgvStatus(agvId);
+            if (currentStatus != AgvStatus::IDLE) {
+                logs.push_back({LogAction::DOUBLE_CHECK_FAILED, task->req.taskId, agvId, (int)currentStatus});
+                continue;
+            }
+
+            // 工作队列检测
+            // GreedyScheduler 内部已经保证了不重复分配(决策意图限制)
+            // AI算法内部写复杂的解码逻辑来去重，或者 ：
+            // if (runningTasks_.count(agvId) > 0) continue; 
+            
+            // 网络下发
+            auto sess = AgvMgr.GetSession(agvId);
+            if (sess == nullptr) { // Session 丢失
+                logs.push_back({LogAction::SESSION_LOST, task->req.taskId, agvId, 0});
+                continue;
+            }
+            
+            sess->Send(protocol::MsgType::TASK_REQUEST, task->req);
+
+            // 下发成功入队 
+            task->req.targetAgvId = agvId; // 更新 task 状态
+            runningTasks_[agvId] = task;
+            logs.push_back({LogAction::DISPATCH_SUCCESS, task->req.taskId, agvId, dec.Distance});
+            
+            hasAssignment = true;
+        }
+
+        // ---------------- 批量清理 ----------------
+        // pendingTask 是 list , 无键，利用 结点信息 [task 状态是否更新] 判断是否要清除 remove_if
+--------------------------------------------------------------------------------  
+--------------------------------------------------------------------------------
+std::list::remove_if 是 C++ 双向链表 std::list 的成员函数，用于批量删除链表中所有满足自定义条件的元素，直接在原链表上修改，无需额外内存。
+    template <class Predicate>
+        void remove_if (Predicate pred);
+    参数为可调用谓词， O(N)  ; 谓词 lambda 表达式的 参数为 list中单个元素的代表，保证与list原色类型一致
+--------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+        
+        if (hasAssignment) {
+            pendingTasks_.remove_if([](const spTaskContext& t) {
+                return t->req.targetAgvId != -1; // 更新过的都要清掉
+            });
+        }
+        
+    }
+
+    // 锁外打印日志
+    ProcessLogs_TD(logs);
+
+}*/
+
+/*void TaskManager::TryDispatch() {
+    // 【Snapshot : 快照筛选】
+    auto onlineAgvs = WorldMgr.GetAllAgvs();
+
+    // 锁外准备日志容器
+    std::vector<DeferredLog> logs;
+    logs.reserve(16); // 预估容量,减少扩容开销
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if(pendingTasks_.empty()) return;
+        if(onlineAgvs.empty()) return;
+
+        // 遍历等待任务
+        for (auto it = pendingTasks_.begin(); it != pendingTasks_.end(); ) { // 
+            auto task = *it;
+
+            int bestAgvId = -1;
+
+            // ---------- 调度算法 ----------
+            int minDistance = 9999999;
+
+            for (const auto& agv : onlineAgvs) {
+                // 1.必须空闲
+                if (agv.status != AgvStatus::IDLE) continue;
+                // 2.有电
+                if (agv.battery < 20.0) continue;
+                // 3.决策意图检查
+                if (runningTasks_.find(agv.uid)!=runningTasks_.end()) continue;
+
+                // 贪心策略 ： 找最近
+                int dis = CalMhtDis(agv.currentPos, task->req.targetPos);
+                if (dis< minDistance) {
+                    minDistance = dis;
+                    bestAgvId = agv.uid;
+                }
+            }
+
+            // ---------- 派单执行 ----------
+            if (bestAgvId == -1) { // 当前任务找不到合适的车，看下一个任务
+                ++it;
+            }
+            else{
+                // 【1.Double Check : 再确认】
+                auto currentStatus = WorldMgr.GetAgvStatus(bestAgvId);
+                if (currentStatus != AgvStatus::IDLE) {
+                    // LOG_WARN("[TaskManager] Double check failed for AGV %d (Status changed to %d). Skip.", bestAgvId, (int)currentStatus);
+                    logs.emplace_back(LogAction::DOUBLE_CHECK_FAILED, task->req.taskId, bestAgvId, (int)currentStatus);
+
+                    ++it;
+                    continue;
+                }
+                // 【2.Reservation : 资源预占】
+                // 防止在发包以及车辆响应之前,其他线程/下次循环也不会再考虑这辆车
+                task->req.targetAgvId = bestAgvId;
+                runningTasks_[bestAgvId] = task;
+                
+                // 网络下发
+                auto sess = AgvMgr.GetSession(bestAgvId);
+                if (sess == nullptr) { // Session 丢失
+                    // 【3.RollBack : 异常回滚】
+                    logs.emplace_back(LogAction::SESSION_LOST, task->req.taskId, bestAgvId, 0);
+
+                    runningTasks_.erase(bestAgvId);
+                    ++it;   
+                }
+                else {
+                    sess->Send(protocol::MsgType::TASK_REQUEST, task->req);
+
+                    // LOG_INFO("[TaskManager] Dispatch Task %s to AGV %d (Dist=%d)", task->req.taskId.c_str(), bestAgvId, minDistance);
+                    logs.emplace_back(LogAction::DISPATCH_SUCCESS, task->req.taskId, bestAgvId, minDistance);
+                    
+                    // 成功下发，清理等待队列
+                        it = pendingTasks_.erase(it);
+                }
+            }
+        }
+    }
+
+    // 锁外打印日志
+    ProcessLogs_TD(logs);
+
+}*/
+
+
+/*
+目的是根据 任务汇报消息结构体 来更新 数字任务全景的状态：
+    1.找到运行中的任务 
+        TaskManager的map的key： 结构体中的agvId 
+        if_1:是否找到 ： 找到序列并【if_2在已下发部分里匹配任务序号】，匹配才更新
+    2.更新任务数据 (只有序列首单是真正在执行的)
+        if_3：任务是否完成 ： 完成则 出队，序列里还有后续单就接着执行
+        if_4：进度过阈值 ： 预推送下一单
+*/
+void TaskShard::ApplyReport(const TaskReport& msg) {
+    // 栈变量 ：临时指针,用于在锁外的接管生命周期) ; 状态标记; 临时数据容器
+    bool istask = false;
+    bool isHead = false;          // 是否是序列首单 (正在执行)
+    bool isTaskFinished = false;
+    bool isTaskRejected = false;  // 实现回滚
+    bool needDispatch = false;    // 车空出来了，需要新一轮调度
+    size_t homeShard = index_;    // 车空出来后的归属 (按最终位置)
+    size_t rolledBack = 0;
+    double durationSec = 0.0;
+    TaskHandle pushedTaskId;      // 本次预推送 / 接续下发的任务
+    bool pushFailed = false;
+
+    myreactor::Timestamp now = myreactor::Timestamp::now();
+    
+    {
+        if (AgvTaskSeq* run = FindSeq(msg.agvId)) {
+            AgvTaskSeq& seq = *run;
+
+            size_t idx = seq.sent;
+            for (size_t i = 0; i < seq.sent; ++i) {
+                if (seq.tasks[i]->req.taskId == msg.taskId) { idx = i; break; }
+            }
+
+            if (idx < seq.sent) { //1
+                istask = true;
+                isHead = (idx == 0);
+
+                // 任务报错/拒绝 -> Rollback (该单及其后续全部退回)
+                if (msg.status == AgvStatus::ERROR) { //2
+                    isTaskRejected = true;
+                    rolledBack = RollbackFrom(seq, idx, ReclaimReason::REJECTED);
+                }
+                // 预推送的单 : 车上还在排队，这里只是它的 ACK，无需更新
+                else if (isHead) {
+                    spTaskContext taskinmap = seq.tasks.front();
+                    double lastProgress = taskinmap->progress;
+
+                    // 核心更新                       //3
+                    taskinmap->status = msg.status;
+                    taskinmap->progress = msg.progress;
+                    taskinmap->updateTime = now;
+
+                    // 计算耗时
+                    durationSec = (now.usSinceEpoch()- taskinmap->createTime.usSinceEpoch())/1000000.0;
+
+                    // 任务是否完成                   //4
+                    if(msg.status == AgvStatus::IDLE && msg.progress >= 1.0) {
+                        isTaskFinished = true;
+                        seq.tasks.pop_front();
+                        --seq.sent;
+                    }
+
+                    // 任务日志 : 完成必记; 进度只在跨过检查点 (每 kJournalProgressStep) 时记，不随每次上报写盘
+                    if (TaskJournal* journal = owner_->Journal()) {
+                        if (isTaskFinished) {
+                            journal->Done(msg.taskId, msg.agvId);
+                        }
+                        else if (std::floor(msg.progress / kJournalProgressStep) != std::floor(lastProgress / kJournalProgressStep)) {
+                            journal->Progress(msg.taskId, msg.agvId, msg.progress);
+                        }
+                    }
+
+                    // 接续 / 预推送 : 首单完成但下一单还没下发，或者首单进度过阈值
+                    bool wantNext = isTaskFinished ? (seq.sent == 0)
+                                                   : (msg.progress >= prefetchProgress_);
+                    if (wantNext && seq.sent < seq.tasks.size() && seq.sent < kMaxSentPerAgv) {
+                        const spTaskContext& next = seq.tasks[seq.sent];
+                        if (SendTask(msg.agvId, next)) {
+                            pushedTaskId = next->req.taskId;
+                            ++seq.sent;
+                        }
+                        else {
+                            // 会话异常 : 未下发的后续单全部退回，交给别的车
+                            pushFailed = true;
+                            rolledBack = RollbackFrom(seq, seq.sent, ReclaimReason::PUSH_FAILED);
+                        }
+                    }
+
+                    // 看门狗 : 首单有进度则推后期限; 做完了则换成接续 / 已预推送的下一单开始计时
+                    if (isTaskFinished) watchdog_.Cancel(msg.taskId);
+                    if (seq.sent > 0) ArmWatchdog(seq.tasks.front(), msg.agvId, now.toMilliseconds());
+                }
+            }
+
+            if (seq.tasks.empty()) {
+                EraseSeq(msg.agvId);
+                needDispatch = true;
+                // 写者线程内改归属 (同时解除占用) : 与本分片的 CommitDecisions 串行
+                homeShard = owner_->RehomeAgv(msg.agvId, msg.currentPos);
+            }
+        }
+    }
+
+    // 1.没找到任务或任务不匹配
+    if(!istask) {
+        LOG_WARN("[TaskManager] Ignored report from AGV %d: No matching running task.", msg.agvId);
+        return;
+    }
+
+    // 2. 处理拒绝/失败
+    if(isTaskRejected) {
+        LOG_WARN("[TaskManager] Task %s REJECTED/FAILED by AGV %d. Rolled back %lu tasks.", msg.taskId.ToText().c_str(), msg.agvId, rolledBack);
+
+        // 换车或者唤车
+        TryDispatch();
+        if(homeShard != index_) owner_->NotifyShard(homeShard);
+        return;
+    }
+
+    // 预推送单的 ACK
+    if(!isHead) return;
+
+    // 3.未完成：打印进度
+    LOG_INFO("[TaskManager] Task Update: ID=%s, AGV=%d, Progress=%.2f, Elapsed=%.2fs", msg.taskId.ToText().c_str(), msg.agvId, msg.progress, durationSec);
+
+    // 4.已完成：打印结算
+    if(isTaskFinished){
+        LOG_INFO("[TaskManager] Task %s COMPLETED by AGV %d. Total Time: %.2fs", msg.taskId.ToText().c_str(), msg.agvId, durationSec);
+    }
+
+    if(pushedTaskId.Valid()) {
+        LOG_INFO("[TaskManager] Next Task %s pushed to AGV %d ahead of completion.", pushedTaskId.ToText().c_str(), msg.agvId);
+    }
+    if(pushFailed) {
+        LOG_WARN("[TaskManager] Push to AGV %d failed. %lu queued tasks returned to pending.", msg.agvId, rolledBack);
+    }
+
+    // 有小车空出 / 有任务退回，下一轮调度
+    if(needDispatch || pushFailed) {
+        TryDispatch();
+    }
+    // 车停在了别的分区 : 交给那边调度
+    if(homeShard != index_) {
+        owner_->NotifyShard(homeShard);
+    }
+    // 车空出来了但归属分区没活 : 让有积压的分区来借
+    if(needDispatch && owner_->ShardCount() > 1 && owner_->shards_[homeShard]->PendingCount() == 0) {
+        owner_->NotifyBacklogged(homeShard);
+    }
+}
+
+
+}
+}
@@ -0,0 +1,150 @@
+#include "manager/TrajectoryStore.h"
+#include <algorithm>
+
+namespace agv{
+namespace manager{
+
+using namespace model;
+
+TrajectoryStore::TrajectoryStore()
+    : rings_(new Ring[kSlots])
+{}
+
+TrajectoryStore::~TrajectoryStore() {
+    for (uint32_t i = 0; i < kSlots; ++i) delete[] rings_[i].cells.load(std::memory_order_relaxed);
+}
+
+void TrajectoryStore::Configure(int capacity, int sampleIntervalMs) {
+    capacity_ = capacity > 0 ? static_cast<uint32_t>(capacity) : 0;
+    sampleIntervalMs_ = std::max(0, sampleIntervalMs);
+}
+
+void TrajectoryStore::Attach(AgvSlot slot, int agvId) {
+    if (!Enabled() || !slot.Valid() || slot.index >= kSlots) return;
+    Ring& r = rings_[slot.index];
+
+    // 首次用到这个槽位才分配; 并发登录同一槽位时只留一份
+    if (r.cells.load(std::memory_order_acquire) == nullptr) {
+        Cell* fresh = new Cell[capacity_];
+        Cell* expected = nullptr;
+        if (!r.cells.compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) delete[] fresh;
+    }
+
+    r.agvId.store(-1, std::memory_order_release);  // 换主期间查询一律落空
+    r.base.store(r.head.load(std::memory_order_relaxed), std::memory_order_release);
+    r.lastMs.store(0, std::memory_order_relaxed);
+    r.agvId.store(agvId, std::memory_order_release);
+}
+
+void TrajectoryStore::Detach(AgvSlot slot) {
+    if (!Enabled() || !slot.Valid() || slot.index >= kSlots) return;
+    rings_[slot.index].agvId.store(-1, std::memory_order_release);
+}
+
+int64_t TrajectoryStore::PackStamp(int64_t tsMs, AgvStatus status) {
+    return (tsMs << 8) | static_cast<uint8_t>(static_cast<int8_t>(status));
+}
+
+uint64_t TrajectoryStore::PackPos(const Point& p) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(p.x)) << 32) | static_cast<uint32_t>(p.y);
+}
+
+void TrajectoryStore::Unpack(int64_t stamp, uint64_t pos, TrajSample& out) {
+    out.tsMs = stamp >> 8;
+    out.status = static_cast<AgvStatus>(static_cast<int8_t>(stamp & 0xFF));
+    out.pos.x = static_cast<int32_t>(static_cast<uint32_t>(pos >> 32));
+    out.pos.y = static_cast<int32_t>(static_cast<uint32_t>(pos));
+}
+
+/*
+写 (单写者) :
+    seq 置 0 -> release 栅栏 -> 写数据 -> seq 置为编号 + 1 (release) -> head + 1 (release)
+    读者看到 seq 为 0 或别的编号，说明这个单元正在被覆盖 / 已经是更新的采样
+*/
+void TrajectoryStore::Record(AgvSlot slot, int64_t nowMs, const Point& pos, AgvStatus status) {
+    if (!Enabled() || !slot.Valid() || slot.index >= kSlots) return;
+    Ring& r = rings_[slot.index];
+    Cell* cells = r.cells.load(std::memory_order_acquire);
+    if (cells == nullptr) return;
+
+    int64_t last = r.lastMs.load(std::memory_order_relaxed);
+    if (last > 0 && nowMs - last < sampleIntervalMs_) return;
+    r.lastMs.store(nowMs, std::memory_order_relaxed);
+
+    uint64_t idx = r.head.load(std::memory_order_relaxed);
+    Cell& c = cells[idx % capacity_];
+
+    c.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);  // 置 0 先于数据可见
+    c.stamp.store(PackStamp(nowMs, status), std::memory_order_relaxed);
+    c.pos.store(PackPos(pos), std::memory_order_relaxed);
+    c.seq.store(idx + 1, std::memory_order_release);      // 数据先于编号可见
+
+    r.head.store(idx + 1, std::memory_order_release);
+}
+
+/*
+读 : 从 head - 1 往回走到 max(base, head - capacity)
+    单元 seq 前后一致且等于期望编号才有效; 一旦遇到无效单元 (已被覆盖)，更旧的也都没了，直接停
+    时间单调，早于 sinceMs 也停
+*/
+template <typename F>
+void TrajectoryStore::Scan(const Ring& r, int64_t sinceMs, F&& fn) const {
+    const Cell* cells = r.cells.load(std::memory_order_acquire);
+    if (cells == nullptr) return;
+
+    uint64_t head = r.head.load(std::memory_order_acquire);
+    uint64_t base = r.base.load(std::memory_order_acquire);
+    uint64_t lo = std::max(base, head > capacity_ ? head - capacity_ : 0);
+
+    TrajSample sample;
+    for (uint64_t idx = head; idx-- > lo; ) {
+        const Cell& c = cells[idx % capacity_];
+        uint64_t s1 = c.seq.load(std::memory_order_acquire);
+        if (s1 != idx + 1) break;
+
+        int64_t stamp = c.stamp.load(std::memory_order_relaxed);
+        uint64_t pos = c.pos.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (c.seq.load(std::memory_order_relaxed) != s1) break;
+
+        Unpack(stamp, pos, sample);
+        if (sample.tsMs < sinceMs) break;
+        if (!fn(sample)) break;
+    }
+}
+
+size_t TrajectoryStore::Recent(AgvSlot slot, int agvId, int64_t sinceMs, std::vector<TrajSample>& out) const {
+    if (!Enabled() || !slot.Valid() || slot.index >= kSlots) return 0;
+    const Ring& r = rings_[slot.index];
+    if (r.agvId.load(std::memory_order_acquire) != agvId) return 0;
+
+    size_t first = out.size();
+    Scan(r, sinceMs, [&out](const TrajSample& s) {
+        out.push_back(s);
+        return true;
+    });
+    std::reverse(out.begin() + first, out.end());  // 新 -> 旧 翻成时间先后
+    return out.size() - first;
+}
+
+void TrajectoryStore::InRect(const Point& minP, const Point& maxP, int64_t sinceMs, std::vector<TrajHit>& out) const {
+    if (!Enabled()) return;
+    uint32_t n = std::min(SlotTbl.Size(), kSlots);
+    for (uint32_t i = 0; i < n; ++i) {
+        const Ring& r = rings_[i];
+        int agvId = r.agvId.load(std::memory_order_acquire);
+        if (agvId < 0) continue;
+
+        Scan(r, sinceMs, [&](const TrajSample& s) {
+            if (s.pos.x >= minP.x && s.pos.x <= maxP.x && s.pos.y >= minP.y && s.pos.y <= maxP.y) {
+                out.push_back(TrajHit{agvId, s});
+            }
+            return true;
+        });
+    }
+}
+
+}
+}
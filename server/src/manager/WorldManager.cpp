@@ -2,6 +2,8 @@
 #include "utils/Logger.h"
 #include "algo/planner/AStarPlanner.h"
 #include "myreactor/Timestamp.h" 
+#include "utils/MathUtils.h"
+#include <cstring>
 
 namespace agv{
 namespace manager{
@@ -114,7 +116,14 @@ std::vector<Point> WorldManager::PlanPath(int agvId, Point start, Point end){
     // 安全检查：防止 planner_ 未初始化
     if (currentPlanner) {
         // 这里调用的是接口的 Plan，具体是用 A* 还是 Dijkstra，由 currentPlanner 的实际类型决定
-        return currentPlanner->Plan(gridMap_, start, end);
+        std::vector<Point> path = currentPlanner->Plan(gridMap_, start, end);
+
+        // 记下路径长度 : 配合上报的 progress 推算剩余格数 (ETA 预测)
+        if (!path.empty()) {
+            int len = static_cast<int>(path.size());
+            fleet_.Update(SlotTbl.Find(agvId), [len](AgvState& st) { st.pathLen = len; });
+        }
+        return path;
     }
     
     return {};
@@ -124,70 +133,107 @@ std::vector<Point> WorldManager::PlanPath(int agvId, Point start, Point end){
 读操作（PlanPath/IsWalkable）占 99%，写操作（更新 AGV 状态）占 1%
 如果用普通 mutex：100 个线程同时请求寻路，只能排队加锁，性能极低；
 用 shared_mutex（读写锁）：多个读线程可以同时加读锁，只有写线程来的时候才阻塞，完美适配 “多读少写” 的场景。
+实际上每辆车每秒几次心跳，写并不少 : 车辆状态改成每槽一个 seqlock (见 FleetStateStore)，读者不拿锁，写者只占自己那一槽
 */
-// 检查动态车辆
+// 检查动态车辆 (忽略离线的和自己)
 bool WorldManager::IsOccupied(int x, int y, int selfId) const {
-    // 检查某处是否有车辆，为了避免脏堵、读，需要加读锁
-    std::shared_lock<std::shared_mutex> lock(agvMutex_);
-
-    for(auto& [id, info] : onlineAgvs_) {
-        if (id==selfId) continue; // 忽略自己
-
-        // 重叠检查
-        if (info.currentPos.x==x && info.currentPos.y==y)
-            return true;
-    }
-    return false;
+    return fleet_.AnyAt(Point{x, y}, selfId);
 }
 
 bool WorldManager::IsOccupied(Point point, int selfId) const {
     return IsOccupied(point.x, point.y, selfId);
 }
 
+// 下线了返回 UNKNOWN
 model::AgvStatus WorldManager::GetAgvStatus(int agvId) const {
-    
-        std::shared_lock<std::shared_mutex> lock(agvMutex_);
-        auto it = onlineAgvs_.find(agvId);
-        if (it != onlineAgvs_.end()) {
-            return it->second.status;
-        }
-        // 下线了
-        return model::AgvStatus::UNKNOWN;
-    
+    return fleet_.Status(SlotTbl.Find(agvId));
 }
 
 std::vector<Info> WorldManager::GetAllAgvs() const {
     std::vector<Info> res;
-    {
-        std::shared_lock<std::shared_mutex> lock(agvMutex_);
-        res.reserve(onlineAgvs_.size());
-        for(const auto& pair : onlineAgvs_)
-            res.push_back(pair.second);
-    }
+    res.reserve(SlotTbl.Size());
+    fleet_.ForEachOnline([&res](const AgvState& st) { res.push_back(ToInfo(st)); });
     return res;
 }
 
+spFleetSnapshot WorldManager::GetFleetSnapshot() const {
+    uint64_t epoch = fleetEpoch_.load(std::memory_order_acquire);
+    int64_t now = myreactor::Timestamp::now().toMilliseconds();
+
+    // 1. 快路径 : 已发布的快照还能用，只增加引用计数
+    spFleetSnapshot snap = std::atomic_load(&snapshot_);
+    if (IsSnapshotFresh(snap, epoch, now)) return snap;
+
+    // 2. 重建 : 同时只有一个线程重建; 等锁期间别人可能已经建好
+    std::lock_guard<std::mutex> lock(snapMutex_);
+    snap = std::atomic_load(&snapshot_);
+    epoch = fleetEpoch_.load(std::memory_order_acquire);
+    if (IsSnapshotFresh(snap, epoch, now)) return snap;
+
+    auto fresh = std::make_shared<FleetSnapshot>();
+    fresh->epoch = epoch;
+    fresh->writeStamp = fleet_.WriteStamp();  // 先记序号再读 : 读的过程中有写入，下次比对时会重建
+    fresh->builtMs = now;
+    fresh->agvs.reserve(snap ? snap->agvs.size() : SlotTbl.Size());
+    fleet_.ForEachOnline([&fresh](const AgvState& st) { fresh->agvs.push_back(ToInfo(st)); });
+
+    snap = std::move(fresh);
+    std::atomic_store(&snapshot_, snap);
+    return snap;
+}
+
+bool WorldManager::IsSnapshotFresh(const spFleetSnapshot& snap, uint64_t epoch, int64_t nowMs) const {
+    if (!snap || snap->epoch != epoch) return false;
+    if (nowMs - snap->builtMs < snapshotIntervalMs_.load(std::memory_order_relaxed)) return true;
+    return snap->writeStamp == fleet_.WriteStamp();
+}
+
+Info WorldManager::ToInfo(const AgvState& st) {
+    Info info;
+    info.uid = st.uid;
+    info.version = st.version;
+    info.currentPos = st.pos;
+    info.battery = st.battery;
+    info.status = st.status;
+    info.currentTaskId = st.taskId;
+    info.taskProgress = st.progress;
+    info.lastHeartbeatTime = st.heartbeatMs;
+    info.pathLen = st.pathLen;
+    info.speed = st.speed;
+    info.lastMoveTime = st.lastMoveMs;
+    return info;
+}
+
 // ---------- 写操作 ----------
 // 1. 登录：填充静态身份信息 + 初始化
 void WorldManager::OnAgvLogin(const model::LoginRequest& req) {
-    Info info;
+    AgvState st;
     // --- 静态身份信息
-    info.uid = req.agvId;
-    info.version = req.version;
+    st.uid = req.agvId;
+    std::strncpy(st.version, req.version.c_str(), AgvState::kVersionLen - 1);
     // --- 初始化状态（从登录请求中获取）
-    info.status = model::AgvStatus::IDLE;
-    info.battery = 100.0;
-    info.currentPos = req.initialPos;  // 使用客户端提供的初始位置
+    st.status = model::AgvStatus::IDLE;
+    st.battery = 100.0;
+    st.pos = req.initialPos;  // 使用客户端提供的初始位置
     // --- 运维保活信息
-    info.lastHeartbeatTime = myreactor::Timestamp::now().toMilliseconds();
+    st.heartbeatMs = myreactor::Timestamp::now().toMilliseconds();
 
-    { // 细化写锁作用域
-        std::unique_lock<std::shared_mutex> lock(agvMutex_); //写锁
-        onlineAgvs_[info.uid] = info;
+    // 槽位 : 重连拿回原槽位 (AgvSession 已先分配过，这里幂等)
+    AgvSlot slot = SlotTbl.Acquire(st.uid);
+    if (!slot.Valid()) {
+        LOG_ERROR("[WorldManager] AGV %d login ignored: no free slot.", st.uid);
+        return;
     }
-    // 释放锁之后再打印日志，避免 IO 操作阻塞其他线程
+
+    fleet_.Reset(slot, st);  // 整槽覆盖 (重连 : 上一次的运动学观测作废)
+    fleetEpoch_.fetch_add(1, std::memory_order_release);
+    liveness_.Beat(st.uid, slot, st.heartbeatMs);
+    trajectory_.Attach(slot, st.uid);
+    trajectory_.Record(slot, st.heartbeatMs, st.pos, st.status);
+    TrackBlocking(st.uid, st.pos, st.heartbeatMs);
+
     LOG_INFO("[WorldManager] AGV %d Logged in at (%d, %d) with status=%d, battery=%.1f",
-             info.uid, info.currentPos.x, info.currentPos.y, (int)info.status, info.battery);
+             st.uid, st.pos.x, st.pos.y, (int)st.status, st.battery);
 }
 
 /* “锁内极速计算，锁外从容打印”
@@ -198,66 +244,312 @@ void WorldManager::OnHeartbeat(const model::Heartbeat& msg) {
     // 1. 准备数据
     // 系统调用放在锁外，减少临界区时间
     int64_t now = myreactor::Timestamp::now().toMilliseconds();
-    bool isUnkownAgv = false;
 
-    {
-        std::unique_lock<std::shared_mutex> lock(agvMutex_); // 写锁
-
-        auto it = onlineAgvs_.find(msg.agvId);
-        if (it != onlineAgvs_.end()) {
-            // --- 动态物理信息
-            it->second.currentPos = msg.currentPos;
-            it->second.battery = msg.battery;
-            // --- 逻辑状态信息
-            it->second.status = msg.status;
-            // --- 运维保活信息
-            it->second.lastHeartbeatTime = now;
-        } else {
-            // 策略：收到未知车辆心跳，打印警告
-            // LOG_WARN("Heartbeat from unknown AGV: %d", msg.agvId);
-            // 改成 记录标记
-            isUnkownAgv = true;
-        }
-    }
+    AgvSlot slot = SlotTbl.Find(msg.agvId);
+    bool statusChanged = false;
+    bool moved = false;
+    bool isUnkownAgv = !ApplyHeartbeat(slot, msg, now, statusChanged, moved);
+    if (statusChanged) fleetEpoch_.fetch_add(1, std::memory_order_release);  // 快照立即失效
+    if (!isUnkownAgv) liveness_.Beat(msg.agvId, slot, now);
+    if (moved) TrackBlocking(msg.agvId, msg.currentPos, now);
 
     if(isUnkownAgv)
         LOG_WARN("Heartbeat from unknown AGV: %d", msg.agvId);
     
 }
 
+// 批量心跳 : 一次取时，逐槽 seqlock 写，快照纪元最多推进一次，存活期限 / 死锁检测各一次加锁，告警合并成一行
+void WorldManager::OnHeartbeats(const std::vector<model::Heartbeat>& batch) {
+    if (batch.empty()) return;
+    int64_t now = myreactor::Timestamp::now().toMilliseconds();
+
+    static thread_local std::vector<std::pair<int, AgvSlot>> alive;  // IO 线程各一份，容量复用
+    static thread_local std::vector<DeadlockDetector::Move> moves;
+    alive.clear();
+    moves.clear();
+
+    bool statusChanged = false;
+    size_t unknown = 0;
+    int firstUnknown = -1;
+    for (const auto& msg : batch) {
+        AgvSlot slot = SlotTbl.Find(msg.agvId);
+        bool moved = false;
+        if (ApplyHeartbeat(slot, msg, now, statusChanged, moved)) {
+            alive.emplace_back(msg.agvId, slot);
+            if (moved) moves.push_back({msg.agvId, msg.currentPos});
+            continue;
+        }
+        if (unknown++ == 0) firstUnknown = msg.agvId;
+    }
+    if (statusChanged) fleetEpoch_.fetch_add(1, std::memory_order_release);
+    liveness_.Beat(alive, now);
+    TrackBlocking(moves, now);
+
+    if (unknown > 0)
+        LOG_WARN("Heartbeat from unknown AGV: %d (%lu unknown in a batch of %lu)", firstUnknown, unknown, batch.size());
+}
+
+// 只占自己那一槽 (seqlock 写)，不阻塞任何读者; 车不在线返回 false
+bool WorldManager::ApplyHeartbeat(AgvSlot slot, const model::Heartbeat& msg, int64_t now, bool& statusChanged, bool& moved) {
+    bool known = fleet_.Update(slot, [&msg, now, &statusChanged, &moved](AgvState& st) {
+        if (st.status != msg.status) statusChanged = true;
+        // --- 动态物理信息
+        moved = !(st.pos == msg.currentPos);
+        TrackMotion(st, msg.currentPos, now);
+        st.pos = msg.currentPos;
+        st.battery = msg.battery;
+        // --- 逻辑状态信息
+        st.status = msg.status;
+        // --- 运维保活信息
+        st.heartbeatMs = now;
+    });
+    // 轨迹 : 这辆车的心跳只在一个线程上来，单写者
+    if (known) trajectory_.Record(slot, now, msg.currentPos, msg.status);
+    moved = known && moved;
+    if (moved) reservations_.ReleaseBehind(msg.agvId, slot, msg.currentPos);  // 驶过的预约格放掉 (只锁这辆车的车道)
+    return known;
+}
+
 // 3. 任务上报：主要更新逻辑属性，顺带位置
 void WorldManager::OnTaskReport(const model::TaskReport& msg) {
     // 1. 准备数据
     // 系统调用放在锁外，减少临界区时间
     int64_t now = myreactor::Timestamp::now().toMilliseconds();
 
-    {
-        std::unique_lock<std::shared_mutex> lock(agvMutex_); // 写锁
-
-        auto it = onlineAgvs_.find(msg.agvId);
-        if (it != onlineAgvs_.end()) {
-            // ---逻辑状态信息
-            it->second.status = msg.status;
-            it->second.currentTaskId = msg.taskId;
-            it->second.taskProgress = msg.progress;
-            // ---动态物理信息
-            it->second.currentPos = msg.currentPos;
-            // --- 运维保活信息
-            it->second.lastHeartbeatTime = now;
-        }
+    AgvSlot slot = SlotTbl.Find(msg.agvId);
+    bool statusChanged = false;
+    bool moved = false;
+    bool known = fleet_.Update(slot, [&msg, now, &statusChanged, &moved](AgvState& st) {
+        statusChanged = (st.status != msg.status);
+        // ---逻辑状态信息
+        st.status = msg.status;
+        st.taskId = msg.taskId;
+        st.progress = msg.progress;
+        // ---动态物理信息
+        moved = !(st.pos == msg.currentPos);
+        TrackMotion(st, msg.currentPos, now);
+        st.pos = msg.currentPos;
+        // --- 运维保活信息
+        st.heartbeatMs = now;
+    });
+    if (statusChanged) fleetEpoch_.fetch_add(1, std::memory_order_release);
+    if (known) liveness_.Beat(msg.agvId, slot, now);  // 上报同样证明车还活着
+    if (known && moved) {
+        reservations_.ReleaseBehind(msg.agvId, slot, msg.currentPos);
+        TrackBlocking(msg.agvId, msg.currentPos, now);
     }
-    
 }
 
 // AGV 下线
-void WorldManager::OnAgvLogout(int agvId) {
-    {
-        std::unique_lock<std::shared_mutex> lock(agvMutex_);
-        onlineAgvs_.erase(agvId);
+/*
+观测速度 : 两次位置变化之间 走过的格数 / 时间，指数滑动平均 (EWMA) 平滑抖动
+    间隔过长 (车停过 : 空闲、等路、作业) 的样本不代表行驶速度，只刷新时间基准不计入
+*/
+void WorldManager::TrackMotion(AgvState& st, const Point& newPos, int64_t nowMs) {
+    constexpr double kAlpha = 0.3;
+    constexpr int64_t kMaxGapMs = 5000;
+
+    if (newPos == st.pos) return;
+
+    int64_t gap = nowMs - st.lastMoveMs;
+    if (st.lastMoveMs > 0 && gap > 0 && gap <= kMaxGapMs) {
+        double sample = CalMhtDis(st.pos, newPos) * 1000.0 / static_cast<double>(gap);
+        st.speed = st.speed > 0.0 ? (1.0 - kAlpha) * st.speed + kAlpha * sample : sample;
     }
+    st.lastMoveMs = nowMs;
+}
+
+void WorldManager::OnAgvLogout(int agvId) {
+    fleet_.Remove(SlotTbl.Find(agvId));
+    fleetEpoch_.fetch_add(1, std::memory_order_release);
+    liveness_.Remove(agvId);
+    trajectory_.Detach(SlotTbl.Find(agvId));
+    deadlock_.Remove(agvId);
+    reservations_.ReleaseAll(agvId, SlotTbl.Find(agvId));  // 下线的车不能一直占着通道
+    SlotTbl.Release(agvId);
     LOG_INFO("[WorldManager] AGV %d Logged out.", agvId);
 }
 
+void WorldManager::ConfigureReservation(bool enable, int maxClaim) {
+    maxClaim_ = maxClaim > 0 ? maxClaim : 16;
+    reservations_.Reset(enable ? &gridMap_ : nullptr);
+    if (reservations_.Enabled()) {
+        LOG_INFO("[WorldManager] Cell reservation: %dx%d cells, up to %d per claim.",
+                 gridMap_.GetWidth(), gridMap_.GetHeight(), maxClaim_);
+    }
+}
+
+model::ReserveResponse WorldManager::Reserve(int agvId, const model::ReserveRequest& req) {
+    model::ReserveResponse resp{false, 0, Point{}, -1};
+    if (!reservations_.Enabled()) return resp;
+
+    // 连续性从车当前所在格算起 (见 ReservationTable::Claim); 不在线的车不受理
+    AgvSlot slot = SlotTbl.Find(agvId);
+    AgvState st;
+    if (!fleet_.Read(slot, st)) {
+        if (!req.claim.empty()) resp.conflictCell = req.claim.front();
+        return resp;
+    }
+
+    if (!req.release.empty()) reservations_.Release(agvId, slot, req.release);
+
+    // 超出单次上限的部分不受理 : 只申请前 maxClaim_ 格 (allOrNothing 时整批拒绝)
+    bool truncated = static_cast<int>(req.claim.size()) > maxClaim_;
+    if (truncated && req.allOrNothing) {
+        resp.conflictCell = req.claim[maxClaim_];
+        return resp;
+    }
+
+    ReservationTable::ClaimResult res;
+    if (truncated) {
+        std::vector<Point> head(req.claim.begin(), req.claim.begin() + maxClaim_);
+        res = reservations_.Claim(agvId, slot, st.pos, head, false);
+        if (res.all) res.conflictCell = req.claim[maxClaim_];
+        res.all = false;
+    } else {
+        res = reservations_.Claim(agvId, slot, st.pos, req.claim, req.allOrNothing);
+    }
+
+    resp.granted = res.all;
+    resp.grantedCount = res.granted;
+    resp.conflictCell = res.conflictCell;
+    resp.conflictAgv = res.conflictAgv;
+    return resp;
+}
+
+void WorldManager::ConfigureDeadlock(bool enable, int gridlockMs, int replanHoldMs) {
+    deadlock_.Configure(&gridMap_, enable, gridlockMs, replanHoldMs);
+    if (deadlock_.Enabled()) {
+        LOG_INFO("[WorldManager] Deadlock detection: gridlock after %dms, replan hold %dms.", gridlockMs, replanHoldMs);
+    }
+}
+
+void WorldManager::TrackBlocking(int agvId, const Point& pos, int64_t now) {
+    if (!deadlock_.Enabled()) return;
+    std::vector<DeadlockDetector::CycleEvent> events;
+    deadlock_.OnMove(agvId, pos, now, events);
+    LogCycles(events);
+}
+
+void WorldManager::TrackBlocking(const std::vector<DeadlockDetector::Move>& moves, int64_t now) {
+    if (!deadlock_.Enabled() || moves.empty()) return;
+    std::vector<DeadlockDetector::CycleEvent> events;
+    deadlock_.OnMoves(moves, now, events);
+    LogCycles(events);
+}
+
+void WorldManager::LogCycles(const std::vector<DeadlockDetector::CycleEvent>& events) {
+    for (const auto& e : events) {
+        std::string ring;
+        for (int id : e.members) ring += std::to_string(id) + " -> ";
+        ring += std::to_string(e.members.front());
+        if (e.victim >= 0) {
+            LOG_WARN("[Deadlock] Wait cycle %s; AGV %d backs off to (%d, %d).", ring.c_str(), e.victim, e.side.x, e.side.y);
+        } else {
+            LOG_WARN("[Deadlock] Wait cycle %s; no member has room to back off.", ring.c_str());
+        }
+    }
+}
+
+DeadlockDetector::Verdict WorldManager::OnPathRequest(int agvId) {
+    std::vector<DeadlockDetector::CycleEvent> events;
+    auto verdict = deadlock_.OnPathRequest(agvId, myreactor::Timestamp::now().toMilliseconds(), events);
+    LogCycles(events);
+    return verdict;
+}
+
+std::vector<Point> WorldManager::PlanBackoff(int agvId, Point start, Point side, Point end) {
+    std::vector<Point> path{start, side};
+    if (side == end) return path;
+
+    auto rest = PlanPath(agvId, side, end);  // 含起点 side
+    if (rest.empty()) return PlanPath(agvId, start, end);
+    path.insert(path.end(), rest.begin() + 1, rest.end());
+    return path;
+}
+
+void WorldManager::OnPathPlanned(int agvId, const std::vector<Point>& path) {
+    deadlock_.OnPathPlanned(agvId, path);
+}
+
+void WorldManager::CheckGridlock() {
+    if (!deadlock_.Enabled()) return;
+    std::vector<DeadlockDetector::GridlockEvent> events;
+    deadlock_.CheckGridlock(myreactor::Timestamp::now().toMilliseconds(), events);
+    for (const auto& e : events) {
+        LOG_WARN("[Deadlock] Gridlock: AGV %d waiting in a chain of %d behind AGV %d at (%d, %d), which has not moved for %ldms.",
+                 e.waiter, e.chainLen, e.head, e.headPos.x, e.headPos.y, e.stillMs);
+    }
+}
+
+void WorldManager::ConfigureTrajectory(int capacity, int sampleIntervalMs) {
+    trajectory_.Configure(capacity, sampleIntervalMs);
+    if (trajectory_.Enabled()) {
+        LOG_INFO("[WorldManager] Trajectory: %d samples per AGV, min interval %dms.", capacity, sampleIntervalMs);
+    }
+}
+
+std::vector<TrajSample> WorldManager::QueryTrajectory(int agvId, int64_t lastMs) const {
+    std::vector<TrajSample> out;
+    int64_t now = myreactor::Timestamp::now().toMilliseconds();
+    trajectory_.Recent(SlotTbl.Find(agvId), agvId, now - lastMs, out);
+    return out;
+}
+
+std::vector<TrajHit> WorldManager::QueryTrajectoryInRect(Point minP, Point maxP, int64_t lastMs) const {
+    std::vector<TrajHit> out;
+    int64_t now = myreactor::Timestamp::now().toMilliseconds();
+    trajectory_.InRect(minP, maxP, now - lastMs, out);
+    return out;
+}
+
+void WorldManager::ConfigureLiveness(int heartbeatIntervalMs, int missedBeats, int offlineBeats) {
+    liveness_.Configure(heartbeatIntervalMs, missedBeats, offlineBeats);
+    if (liveness_.Enabled()) {
+        LOG_INFO("[WorldManager] Liveness: interval=%dms, suspect after %d missed, offline after %d missed.",
+                 heartbeatIntervalMs, missedBeats, offlineBeats);
+    }
+}
+
+/*
+到期处理 :
+    SUSPECT : 槽内心跳时间再核对一次 (Advance 弹出之后、这里写之前可能刚好来了心跳，那次 Beat 已重新定时)，
+              确认静默够久才置 UNKNOWN; 派单只挑 IDLE 的车，UNKNOWN 的车自然出局，下一次心跳带回真实状态
+    OFFLINE : 同样核对后交给调用方踢连接，下线流程 (OnClose -> OnAgvLogout) 负责清理
+*/
+std::vector<int> WorldManager::CheckLiveness() {
+    std::vector<int> offline;
+    if (!liveness_.Enabled()) return offline;
+
+    int64_t now = myreactor::Timestamp::now().toMilliseconds();
+    std::vector<LivenessTracker::Expired> expired;
+    liveness_.Advance(now, expired);
+    if (expired.empty()) return offline;
+
+    int64_t silentMs = liveness_.SuspectAfterMs();
+    std::vector<int> suspect;
+    for (const auto& e : expired) {
+        bool silent = false;
+        bool wasOnline = fleet_.Update(e.slot, [now, silentMs, &silent, &e](AgvState& st) {
+            silent = (now - st.heartbeatMs >= silentMs);
+            if (silent && e.stage == LivenessTracker::Stage::SUSPECT) st.status = model::AgvStatus::UNKNOWN;
+        });
+        if (!wasOnline || !silent) continue;
+
+        if (e.stage == LivenessTracker::Stage::SUSPECT) suspect.push_back(e.agvId);
+        else offline.push_back(e.agvId);
+    }
+
+    if (!suspect.empty()) {
+        fleetEpoch_.fetch_add(1, std::memory_order_release);  // 快照立即失效
+        LOG_WARN("[WorldManager] %lu AGV(s) missed heartbeats, marked UNKNOWN (first: %d).", suspect.size(), suspect.front());
+    }
+    for (int agvId : offline) {
+        LOG_WARN("[WorldManager] AGV %d silent for too long, treating as offline.", agvId);
+    }
+    return offline;
+}
+
 
 
 }
@@ -2,7 +2,9 @@
 #include "manager/WorldManager.h"
 #include "utils/Logger.h"
 #include <string>
+#include <algorithm>
 #include "myreactor/ThreadPool.h"
+#include "myreactor/Timestamp.h"
 
 
 /*
@@ -23,13 +25,17 @@ AgvManager& AgvManager::Instance() {
 void AgvManager::OnNewConn(const spConnection& conn, myreactor::ThreadPool& pool) {    
     // 【乐观分配】
     auto newsess = std::make_shared<AgvSession>(conn, pool);
+    upRegistry old;  // 旧快照在锁外释放
 
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        const Registry& cur = *registry_.Peek();
 
         // 防止两个线程同时处理同一个 conn (虽然理论上 Reactor 模型不会发生)
-        if (connMap_.find(conn) == connMap_.end()) { // 【锁内检查】
-            connMap_[conn] = newsess;
+        if (cur.connMap.find(conn) == cur.connMap.end()) { // 【锁内检查】
+            upRegistry next = CopyLocked();  // 复制 -> 修改 -> 发布
+            next->connMap[conn] = newsess;
+            old = registry_.Exchange(std::move(next));
 
             // 返向绑定：让 Connection 直接 持有 Session
             conn->setContext(newsess);
@@ -54,28 +60,32 @@ void AgvManager::OnNewConn(const spConnection& conn, myreactor::ThreadPool& pool
                     if_4 【关键判断】
        逻辑映射的 key
 AgvManager::OnClose，最后清理shared计数不能清理成新的session了，一定要清理正确的旧的session ， 实现方式：
-    【关键判断】:通过RegisterAgvId 的已经覆盖 旧Session 的结果，即 [idMap_内是新的Session]，和我的传入参数 [旧conn关系着的 旧Session] 比较，进而确定是否 该清除
+    【关键判断】:通过RegisterAgvId 的已经覆盖 旧Session 的结果，即 [idSlots内是新的Session]，和我的传入参数 [旧conn关系着的 旧Session] 比较，进而确定是否 该清除
 */
 void AgvManager::OnClose(const spConnection& conn) {
     // 栈变量：定义一个临时指针，用于在锁外接管生命周期 ; 定义一个临时 id，用于标记是否需要清除idMap，以及在锁外接管
     spSession sess = nullptr; 
     int agvId = -1; // 记录ID，无论是否抢占，都记录下来打印日志
     bool needLogout = false; // 标记是否需要 业务下线
+    upRegistry old;          // 旧快照在锁外释放 (Session 可能随它析构)
 
-    {   // 临界区：只做 临界资源 Map 的查找
+    {   // 临界区：只做 临界资源 Map 的 复制与修改
         std::lock_guard<std::mutex> lock(mutex_);
+        const Registry& cur = *registry_.Peek();
 
-        auto it = connMap_.find(conn);   // 1.查找物理连接 ：conn -> session
-        if (it != connMap_.end()) {
-            sess = it->second; // 接管  
+        auto found = cur.connMap.find(conn);   // 1.查找物理连接 ：conn -> session
+        if (found != cur.connMap.end()) {
+            sess = found->second; // 接管  
+            upRegistry next = CopyLocked();
+            auto it = next->connMap.find(conn);
 
             if (sess->IsLogin()) {   // 只有已登录的才涉及 idMap 清理
                 agvId = sess->GetId();
-                auto idIt = idMap_.find(agvId);  // 2.查找逻辑连接 : id -> session
+                IdEntry* idIt = FindId(*next, agvId);  // 2.查找逻辑连接 : id -> session
                 
                 //【关键判断】: 两个session比较，只有相等，意味着没有新的session抢占，则 Agv真正下线，清理 idMap
-                if(idIt!=idMap_.end() && sess==idIt->second) {
-                    idMap_.erase(idIt);   // 【清 idMap】
+                if(idIt!=nullptr && sess==idIt->sess) {
+                    idIt->sess.reset();   // 【清 idMap】
                     // WorldMgr.OnAgvLogout(id);  X
                     // WorldMgr.OnAgvLogout内部有锁，可能发生死锁，尽量释放锁后再拿另外一把锁
                     needLogout = true;
@@ -84,8 +94,9 @@ void AgvManager::OnClose(const spConnection& conn) {
             } 
 
             // 清理要删的session，以及connection
-            // connMap_.erase(conn);  // 【清 connMap】  又查了一次红黑树
-            connMap_.erase(it); //拿到迭代器了，直接删迭代器，是O(1),效率更高
+            // connMap.erase(conn);  // 【清 connMap】  又查了一次红黑树
+            next->connMap.erase(it); //拿到迭代器了，直接删迭代器，是O(1),效率更高
+            old = registry_.Exchange(std::move(next));
         }
     }
 
@@ -107,18 +118,11 @@ void AgvManager::OnClose(const spConnection& conn) {
 // 强制下线
 
 void AgvManager::KickAgv(int agvId) {
-    // 定义一个临时指针，用于在锁外接管生命周期
-    spSession sess = nullptr;
-
-    {   // 临界区：只做 临界资源 Map 的查找
-        std::lock_guard<std::mutex> lock(mutex_);
-
-        /*在只读 / 查找语义下（比如踢人、查询状态），必须使用 find()
-        使用 operator[] X : 没找到 -> 自动插入一个键值对 到map中；明确“如果不存在就创建一个新的”（比如统计单词出现次数 count[word]++）时，才使用 operator[]。
-        */
-        auto it = idMap_.find(agvId);
-        if(it != idMap_.end()) sess = it->second;
-    }
+    // 只读 : 快照上查找，不加锁 (RCU 读临界区)
+    /*在只读 / 查找语义下（比如踢人、查询状态），必须使用 find()
+    使用 operator[] X : 没找到 -> 自动插入一个键值对 到map中；明确“如果不存在就创建一个新的”（比如统计单词出现次数 count[word]++）时，才使用 operator[]。
+    */
+    spSession sess = GetSession(agvId);
 
     /*【闭环设计】
     这里只负责“拔网线”，不负责“收尸”。
@@ -136,18 +140,17 @@ void AgvManager::KickAgv(int agvId) {
 // ========== 查找接口
 // 收到网络包 -> 查 Session -> 处理业务
 AgvManager::spSession AgvManager::GetSession(const spConnection& conn) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = connMap_.find(conn);
-    if (it==connMap_.end()) return nullptr;
+    auto reg = registry_.Read();  // 读临界区 : 查到就拷出 Session，守卫析构即离开
+    auto it = reg->connMap.find(conn);
+    if (it==reg->connMap.end()) return nullptr;
     return it->second;
 }
 
-// 业务id -> 查 Session 
+// 业务id -> 查 Session (派单路径 : 在 TaskManager 锁内调用，不再嵌套第二把锁)
 AgvManager::spSession AgvManager::GetSession(int agvId) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = idMap_.find(agvId);
-    if(it==idMap_.end()) return nullptr;
-    return it->second;
+    auto reg = registry_.Read();
+    const IdEntry* it = FindId(*reg, agvId);
+    return it ? it->sess : nullptr;
 }
 
     
@@ -161,19 +164,30 @@ AgvManager::spSession AgvManager::GetSession(int agvId) {
 void AgvManager::RegisterAgvId(int agvId, spSession sess){
     bool isneedreplace = false;
     spSession oldsess = nullptr;
+    upRegistry old;
+
+    // 槽位 : 重连拿回原槽位 (AgvSession 登录时已分配过，这里幂等)
+    manager::AgvSlot slot = SlotTbl.Acquire(agvId);
+    if (!slot.Valid()) {
+        LOG_ERROR("AGV ID %d not registered: no free slot.", agvId);
+        return;
+    }
     
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        upRegistry next = CopyLocked();
     
         // 先检查  id-旧session 对
-        auto it = idMap_.find(agvId);
-        if(it != idMap_.end()){ // 是否还有旧的session ：KickAgv的回环清理是异步的，如果没来得及清理，则 则需要打印 替换日志 ; 已经清理掉则直接添加
+        if (slot.index >= next->idSlots.size()) next->idSlots.resize(slot.index + 1);
+        IdEntry& entry = next->idSlots[slot.index];
+        if(entry.slot == slot && entry.sess){ // 是否还有旧的session ：KickAgv的回环清理是异步的，如果没来得及清理，则 则需要打印 替换日志 ; 已经清理掉则直接添加
             isneedreplace = true;
-            oldsess = it->second;
+            oldsess = entry.sess;
         }
 
-        // 更新替换/插入
-        idMap_[agvId] = sess;
+        // 更新替换/插入 (槽位被回收过的话，旧元素连同代数一起覆盖)
+        entry = IdEntry{slot, sess};
+        old = registry_.Exchange(std::move(next));
     }
 
     /*
@@ -188,17 +202,78 @@ void AgvManager::RegisterAgvId(int agvId, spSession sess){
 }
 
 
-void AgvManager::CheckAllTimeouts(int64_t timeoutMils) {
-    std::lock_guard<std::mutex> lock(mutex_);
+const AgvManager::IdEntry* AgvManager::FindId(const Registry& reg, int agvId) {
+    manager::AgvSlot slot = SlotTbl.Find(agvId);
+    if (!slot.Valid() || slot.index >= reg.idSlots.size()) return nullptr;
+    const IdEntry& entry = reg.idSlots[slot.index];
+    return (entry.slot == slot && entry.sess) ? &entry : nullptr;
+}
 
-    for (auto& pair : connMap_) {
-        auto session = pair.second;
-        if (session) {
-            // 3. 调用 Session 自己的检查函数
-            // 默认超时时间 5000ms (5秒)
-            session->CheckRpcTimeout(timeoutMils);
-        }
+AgvManager::IdEntry* AgvManager::FindId(Registry& reg, int agvId) {
+    return const_cast<IdEntry*>(FindId(static_cast<const Registry&>(reg), agvId));
+}
+
+void AgvManager::ConfigureRpc(int64_t timeoutMils, int maxRetries, int minRtoMs, int maxRtoMs) {
+    rpcPolicy_.timeoutMs = timeoutMils > 0 ? timeoutMils : 5000;
+    rpcPolicy_.maxRetries = std::max(0, maxRetries);
+    rpcPolicy_.minRtoMs = std::max(kRpcTickMs, minRtoMs);  // 期限精度就是时间轮节拍，更小的 RTO 没有意义
+    rpcPolicy_.maxRtoMs = std::max(rpcPolicy_.minRtoMs, maxRtoMs);
+    LOG_INFO("[AgvManager] RPC timeout %lldms, retries %d, RTO [%d, %d]ms",
+             (long long)rpcPolicy_.timeoutMs, rpcPolicy_.maxRetries, rpcPolicy_.minRtoMs, rpcPolicy_.maxRtoMs);
+}
+
+void AgvManager::ArmRpc(const spSession& sess, int32_t seq, int64_t deadlineMs) {
+    int64_t now = myreactor::Timestamp::now().toMilliseconds();
+    std::lock_guard<std::mutex> lock(rpcMutex_);
+    if (rpcWheel_.Empty()) {  // 轮子空 : 先对齐时间起点
+        std::vector<RpcWheel::Expired> none;
+        rpcWheel_.Advance(now, none);
+    }
+    rpcWheel_.Arm(RpcKey(sess->GetSid(), seq), sess, deadlineMs);
+}
+
+void AgvManager::CancelRpc(uint32_t sid, int32_t seq) {
+    std::lock_guard<std::mutex> lock(rpcMutex_);
+    rpcWheel_.Cancel(RpcKey(sid, seq));
+}
+
+void AgvManager::CheckAllTimeouts() {
+    int64_t now = myreactor::Timestamp::now().toMilliseconds();
+
+    rpcExpired_.clear();
+    {
+        std::lock_guard<std::mutex> lock(rpcMutex_);
+        rpcWheel_.Advance(now, rpcExpired_);
+    }
+
+    // 锁外回调 : 回调里会重传 (重新登记期限) 或回滚任务、重新调度
+    for (const auto& e : rpcExpired_) {
+        if (auto sess = e.value.lock()) sess->ExpireRpc(static_cast<int32_t>(e.key & 0xFFFFFFFFu));
+    }
+}
+
+bool AgvManager::GetRpcStats(int agvId, AgvSession::RpcStats& out) {
+    spSession sess = GetSession(agvId);
+    if (!sess) return false;
+    out = sess->GetRpcStats();
+    return true;
+}
+
+std::vector<std::pair<int, AgvSession::RpcStats>> AgvManager::CollectRpcStats() {
+    // 读临界区里只拷出会话 : 取统计要拿各会话的锁，不能让写者的宽限期等它
+    std::vector<spSession> sessions;
+    {
+        auto reg = registry_.Read();
+        sessions.reserve(reg->connMap.size());
+        for (const auto& pair : reg->connMap) sessions.push_back(pair.second);
+    }
+
+    std::vector<std::pair<int, AgvSession::RpcStats>> res;
+    res.reserve(sessions.size());
+    for (const auto& sess : sessions) {
+        if (sess && sess->IsLogin()) res.emplace_back(sess->GetId(), sess->GetRpcStats());
     }
+    return res;
 }
 
 }
@@ -3,6 +3,7 @@
 #include "manager/TaskManager.h"  //更新数字任务全景的状态 ：决策世界
 #include "utils/Logger.h"
 #include <string>
+#include <algorithm>
 #include "session/AgvManager.h"
 #include <myreactor/ThreadPool.h>
 #include "myreactor/Timestamp.h"
@@ -16,7 +17,12 @@ namespace session{
 using namespace protocol; 
 using namespace model;
 
-AgvSession::AgvSession(spConnection conn,  myreactor::ThreadPool& pool): conn_(conn), workerPool_(pool) {} 
+namespace {
+std::atomic<uint32_t> g_nextSid{0};
+}
+
+AgvSession::AgvSession(spConnection conn,  myreactor::ThreadPool& pool)
+    : conn_(conn), workerPool_(pool), sid_(g_nextSid.fetch_add(1, std::memory_order_relaxed) + 1) {} 
 
 AgvSession::~AgvSession() {
     LOG_INFO("Session Destoryed. AGV ID: %d", agvId_);
@@ -49,6 +55,16 @@ void AgvSession::HandleLogin(const LoginRequest& req, int32_t seq) {
         return; // 不注册，还要断开连接
     }
 
+    // 分配槽位 (AgvId -> 紧凑下标，重连拿回原槽位) : 槽位用完时拒绝登录
+    if (!SlotTbl.Acquire(req.agvId).Valid()) {
+        LoginResponse resp;
+        resp.success = false;
+        resp.token = "";
+        resp.message = "Fleet Full";
+        Send(MsgType::LOGIN_RESP, resp, seq);
+        return;
+    }
+
     // 全局状态检查 (顶号策略 / 踢旧连接) ： 忽略新的策略是危险的
     /*“后来者居上”原则 ： “会话抢占” 或 “强制下线旧会话”
     旧 Session = 断网前建立的连接（可能已经成了半死不活的僵尸）。
@@ -82,19 +98,19 @@ void AgvSession::HandleLogin(const LoginRequest& req, int32_t seq) {
     LOG_INFO("AGV %d Logged in.", agvId_);
 }
 
-// 心跳处理：收到 Heartbeat -> 更新 WorldManager
-    // 1. 轻量级业务：直接在 IO 线程做，不改动
-void AgvSession::HandleHbeat(const Heartbeat& msg, int32_t seq) {
+// 心跳处理：IO 线程按轮合批后统一交给 WorldManager::OnHeartbeats (见 AgvServer 的心跳合批)，这里只做会话校验
+bool AgvSession::CheckHbeat(const Heartbeat& msg) const {
     // 未登录拦截
-    if(!isLogin_) return;
+    if(!isLogin_) return false;
 
     if(msg.agvId != agvId_) {
         LOG_WARN("ID mismatch in Heartbeat!");
-        return;
+        return false;
     }
 
-    // 更新数字全景
-    WorldMgr.OnHeartbeat(msg);
+    // 重登录 : 旧会话被异步踢掉，关闭前仍是 isLogin_，它的心跳不能再写这辆车 (轨迹 / 预约都假设单写者)
+    if (AgvMgr.GetSession(agvId_).get() != this) return false;
+    return true;
 }
 
 // 任务上报：更新进度
@@ -131,10 +147,23 @@ void AgvSession::HandlePRequ(const PathRequest& req, int32_t seq) {
     捕获列表的初始化子句里，只能写「变量名 = 初始化值」，不能在变量名前加任何类型说明符（包括 auto、int、const 等）
     捕获列表的变量类型完全由编译器自动推导，不需要显式指定
     */
+   // 死锁检测 : 被堵在环里 / 刚为同一个堵点算过路，直接回 “等待”，不往线程池里堆 A*
+   auto verdict = WorldMgr.OnPathRequest(agvId_);
+   if (verdict.kind == manager::DeadlockDetector::Verdict::HOLD) {
+        PathResponse resp;
+        resp.success = false;
+        resp.failReason = "Blocked, waiting for AGV " + std::to_string(verdict.blocker);
+        Send(MsgType::PATH_RESP, resp, seq);
+        return;
+   }
+
    // 【投递到工作线程】
-   workerPool_.addtask([self=shared_from_this(), req, seq] () {
-        // 求解路径
-        auto path = WorldMgr.PlanPath(self->GetId(), req.start, req.end);
+   workerPool_.addtask([self=shared_from_this(), req, seq, verdict] () {
+        // 求解路径 (让路车 : 先退到侧格)
+        auto path = (verdict.kind == manager::DeadlockDetector::Verdict::BACKOFF)
+                  ? WorldMgr.PlanBackoff(self->GetId(), req.start, verdict.side, req.end)
+                  : WorldMgr.PlanPath(self->GetId(), req.start, req.end);
+        if (!path.empty()) WorldMgr.OnPathPlanned(self->GetId(), path);
 
         LOG_INFO("[AgvSession] AGV %d Path Planning: (%d,%d) -> (%d,%d), Result: %lu steps",
                  self->GetId(), req.start.x, req.start.y, req.end.x, req.end.y, path.size());
@@ -154,6 +183,15 @@ void AgvSession::HandlePRequ(const PathRequest& req, int32_t seq) {
 
 
 
+// 格子预约：逐格 CAS，微秒级
+    // 1. 轻量级业务：直接在 IO 线程做，回复不经过线程池
+void AgvSession::HandleReserve(const ReserveRequest& req, int32_t seq) {
+    if(!isLogin_) return;
+
+    ReserveResponse resp = WorldMgr.Reserve(agvId_, req);
+    Send(MsgType::RESERVE_RESP, resp, seq);
+}
+
 // 任务下发接口  【Worker线程】
 bool AgvSession::DispatchTask(const model::TaskRequest& req, RpcCallback cb) {
     // 安全检查：只有登录后才能下发
@@ -167,14 +205,30 @@ bool AgvSession::DispatchTask(const model::TaskRequest& req, RpcCallback cb) {
     // 生成属于 Server 的新序列号 以及 待确认构建
     int32_t newSeq = GetNextSeq();
 
-    PendingRequest pr;
-    pr.seq = newSeq;
-    pr.sendTime = myreactor::Timestamp::now().toMilliseconds();
-    pr.cb = cb;
+    int64_t nowUs = myreactor::Timestamp::now().usSinceEpoch();
+    int64_t now = nowUs / 1000;
+    int64_t deadline = 0;
+    PendingRequest evicted;
 
     {
         std::lock_guard<std::mutex> lock(mapMutex_);
-        pendingReqs_[newSeq] = pr;
+        PendingRequest& pr = pendingReqs_[static_cast<uint32_t>(newSeq) & (kRpcRing - 1)];
+        if (pr.used) evicted = std::move(pr);  // 环绕一圈还没确认 : 最老的那条让位
+        pr.used = true;
+        pr.seq = newSeq;
+        pr.sendTime = now;
+        pr.lastSendUs = nowUs;
+        pr.attempts = 1;
+        pr.req = req;
+        pr.cb = cb;
+        deadline = NextDeadlineLocked(pr, now);
+    }
+    AgvMgr.ArmRpc(shared_from_this(), newSeq, deadline);
+
+    if (evicted.used) {
+        AgvMgr.CancelRpc(sid_, evicted.seq);
+        LOG_WARN("RPC Evicted: Seq %d still pending after %d newer requests.", evicted.seq, kRpcRing);
+        evicted.cb(false, "Evicted");
     }
 
     // 发送     【内部转回 IO线程 】
@@ -183,57 +237,117 @@ bool AgvSession::DispatchTask(const model::TaskRequest& req, RpcCallback cb) {
     return true;
 }
 
+bool AgvSession::TakePendingLocked(int32_t seq, PendingRequest& out) {
+    PendingRequest& pr = pendingReqs_[static_cast<uint32_t>(seq) & (kRpcRing - 1)];
+    if (!pr.used || pr.seq != seq) return false;
+    out = std::move(pr);
+    pr.used = false;
+    return true;
+}
+
+void AgvSession::SampleRttLocked(int64_t rttUs) {
+    rttUs = std::max<int64_t>(rttUs, 0);
+    if (stats_.samples == 0) {
+        srttUs_ = rttUs;
+        rttvarUs_ = rttUs / 2;
+    } else {
+        int64_t err = srttUs_ > rttUs ? srttUs_ - rttUs : rttUs - srttUs_;
+        rttvarUs_ += (err - rttvarUs_) / 4;
+        srttUs_ += (rttUs - srttUs_) / 8;
+    }
+    ++stats_.samples;
+
+    const RpcPolicy& policy = AgvMgr.GetRpcPolicy();
+    int64_t rto = (srttUs_ + 4 * rttvarUs_ + 999) / 1000;
+    rtoMs_ = std::min<int64_t>(std::max<int64_t>(rto, policy.minRtoMs), policy.maxRtoMs);
+}
+
+// 第 attempts 次发送之后 : 还能重传就等 rto << (attempts - 1)，否则等到总时限
+int64_t AgvSession::NextDeadlineLocked(const PendingRequest& pr, int64_t nowMs) const {
+    const RpcPolicy& policy = AgvMgr.GetRpcPolicy();
+    int64_t last = pr.sendTime + policy.timeoutMs;
+    if (pr.attempts > policy.maxRetries) return last;
+
+    int64_t backoff = std::max<int64_t>(rtoMs_, policy.minRtoMs);
+    for (int k = 1; k < pr.attempts && backoff < policy.maxRtoMs; ++k) backoff <<= 1;
+    backoff = std::min<int64_t>(backoff, policy.maxRtoMs);
+    return std::min(nowMs + backoff, last);
+}
+
+AgvSession::RpcStats AgvSession::GetRpcStats() const {
+    std::lock_guard<std::mutex> lock(mapMutex_);
+    RpcStats s = stats_;
+    s.srttMs = srttUs_ / 1000.0;
+    s.rttvarMs = rttvarUs_ / 1000.0;
+    s.rtoMs = rtoMs_;
+    s.inflight = 0;
+    for (const auto& pr : pendingReqs_) s.inflight += pr.used ? 1 : 0;
+    return s;
+}
+
 // 处理 ACK
 void AgvSession::HandleAck(int32_t replySeq) {
-    RpcCallback cb = nullptr;
+    PendingRequest pr;
 
     {
         std::lock_guard<std::mutex> lock(mapMutex_);
-
-        auto it = pendingReqs_.find(replySeq);
-        if(it != pendingReqs_.end()) {
-            cb = it->second.cb;
-            pendingReqs_.erase(it);
+        if (TakePendingLocked(replySeq, pr)) {
+            ++stats_.acked;
+            // Karn : 重传过的请求分不清确认的是哪一次发送，不采样
+            if (pr.attempts == 1) SampleRttLocked(myreactor::Timestamp::now().usSinceEpoch() - pr.lastSendUs);
         }
     }
 
-    if(cb) {
+    if(pr.used) {
+        AgvMgr.CancelRpc(sid_, replySeq);  // O(1) 摘掉期限
         LOG_INFO("RPC Match: Seq %d confirmed.", replySeq);
-        cb(true, "");
+        pr.cb(true, "");
     }
 } // // 如果没找到，忽略即可：要么找到true ，要么到超时中 false
 
 
-void AgvSession::CheckRpcTimeout(int64_t timeoutMils) {
-    int64_t now = myreactor::Timestamp::now().toMilliseconds();
+/*
+期限到期 (主 Loop) : 已确认 / 已让位的直接忽略; 还在表里说明没确认 :
+    总时限内还能重传 : 原样重发 (同 seq)，按退避后的 RTO 重新登记期限
+    否则 : 按失败回调
+*/
+void AgvSession::ExpireRpc(int32_t seq) {
+    int64_t nowUs = myreactor::Timestamp::now().usSinceEpoch();
+    int64_t now = nowUs / 1000;
+    const RpcPolicy& policy = AgvMgr.GetRpcPolicy();
 
-    /*vector<pair>和map的选择
-        map能够提供键查找(更多的功能)，所以复杂度会高一点
-        但这里的场景只需要按序遍历即可，vector足够
-    map<seq, cb> 与 vector<pair<seq, cb>>
-    */
-    using TimeoutItem = std::pair<int32_t, RpcCallback>;
-    std::vector<TimeoutItem> timeoutItems;
+    PendingRequest expired;
+    model::TaskRequest resend;
+    int attempt = 0;
+    int64_t deadline = 0;
 
     {
         std::lock_guard<std::mutex> lock(mapMutex_);
-
-        /*
-        范围 for 是 “简洁遍历的语法糖”，设计目标是 “只读 / 修改元素内容”；而代码需要 “遍历中修改容器（删元素）+ 精准控制迭代器”，这超出了范围 for 的能力边界；需要用 显式迭代器遍历
-        */
-        for(auto it = pendingReqs_.begin(); it != pendingReqs_.end(); ) {
-            if(now - it->second.sendTime > timeoutMils) {  //  【超时判断】
-                timeoutItems.emplace_back(it->first, it->second.cb);
-                it = pendingReqs_.erase(it);
-            }else {++it;}
+        PendingRequest& pr = pendingReqs_[static_cast<uint32_t>(seq) & (kRpcRing - 1)];
+        if (!pr.used || pr.seq != seq) return;
+
+        if (pr.attempts <= policy.maxRetries && now < pr.sendTime + policy.timeoutMs) {
+            attempt = ++pr.attempts;
+            pr.lastSendUs = nowUs;
+            resend = pr.req;
+            deadline = NextDeadlineLocked(pr, now);
+            ++stats_.retransmits;
+        } else {
+            TakePendingLocked(seq, expired);
+            ++stats_.timeouts;
         }
     }
 
-    for(const auto& item : timeoutItems) {
-        LOG_WARN("RPC Timeout: Seq %d expired.", item.first);
-        item.second(false, "Timeout");
+    if (attempt > 0) {
+        AgvMgr.ArmRpc(shared_from_this(), seq, deadline);
+        LOG_WARN("RPC Retransmit: Seq %d attempt %d/%d, next check in %lldms.",
+                 seq, attempt, policy.maxRetries + 1, (long long)(deadline - now));
+        Send(MsgType::TASK_REQUEST, resend, seq);
+        return;
     }
 
+    LOG_WARN("RPC Timeout: Seq %d expired after %d attempts.", seq, expired.attempts);
+    expired.cb(false, "Timeout");
 }
 
 
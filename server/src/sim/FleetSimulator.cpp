@@ -0,0 +1,411 @@
+#include "sim/FleetSimulator.h"
+#include "manager/TaskManager.h"
+#include "manager/WorldManager.h"
+#include "myreactor/Timestamp.h"
+#include "utils/Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace agv {
+namespace sim {
+
+using namespace model;
+
+namespace {
+// 虚拟时钟 : 由 Run() 推进，Timestamp::now() 读它
+std::atomic<int64_t> g_simNowUs{0};
+
+int64_t SimClock() {
+    return g_simNowUs.load(std::memory_order_relaxed);
+}
+
+int64_t SystemNowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+double Percentile(std::vector<int64_t>& v, double p) {
+    if (v.empty()) return 0.0;
+    size_t k = static_cast<size_t>(p * static_cast<double>(v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return static_cast<double>(v[k]) / 1e6;
+}
+}
+
+FleetSimulator::FleetSimulator(const config::SimConfig& simCfg, const config::DispatchConfig& dispatchCfg)
+    : cfg_(simCfg), dispatchCfg_(dispatchCfg) {}
+
+// 兜底 : 异常退出时也要把系统时钟还回去
+FleetSimulator::~FleetSimulator() {
+    myreactor::Timestamp::setClock(nullptr);
+}
+
+// ================= 订单流 =================
+
+// 每行 : 到达偏移毫秒,x,y[,priority] ; 空行与 # 开头的行忽略
+bool FleetSimulator::LoadOrders(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        LOG_ERROR("[Sim] Cannot open orders file: %s", path.c_str());
+        return false;
+    }
+
+    orders_.clear();
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        if (line.empty() || line[0] == '#') continue;
+
+        SimOrder o;
+        long long t = 0;
+        int n = std::sscanf(line.c_str(), "%lld,%d,%d,%d", &t, &o.target.x, &o.target.y, &o.priority);
+        if (n < 3) {
+            LOG_WARN("[Sim] Bad order line %d: %s", lineNo, line.c_str());
+            continue;
+        }
+        o.arriveMs = t;
+        orders_.push_back(o);
+    }
+
+    std::stable_sort(orders_.begin(), orders_.end(), [](const SimOrder& a, const SimOrder& b) {
+        return a.arriveMs < b.arriveMs;
+    });
+    LOG_INFO("[Sim] Loaded %lu orders from %s", orders_.size(), path.c_str());
+    return true;
+}
+
+// 泊松到达 : 间隔服从指数分布; 目标点在可通行格子里均匀取 (固定种子，可复现)
+void FleetSimulator::GenerateOrders() {
+    const GridMap& map = WorldMgr.GetGridMap();
+    std::mt19937 rng(cfg_.seed);
+    std::exponential_distribution<double> gap(cfg_.ordersPerHour > 0 ? cfg_.ordersPerHour / 3600000.0 : 1.0);
+    std::uniform_int_distribution<int> disX(1, std::max(1, map.GetWidth() - 2));
+    std::uniform_int_distribution<int> disY(1, std::max(1, map.GetHeight() - 2));
+
+    orders_.clear();
+    orders_.reserve(cfg_.orderCount);
+    double t = 0.0;
+    for (int i = 0; i < cfg_.orderCount; ++i) {
+        t += gap(rng);
+        SimOrder o;
+        o.arriveMs = static_cast<int64_t>(t);
+        for (int attempt = 0; attempt < 1000; ++attempt) {
+            o.target = {disX(rng), disY(rng)};
+            if (!map.IsObstacle(o.target)) break;
+        }
+        orders_.push_back(o);
+    }
+}
+
+// ================= 主循环 =================
+
+void FleetSimulator::Push(int64_t atUs, EvType type, int idx) {
+    events_.push({atUs, seq_++, type, idx});
+}
+
+// 防抖 : 距上一轮不足 minIntervalMs 则推迟到期 (与分片写者线程的节奏一致)
+void FleetSimulator::ScheduleDispatch() {
+    int64_t due = lastRoundUs_ + static_cast<int64_t>(dispatchCfg_.minIntervalMs) * 1000;
+    Push(std::max(nowUs_, due), EvType::DISPATCH, -1);
+    dispatchQueued_ = true;
+}
+
+SimReport FleetSimulator::Run() {
+    if (orders_.empty()) {
+        if (!cfg_.ordersFile.empty()) LoadOrders(cfg_.ordersFile);
+        else GenerateOrders();
+    }
+
+    // 1. 接管时钟与下发出口
+    startUs_ = SystemNowUs();
+    nowUs_ = startUs_;
+    g_simNowUs.store(nowUs_);
+    myreactor::Timestamp::setClock(&SimClock);
+
+    TaskMgr.SetDispatchSink([this](int agvId, const TaskRequest& req) {
+        return this->OnSend(agvId, req);
+    });
+    TaskMgr.Init(nullptr, dispatchCfg_);
+
+    // 2. 车辆上线
+    const GridMap& map = WorldMgr.GetGridMap();
+    std::vector<Point> spawns = map.GenerateSafeSpawnPoints(cfg_.agvCount);
+    agvs_.resize(cfg_.agvCount);
+    for (int i = 0; i < cfg_.agvCount; ++i) {
+        SimAgv& agv = agvs_[i];
+        agv.uid = 101 + i;
+        agv.pos = i < static_cast<int>(spawns.size()) ? spawns[i] : map.GetRandomWalkablePoint();
+        agvIndex_[agv.uid] = i;
+
+        LoginRequest req;
+        req.agvId = agv.uid;
+        req.version = "sim";
+        req.initialPos = agv.pos;
+        WorldMgr.OnAgvLogin(req);
+    }
+
+    // 3. 订单到达事件
+    for (size_t i = 0; i < orders_.size(); ++i) {
+        Push(startUs_ + orders_[i].arriveMs * 1000, EvType::ORDER, static_cast<int>(i));
+    }
+
+    // 4. 事件循环 : 时钟直接跳到下一个事件
+    const int64_t endUs = startUs_ + static_cast<int64_t>(cfg_.maxSimHours * 3600.0 * 1e6);
+    auto wallStart = std::chrono::steady_clock::now();
+
+    while (!events_.empty() && completed_ < orders_.size()) {
+        Event ev = events_.top();
+        if (ev.atUs > endUs) break;
+        events_.pop();
+
+        nowUs_ = ev.atUs;
+        g_simNowUs.store(nowUs_, std::memory_order_relaxed);
+
+        switch (ev.type) {
+            case EvType::ORDER:    HandleOrder(ev.idx); break;
+            case EvType::DISPATCH:
+                dispatchQueued_ = false;
+                lastRoundUs_ = nowUs_;
+                if (TaskMgr.RunPendingRound()) ++rounds_;
+                break;
+            case EvType::RECV:     HandleRecv(agvs_[ev.idx]); break;
+            case EvType::PLAN:     HandlePlan(agvs_[ev.idx]); break;
+            case EvType::STEP:     HandleStep(agvs_[ev.idx]); break;
+            case EvType::FINISH:   HandleFinish(agvs_[ev.idx]); break;
+        }
+        ++handled_;
+
+        if (!dispatchQueued_ && TaskMgr.HasPendingRound()) ScheduleDispatch();
+    }
+
+    double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    // 5. 收尾 : 仍在干活的车把忙碌时间记到结束时刻
+    for (SimAgv& agv : agvs_) {
+        if (agv.hasTask || !agv.queue.empty()) agv.busyTotalUs += nowUs_ - agv.busySinceUs;
+    }
+    SimReport report = BuildReport(wallSec);
+
+    for (const SimAgv& agv : agvs_) WorldMgr.OnAgvLogout(agv.uid);
+    TaskMgr.SetDispatchSink(nullptr);
+    myreactor::Timestamp::setClock(nullptr);
+    return report;
+}
+
+// ================= 事件处理 =================
+
+bool FleetSimulator::OnSend(int agvId, const TaskRequest& req) {
+    auto it = agvIndex_.find(agvId);
+    if (it == agvIndex_.end()) return false;
+
+    TaskTrace& tr = traces_[req.taskId];
+    if (tr.firstSentUs < 0) tr.firstSentUs = nowUs_;
+
+    SimAgv& agv = agvs_[it->second];
+    agv.inbox.push_back(req);
+    Push(nowUs_ + static_cast<int64_t>(cfg_.linkLatencyMs) * 1000, EvType::RECV, static_cast<int>(it->second));
+    return true;
+}
+
+void FleetSimulator::HandleOrder(int idx) {
+    const SimOrder& o = orders_[idx];
+    TaskHandle taskId = TaskMgr.AddTask(o.target, ActionType::NONE, o.priority);
+    traces_[taskId].arriveUs = nowUs_;
+}
+
+// 与 AgvSimulator 一致 : 手上有活就排队，否则立即开工
+void FleetSimulator::HandleRecv(SimAgv& agv) {
+    if (agv.inbox.empty()) return;  // 已被 ERROR 清空
+    TaskRequest req = agv.inbox.front();
+    agv.inbox.pop_front();
+
+    if (agv.hasTask) {
+        agv.queue.push_back(req);
+        return;
+    }
+    agv.busySinceUs = nowUs_;
+    StartTask(agv, req);
+}
+
+// 寻路请求走一个网络往返
+void FleetSimulator::StartTask(SimAgv& agv, const TaskRequest& req) {
+    agv.cur = req;
+    agv.hasTask = true;
+    agv.planFails = 0;
+    agv.path.clear();
+    agv.pathIdx = 0;
+    Push(nowUs_ + 2 * static_cast<int64_t>(cfg_.linkLatencyMs) * 1000, EvType::PLAN, static_cast<int>(&agv - agvs_.data()));
+}
+
+void FleetSimulator::HandlePlan(SimAgv& agv) {
+    if (!agv.hasTask) return;
+    const int idx = static_cast<int>(&agv - agvs_.data());
+
+    std::vector<Point> path = WorldMgr.PlanPath(agv.uid, agv.pos, agv.cur.targetPos);
+    if (!path.empty() && path.front() == agv.pos) path.erase(path.begin());
+
+    // 已在目标点
+    if (path.empty() && agv.pos == agv.cur.targetPos) {
+        Push(nowUs_ + static_cast<int64_t>(cfg_.actionTimeMs) * 1000, EvType::FINISH, idx);
+        return;
+    }
+
+    if (path.empty()) {
+        if (++agv.planFails <= cfg_.maxReplan) {
+            Push(nowUs_ + static_cast<int64_t>(cfg_.replanRetryMs) * 1000, EvType::PLAN, idx);
+            return;
+        }
+
+        // 放弃 : 上报 ERROR，服务器会把该单及其后续全部退回
+        Report(agv, AgvStatus::ERROR, 0.0, agv.cur.taskId);
+        ++failed_;
+        agv.hasTask = false;
+        agv.queue.clear();
+        agv.inbox.clear();
+        agv.busyTotalUs += nowUs_ - agv.busySinceUs;
+
+        // 恢复可派状态
+        Heartbeat hb;
+        hb.agvId = agv.uid;
+        hb.status = AgvStatus::IDLE;
+        hb.currentPos = agv.pos;
+        hb.battery = 100.0;
+        hb.timestamp = nowUs_ / 1000;
+        WorldMgr.OnHeartbeat(hb);
+        TaskMgr.TryDispatch();
+        return;
+    }
+
+    agv.path = std::move(path);
+    agv.pathIdx = 0;
+    Push(nowUs_ + static_cast<int64_t>(cfg_.cellTimeMs) * 1000, EvType::STEP, idx);
+}
+
+void FleetSimulator::HandleStep(SimAgv& agv) {
+    if (!agv.hasTask || agv.pathIdx >= agv.path.size()) return;
+    const int idx = static_cast<int>(&agv - agvs_.data());
+
+    agv.pos = agv.path[agv.pathIdx++];
+    double progress = static_cast<double>(agv.pathIdx) / static_cast<double>(agv.path.size());
+    Report(agv, AgvStatus::MOVING, progress, agv.cur.taskId);
+
+    if (agv.pathIdx >= agv.path.size()) {
+        Push(nowUs_ + static_cast<int64_t>(cfg_.actionTimeMs) * 1000, EvType::FINISH, idx);
+    }
+    else {
+        Push(nowUs_ + static_cast<int64_t>(cfg_.cellTimeMs) * 1000, EvType::STEP, idx);
+    }
+}
+
+void FleetSimulator::HandleFinish(SimAgv& agv) {
+    if (!agv.hasTask) return;
+
+    Report(agv, AgvStatus::IDLE, 1.0, agv.cur.taskId);
+    auto it = traces_.find(agv.cur.taskId);
+    if (it != traces_.end() && it->second.doneUs < 0) {
+        it->second.doneUs = nowUs_;
+        ++completed_;
+    }
+    agv.hasTask = false;
+    NextTask(agv);
+}
+
+// 接着做预推送过来的下一单; 没有则结束本段忙碌
+void FleetSimulator::NextTask(SimAgv& agv) {
+    if (!agv.queue.empty()) {
+        TaskRequest next = agv.queue.front();
+        agv.queue.pop_front();
+        StartTask(agv, next);
+        return;
+    }
+    agv.busyTotalUs += nowUs_ - agv.busySinceUs;
+}
+
+// 与 AgvSession::HandleTRepo 的顺序一致 : 先更新世界，再更新任务
+void FleetSimulator::Report(const SimAgv& agv, AgvStatus status, double progress, TaskHandle taskId) {
+    TaskReport msg;
+    msg.taskId = taskId;
+    msg.agvId = agv.uid;
+    msg.status = status;
+    msg.currentPos = agv.pos;
+    msg.progress = progress;
+    WorldMgr.OnTaskReport(msg);
+    TaskMgr.OnTaskReport(msg);
+}
+
+// ================= 统计 =================
+
+SimReport FleetSimulator::BuildReport(double wallSec) const {
+    SimReport r;
+    r.orders = orders_.size();
+    r.completed = completed_;
+    r.failed = failed_;
+    r.events = handled_;
+    r.dispatchRounds = rounds_;
+    r.simSec = static_cast<double>(nowUs_ - startUs_) / 1e6;
+    r.wallSec = wallSec;
+    r.speedup = wallSec > 0 ? r.simSec / wallSec : 0.0;
+
+    int64_t firstArrive = INT64_MAX, lastDone = startUs_;
+    std::vector<int64_t> waits, leads;
+    waits.reserve(traces_.size());
+    leads.reserve(traces_.size());
+    for (const auto& kv : traces_) {
+        const TaskTrace& t = kv.second;
+        firstArrive = std::min(firstArrive, t.arriveUs);
+        if (t.firstSentUs >= 0) waits.push_back(t.firstSentUs - t.arriveUs);
+        if (t.doneUs >= 0) {
+            leads.push_back(t.doneUs - t.arriveUs);
+            lastDone = std::max(lastDone, t.doneUs);
+        }
+    }
+
+    if (!leads.empty() && lastDone > firstArrive) {
+        r.makespanSec = static_cast<double>(lastDone - firstArrive) / 1e6;
+        r.tasksPerHour = static_cast<double>(completed_) / (r.makespanSec / 3600.0);
+    }
+
+    double span = r.makespanSec > 0 ? r.makespanSec : r.simSec;
+    if (span > 0 && !agvs_.empty()) {
+        int64_t busy = 0;
+        for (const SimAgv& agv : agvs_) busy += agv.busyTotalUs;
+        r.utilization = static_cast<double>(busy) / 1e6 / (span * static_cast<double>(agvs_.size()));
+    }
+
+    auto avg = [](const std::vector<int64_t>& v) {
+        if (v.empty()) return 0.0;
+        double sum = 0;
+        for (int64_t x : v) sum += static_cast<double>(x);
+        return sum / static_cast<double>(v.size()) / 1e6;
+    };
+    r.waitAvgSec = avg(waits);
+    r.leadAvgSec = avg(leads);
+    r.waitMaxSec = waits.empty() ? 0.0 : static_cast<double>(*std::max_element(waits.begin(), waits.end())) / 1e6;
+    r.waitP50Sec = Percentile(waits, 0.50);
+    r.waitP95Sec = Percentile(waits, 0.95);
+    r.leadP95Sec = Percentile(leads, 0.95);
+    return r;
+}
+
+void FleetSimulator::PrintReport(const SimReport& r) {
+    printf("==================== Fleet Simulation Report ====================\n");
+    printf("Orders         : %lu total, %lu completed, %lu failed attempts\n", r.orders, r.completed, r.failed);
+    printf("Makespan       : %.1f s\n", r.makespanSec);
+    printf("Throughput     : %.1f tasks/hour\n", r.tasksPerHour);
+    printf("Utilization    : %.1f %%\n", r.utilization * 100.0);
+    printf("Wait (s)       : avg %.2f  p50 %.2f  p95 %.2f  max %.2f   (arrive -> first dispatch)\n",
+           r.waitAvgSec, r.waitP50Sec, r.waitP95Sec, r.waitMaxSec);
+    printf("Lead time (s)  : avg %.2f  p95 %.2f   (arrive -> done)\n", r.leadAvgSec, r.leadP95Sec);
+    printf("Engine         : %lu events, %lu dispatch rounds\n", r.events, r.dispatchRounds);
+    printf("Clock          : %.1f s simulated in %.3f s wall  (x%.0f)\n", r.simSec, r.wallSec, r.speedup);
+    printf("==================================================================\n");
+}
+
+}
+}
@@ -0,0 +1,81 @@
+#include "sim/FleetSimulator.h"
+#include "config/ServerConfig.h"
+#include "config/ConfigLoader.h"
+#include "manager/TaskManager.h"
+#include "manager/WorldManager.h"
+#include "algo/scheduler/SchedulerFactory.h"
+#include "utils/Logger.h"
+#include <cstdio>
+#include <cstdlib>
+
+/*
+离线仿真入口 : 复用服务器的 config.json (map / scheduler / dispatch / sim 四段)
+用法: ./AgvFleetSim [config_path] [log_level] [orders_file]
+示例: ./AgvFleetSim ./config.json WARN ./orders.csv
+    默认日志级别为 WARN : 仿真一秒钟会产生上万条 INFO，打印本身就会成为瓶颈
+*/
+
+int main(int argc, char* argv[]) {
+    std::string configPath = "./config.json";
+    LogLevel logLevel = WARN;
+
+    if (argc > 1) {
+        configPath = argv[1];
+    }
+    if (argc > 2) {
+        std::string levelStr = argv[2];
+        if (levelStr == "DEBUG") logLevel = DEBUG;
+        else if (levelStr == "INFO") logLevel = INFO;
+        else if (levelStr == "WARN") logLevel = WARN;
+        else if (levelStr == "ERROR") logLevel = ERROR;
+        else if (levelStr == "FATAL") logLevel = FATAL;
+        else {
+            fprintf(stderr, "Invalid log level: %s. Using WARN.\n", levelStr.c_str());
+        }
+    }
+    Logger::Instance().SetLevel(logLevel);
+
+    agv::config::ServerConfig cfg;
+    if (!agv::config::ConfigLoader::Load(configPath, cfg)) {
+        LOG_WARN("Failed to load config from '%s'. Using default hardcoded settings.", configPath.c_str());
+    }
+    if (argc > 3) {
+        cfg.sim.ordersFile = argv[3];
+    }
+
+    // 1. 地图 (与 AgvServer::InitSysRes 一致)
+    // WorldMgr 宏依赖 agv 命名空间，全局作用域里直接取单例
+    auto& world = agv::manager::WorldManager::Instance();
+    bool res = false;
+    switch (cfg.map.type) {
+        case agv::config::MapType::DEFAULT:
+            res = world.Init();
+            break;
+        case agv::config::MapType::FILE:
+            res = world.Init(cfg.map.path);
+            break;
+        case agv::config::MapType::RANDOM:
+            res = world.Init(cfg.map.width, cfg.map.height, cfg.map.obstacleRatio);
+            break;
+    }
+    if (!res) {
+        LOG_FATAL("[Sim] Failed to initialize world map. MapType: %d", (int)cfg.map.type);
+        return 1;
+    }
+
+    // 2. 调度策略
+    auto schedCfg = cfg.scheduler;
+    TaskMgr.SetScheduler([schedCfg] { return agv::algo::scheduler::CreateScheduler(schedCfg); });
+
+    // 3. 仿真
+    agv::sim::FleetSimulator simulator(cfg.sim, cfg.dispatch);
+    if (!cfg.sim.ordersFile.empty() && !simulator.LoadOrders(cfg.sim.ordersFile)) {
+        return 1;
+    }
+    agv::sim::SimReport report = simulator.Run();
+
+    printf("Map: %dx%d, AGVs: %d, Scheduler type: %d\n",
+           world.GetGridMap().GetWidth(), world.GetGridMap().GetHeight(), cfg.sim.agvCount, (int)cfg.scheduler.type);
+    agv::sim::FleetSimulator::PrintReport(report);
+    return report.completed == report.orders ? 0 : 2;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdio>
+
+/*
+server/test 下独立小程序共用的断言
+    Check 打印一行 [PASS] / [FAIL] 并累计失败数，不中断 : 一次运行看到全部失败项
+    main 结尾 return agv::test::Result(); 有失败返回 1，ctest 据此判定
+*/
+
+namespace agv{
+namespace test{
+
+inline int& FailCount() {
+    static int fails = 0;
+    return fails;
+}
+
+inline void Check(bool ok, const char* what) {
+    std::printf("[%s] %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok) ++FailCount();
+}
+
+inline int Result() { return FailCount() == 0 ? 0 : 1; }
+
+}
+}
@@ -0,0 +1,141 @@
+// server/test/test_deadlock_detector.cpp
+// DeadlockDetector : 对向顶牛成环 -> 一辆让路其余等待、过期后轮换让路车、车一动环就散、重复重规划抑制、前车坏了的僵局只报一次
+// 时间全部由调用方给定，结果是确定的
+#include "TestCheck.h"
+#include "manager/DeadlockDetector.h"
+#include <vector>
+
+using namespace agv;
+using namespace agv::manager;
+using agv::test::Check;
+using model::Point;
+
+namespace {
+
+using Verdict = DeadlockDetector::Verdict;
+
+constexpr int kGridlockMs = 1000;
+constexpr int kReplanHoldMs = 500;
+
+void Place(DeadlockDetector& dd, int agvId, Point pos, int64_t nowMs, std::vector<DeadlockDetector::CycleEvent>& events) {
+    dd.OnMoves({{agvId, pos}}, nowMs, events);
+}
+
+}
+
+int main() {
+    // 10x10，四周是墙，内部 (1..8, 1..8) 可通行
+    GridMap map;
+    map.CreateDefaultMap();
+    std::vector<DeadlockDetector::CycleEvent> cycles;
+    std::vector<DeadlockDetector::GridlockEvent> gridlocks;
+
+    // 1. 两车对向顶牛 : 第二个请求成环，一辆 BACKOFF (ID 小的先让)，另一辆 HOLD 等它
+    {
+        DeadlockDetector dd;
+        dd.Configure(&map, true, kGridlockMs, kReplanHoldMs);
+        dd.OnMoves({{1, {3, 5}}, {2, {4, 5}}}, 0, cycles);
+        dd.OnPathPlanned(1, {{3, 5}, {4, 5}, {5, 5}});
+        dd.OnPathPlanned(2, {{4, 5}, {3, 5}, {2, 5}});
+
+        Verdict v1 = dd.OnPathRequest(1, 100, cycles);
+        Check(v1.kind == Verdict::PLAN && cycles.empty(), "single blocked request plans normally");
+
+        Verdict v2 = dd.OnPathRequest(2, 200, cycles);
+        Check(cycles.size() == 1 && cycles[0].members.size() == 2 && cycles[0].victim == 1, "head-on pair forms one cycle, lower id yields");
+        Check(v2.kind == Verdict::HOLD && v2.blocker == 1, "non-victim holds for the victim");
+
+        v1 = dd.OnPathRequest(1, 300, cycles);
+        Check(v1.kind == Verdict::BACKOFF && v1.side == cycles[0].side && !(v1.side == Point{4, 5}) && !map.IsObstacle(v1.side),
+              "victim backs off to a free side cell");
+        v2 = dd.OnPathRequest(2, 400, cycles);
+        Check(v2.kind == Verdict::HOLD && cycles.size() == 1, "repeated requests in a live cycle do not re-detect");
+
+        // 让路车迟迟不动 : 环过期，重判时换被选中次数少的车让路
+        v2 = dd.OnPathRequest(2, 200 + kGridlockMs, cycles);
+        Check(cycles.size() == 2 && cycles[1].victim == 2 && v2.kind == Verdict::BACKOFF, "expired cycle re-detected with the victim rotated");
+        v1 = dd.OnPathRequest(1, 300 + kGridlockMs, cycles);
+        Check(v1.kind == Verdict::HOLD && v1.blocker == 2, "former victim now holds");
+
+        // 2 号车退到侧格 : 环散掉，1 号车前方空了，两车都正常寻路，不再成环
+        Place(dd, 2, cycles[1].side, 400 + kGridlockMs, cycles);
+        v1 = dd.OnPathRequest(1, 500 + kGridlockMs, cycles);
+        v2 = dd.OnPathRequest(2, 500 + kGridlockMs, cycles);
+        Check(v1.kind == Verdict::PLAN && v2.kind == Verdict::PLAN && cycles.size() == 2, "moving out dissolves the cycle");
+
+        dd.CheckGridlock(100000, gridlocks);
+        Check(gridlocks.empty(), "no gridlock once the cycle is gone");
+        cycles.clear();
+    }
+
+    // 2. 不成环的重复重规划 : 同一堵车者同一格在 replanHoldMs 内再请求 -> HOLD，过了再放行一次
+    {
+        DeadlockDetector dd;
+        dd.Configure(&map, true, kGridlockMs, kReplanHoldMs);
+        dd.OnMoves({{1, {2, 2}}, {3, {3, 2}}}, 0, cycles);
+        dd.OnPathPlanned(1, {{2, 2}, {3, 2}, {4, 2}});
+
+        Verdict a = dd.OnPathRequest(1, 0, cycles);
+        Verdict b = dd.OnPathRequest(1, kReplanHoldMs - 1, cycles);
+        Verdict c = dd.OnPathRequest(1, kReplanHoldMs, cycles);
+        Check(a.kind == Verdict::PLAN && b.kind == Verdict::HOLD && b.blocker == 3 && c.kind == Verdict::PLAN,
+              "repeated replan against the same blocker is held for replanHoldMs");
+        Check(cycles.empty(), "parked blocker forms no cycle");
+
+        // 前方空了 : 出边作废，直接寻路
+        Place(dd, 3, {3, 3}, 600, cycles);
+        Check(dd.OnPathRequest(1, 700, cycles).kind == Verdict::PLAN, "cleared cell plans normally");
+        dd.CheckGridlock(100000, gridlocks);
+        Check(gridlocks.empty(), "no gridlock after the blocker left");
+    }
+
+    // 3. 僵局 : 链头 (9 号车) 坏在通道里，身后排了两辆车; 只报一次 (最长的链)，链头动了再堵才重新上报
+    {
+        DeadlockDetector dd;
+        dd.Configure(&map, true, kGridlockMs, kReplanHoldMs);
+        dd.OnMoves({{9, {5, 7}}, {4, {4, 7}}, {5, {3, 7}}}, 0, cycles);
+        dd.OnPathPlanned(4, {{4, 7}, {5, 7}, {6, 7}});
+        dd.OnPathPlanned(5, {{3, 7}, {4, 7}, {5, 7}});
+        dd.OnPathRequest(4, 100, cycles);
+        dd.OnPathRequest(5, 200, cycles);
+        Check(cycles.empty(), "a chain without a loop is not a cycle");
+
+        dd.CheckGridlock(100 + kGridlockMs - 1, gridlocks);
+        Check(gridlocks.empty(), "not reported before gridlockMs");
+
+        dd.CheckGridlock(200 + kGridlockMs, gridlocks);
+        Check(gridlocks.size() == 1, "dead chain head reported exactly once");
+        Check(gridlocks.size() == 1 && gridlocks[0].head == 9 && gridlocks[0].waiter == 5 && gridlocks[0].chainLen == 2
+              && gridlocks[0].headPos == Point{5, 7} && gridlocks[0].stillMs == 200 + kGridlockMs,
+              "event names the head and the longest chain");
+
+        dd.CheckGridlock(100000, gridlocks);
+        Check(gridlocks.size() == 1, "not re-reported while the head stays dead");
+
+        // 链头挪一格又坏了 : 4 号车改等新位置，重新计时后再报一次
+        Place(dd, 9, {6, 7}, 100000, cycles);
+        Place(dd, 4, {5, 7}, 100100, cycles);
+        dd.OnPathRequest(4, 100200, cycles);
+        dd.CheckGridlock(100200 + kGridlockMs, gridlocks);
+        Check(gridlocks.size() == 2 && gridlocks[1].head == 9 && gridlocks[1].waiter == 4 && gridlocks[1].chainLen == 1,
+              "head stuck again after moving is reported again");
+
+        // 链头下线 : 等待的格子空了，不再上报
+        dd.Remove(9);
+        dd.CheckGridlock(1000000, gridlocks);
+        Check(gridlocks.size() == 2, "removed head ends the gridlock");
+    }
+
+    // 4. 未启用 : 一律正常寻路
+    {
+        DeadlockDetector dd;
+        dd.Configure(&map, false, kGridlockMs, kReplanHoldMs);
+        dd.OnMoves({{1, {3, 5}}, {2, {4, 5}}}, 0, cycles);
+        dd.OnPathPlanned(1, {{3, 5}, {4, 5}});
+        dd.OnPathPlanned(2, {{4, 5}, {3, 5}});
+        bool plan = dd.OnPathRequest(1, 0, cycles).kind == Verdict::PLAN && dd.OnPathRequest(2, 0, cycles).kind == Verdict::PLAN;
+        Check(!dd.Enabled() && plan && cycles.empty(), "disabled detector always plans");
+    }
+
+    return agv::test::Result();
+}
@@ -0,0 +1,147 @@
+// server/test/test_fleet_state_store.cpp
+// FleetStateStore : 两个写者轮流改同一槽位 (每次写入的各字段互相对得上)，读者永远读不到写了一半的状态;
+//                   槽位回收给别的车之后，旧句柄读出来是离线，写不进去
+#include "TestCheck.h"
+#include "manager/FleetStateStore.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace agv;
+using namespace agv::manager;
+using agv::test::Check;
+
+namespace {
+
+// 第 k 次写入的完整状态 : 每个字段都由 k 算出
+void Fill(AgvState& st, int k) {
+    st.pos = {k, -k};
+    st.status = (k & 1) ? model::AgvStatus::MOVING : model::AgvStatus::IDLE;
+    st.battery = k * 0.5;
+    st.heartbeatMs = k * 10LL;
+    st.taskId.value = static_cast<uint64_t>(k) * 3;
+    st.progress = k * 0.25;
+    st.speed = k * 2.0;
+    st.lastMoveMs = k * 7LL;
+    st.pathLen = k;
+    std::memset(st.version, 'a' + k % 26, AgvState::kVersionLen - 1);
+    st.version[AgvState::kVersionLen - 1] = '\0';
+}
+
+bool Consistent(const AgvState& st, int uid) {
+    AgvState expect;
+    Fill(expect, st.pathLen);
+    return st.uid == uid && st.pos == expect.pos && st.status == expect.status && st.battery == expect.battery
+        && st.heartbeatMs == expect.heartbeatMs && st.taskId.value == expect.taskId.value
+        && st.progress == expect.progress && st.speed == expect.speed && st.lastMoveMs == expect.lastMoveMs
+        && std::memcmp(st.version, expect.version, AgvState::kVersionLen) == 0;
+}
+
+AgvState Initial(int uid) {
+    AgvState st;
+    st.uid = uid;
+    Fill(st, 0);
+    return st;
+}
+
+}
+
+int main() {
+    FleetStateStore store;
+
+    // 1. 基本读写 : 登录覆盖整槽，Update 读-改-写，占用扫描跳过自己
+    const AgvSlot a = SlotTbl.Acquire(1);
+    const AgvSlot b = SlotTbl.Acquire(2);
+    store.Reset(a, Initial(1));
+    store.Reset(b, Initial(2));
+    {
+        AgvState st;
+        Check(store.Read(a, st) && Consistent(st, 1) && st.pathLen == 0, "reset state read back");
+
+        uint64_t stamp = store.WriteStamp();
+        Check(store.Update(b, [](AgvState& s) { Fill(s, 5); }), "update on a live slot");
+        Check(store.WriteStamp() != stamp, "write stamp moves on every write");
+        Check(store.Read(b, st) && Consistent(st, 2) && st.pathLen == 5, "update visible to readers");
+        Check(store.Status(b) == model::AgvStatus::MOVING, "status read from the hot line");
+
+        Check(store.AnyAt({5, -5}, 1) && !store.AnyAt({5, -5}, 2) && !store.AnyAt({6, -6}, 1), "occupancy scan skips self");
+        int online = 0;
+        store.ForEachOnline([&](const AgvState&) { ++online; });
+        Check(online == 2, "both agvs listed online");
+    }
+
+    // 2. 压测 : 两个写者对同一槽位做 pathLen + 1 并按新值改写所有字段，读者检查快照前后一致
+    {
+        const int kWriters = 2, kReaders = 2, kWrites = 50000;
+        std::atomic<bool> stop{false};
+        std::atomic<int> started{0};
+        std::atomic<uint64_t> reads{0}, torn{0}, missing{0}, backwards{0};
+
+        std::vector<std::thread> readers;
+        for (int r = 0; r < kReaders; ++r) {
+            readers.emplace_back([&]() {
+                started.fetch_add(1);
+                AgvState st;
+                int last = 0;
+                uint64_t n = 0;
+                while (!stop.load(std::memory_order_acquire)) {
+                    if (!store.Read(a, st)) { missing.fetch_add(1); continue; }
+                    if (!Consistent(st, 1)) torn.fetch_add(1);
+                    if (st.pathLen < last) backwards.fetch_add(1);
+                    last = st.pathLen;
+                    ++n;  // 不主动让出 : 单核机器上读者只会在时钟中断时被切走，正好落在读字段的中途
+                }
+                reads.fetch_add(n);
+            });
+        }
+        while (started.load() < kReaders) std::this_thread::yield();
+
+        std::vector<std::thread> writers;
+        for (int w = 0; w < kWriters; ++w) {
+            writers.emplace_back([&]() {
+                for (int i = 0; i < kWrites; ++i) {
+                    store.Update(a, [](AgvState& s) { Fill(s, s.pathLen + 1); });
+                    if (i % 16 == 0) std::this_thread::yield();
+                }
+            });
+        }
+        for (auto& t : writers) t.join();
+        stop.store(true, std::memory_order_release);
+        for (auto& t : readers) t.join();
+
+        AgvState st;
+        std::printf("[INFO] %llu reads during %d writes\n", (unsigned long long)reads.load(), kWriters * kWrites);
+        Check(torn.load() == 0, "readers never see a half-written state");
+        Check(missing.load() == 0, "live slot always readable");
+        Check(backwards.load() == 0, "readers see writes in order");
+        Check(store.Read(a, st) && st.pathLen == kWriters * kWrites && Consistent(st, 1), "concurrent writers never lose an update");
+    }
+
+    // 3. 槽位回收 : 1 号车下线，槽位用满后回收给新车 (代数 +2); 1 号车的旧句柄读出来是离线，写不进，也下线不了新车
+    {
+        store.Remove(a);
+        SlotTbl.Release(1);
+        AgvState st;
+        Check(!store.Read(a, st) && store.Status(a) == model::AgvStatus::UNKNOWN, "removed agv reads offline");
+
+        for (int id = 1000; SlotTbl.Size() < AgvSlotTable::kMaxSlots; ++id) SlotTbl.Acquire(id);
+        const AgvSlot c = SlotTbl.Acquire(99999);
+        Check(c.Valid() && c.index == a.index && c.gen == a.gen + 2, "offline slot recycled with a new generation");
+        store.Reset(c, Initial(99999));
+
+        Check(!store.Read(a, st), "stale handle reads offline after recycle");
+        Check(store.Status(a) == model::AgvStatus::UNKNOWN, "stale handle status is UNKNOWN");
+        Check(!store.Update(a, [](AgvState& s) { Fill(s, 77); }), "stale handle update rejected");
+        store.Remove(a);
+        Check(store.Read(c, st) && Consistent(st, 99999) && st.pathLen == 0, "new owner untouched by the stale handle");
+
+        int online = 0;
+        bool onlyNew = true;
+        store.ForEachOnline([&](const AgvState& s) { ++online; onlyNew = onlyNew && s.uid != 1; });
+        Check(online == 2 && onlyNew, "recycled slot listed once, under the new owner");
+    }
+
+    return agv::test::Result();
+}
@@ -0,0 +1,166 @@
+// server/test/test_gemm.cpp
+// 推理内核 : GemmBias / MlpPolicy::Forward 与朴素 (double 累加) 实现对拍，形状取奇数、跨 4 行组与 K 分块边界
+// 同一源文件编两份 : test_gemm 用默认内核，test_gemm_avx2 把 Gemm.cpp 按 AVX2+FMA 编译 (CPU 不支持时跳过)
+#include "TestCheck.h"
+#include "algo/infer/Gemm.h"
+#include "algo/infer/MlpPolicy.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace agv::algo::infer;
+using agv::test::Check;
+
+namespace {
+
+std::mt19937 g_rng(11);
+
+std::vector<float> Random(size_t n) {
+    std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+    std::vector<float> v(n);
+    for (auto& x : v) x = d(g_rng);
+    return v;
+}
+
+// 误差按 Σ|a·b| 放缩 : 与累加顺序 / 是否 FMA 无关的上界
+bool Close(float got, double ref, double mag) {
+    return std::fabs(got - ref) <= 1e-5 * mag + 1e-6;
+}
+
+// C = A·B + bias，对每个输出元素比较
+bool GemmMatches(int M, int N, int K, bool withBias) {
+    std::vector<float> A = Random(size_t(M) * K), B = Random(size_t(K) * N), bias = Random(N);
+    std::vector<float> C(size_t(M) * N, 12345.0f);  // 脏数据 : 内核必须先用 bias / 0 覆盖
+    GemmBias(A.data(), B.data(), withBias ? bias.data() : nullptr, C.data(), M, N, K);
+
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < N; ++j) {
+            double ref = withBias ? bias[j] : 0.0, mag = std::fabs(ref);
+            for (int k = 0; k < K; ++k) {
+                double p = double(A[size_t(i) * K + k]) * B[size_t(k) * N + j];
+                ref += p;
+                mag += std::fabs(p);
+            }
+            if (!Close(C[size_t(i) * N + j], ref, mag)) {
+                std::printf("[INFO] GemmBias %dx%dx%d mismatch at (%d,%d): %f vs %f\n", M, N, K, i, j, C[size_t(i) * N + j], ref);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename T>
+void Put(std::ofstream& ofs, T v) { ofs.write(reinterpret_cast<const char*>(&v), sizeof(T)); }
+
+// 朴素 MLP : 权重按文件里的 [out][in] 布局保存
+struct RefLayer {
+    int in, out;
+    Activation act;
+    std::vector<float> w, b;
+};
+
+void WriteModel(const std::string& path, const std::vector<RefLayer>& layers) {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    Put<uint32_t>(ofs, MlpPolicy::kMagic);
+    Put<uint32_t>(ofs, MlpPolicy::kVersion);
+    Put<uint32_t>(ofs, layers.front().in);
+    Put<uint32_t>(ofs, layers.size());
+    Put<float>(ofs, 50.0f);
+    Put<float>(ofs, 60.0f);
+    Put<float>(ofs, 100.0f);
+    for (const auto& l : layers) {
+        Put<uint32_t>(ofs, l.in);
+        Put<uint32_t>(ofs, l.out);
+        Put<uint32_t>(ofs, static_cast<uint32_t>(l.act));
+        for (float v : l.w) Put<float>(ofs, v);
+        for (float v : l.b) Put<float>(ofs, v);
+    }
+}
+
+// 返回每一行的 (参考值, 误差尺度)
+void RefForward(const std::vector<RefLayer>& layers, const std::vector<float>& x, int rows,
+                std::vector<double>& ref, std::vector<double>& mag) {
+    ref.assign(rows, 0.0);
+    mag.assign(rows, 0.0);
+    for (int r = 0; r < rows; ++r) {
+        std::vector<double> cur(x.begin() + size_t(r) * layers.front().in, x.begin() + size_t(r + 1) * layers.front().in);
+        double scale = 0.0;
+        for (const auto& l : layers) {
+            std::vector<double> next(l.out);
+            for (int o = 0; o < l.out; ++o) {
+                double s = l.b[o];
+                for (int i = 0; i < l.in; ++i) {
+                    s += double(l.w[size_t(o) * l.in + i]) * cur[i];
+                    scale += std::fabs(double(l.w[size_t(o) * l.in + i]) * cur[i]);
+                }
+                if (l.act == Activation::RELU) s = s > 0.0 ? s : 0.0;
+                else if (l.act == Activation::TANH) s = std::tanh(s);
+                next[o] = s;
+            }
+            cur.swap(next);
+        }
+        ref[r] = cur[0];
+        mag[r] = scale;
+    }
+}
+
+}
+
+int main() {
+    // 当前二进制若带 AVX2 内核而 CPU 不支持，直接跳过 (不算失败)
+    const char* kernel = GemmKernelName();
+    if (std::strncmp(kernel, "AVX2", 4) == 0 && !(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))) {
+        std::printf("[SKIP] %s kernel not supported by this CPU\n", kernel);
+        return 0;
+    }
+    std::printf("[INFO] kernel: %s\n", kernel);
+
+    // 1. GemmBias : 奇数形状 + 4 行组余数 + K 跨 128 分块 + N 跨 8 宽向量余数
+    {
+        const int shapes[][3] = {
+            {7, 13, 37}, {37, 13, 7}, {1, 1, 1}, {3, 7, 5}, {4, 8, 128},
+            {5, 17, 129}, {9, 33, 300}, {13, 1, 257}, {64, 64, 8}};
+        bool ok = true;
+        for (const auto& s : shapes) ok = GemmMatches(s[0], s[1], s[2], true) && ok;
+        Check(ok, "GemmBias matches naive reference (with bias)");
+        Check(GemmMatches(7, 13, 37, false) && GemmMatches(6, 9, 131, false), "GemmBias matches naive reference (no bias)");
+    }
+
+    // 2. MlpPolicy::Forward : 7 -> 13 (RELU) -> 37 (TANH) -> 1，行数覆盖 1 / 不足 4 行 / 整组 / 奇数
+    {
+        const int dims[] = {7, 13, 37, 1};
+        const Activation acts[] = {Activation::RELU, Activation::TANH, Activation::NONE};
+        std::vector<RefLayer> layers;
+        for (int l = 0; l < 3; ++l)
+            layers.push_back({dims[l], dims[l + 1], acts[l], Random(size_t(dims[l]) * dims[l + 1]), Random(dims[l + 1])});
+
+        const std::string path = "./test_gemm.model";
+        WriteModel(path, layers);
+        MlpPolicy policy;
+        Check(policy.Load(path) && policy.InputDim() == 7, "odd-shaped model loaded");
+        std::remove(path.c_str());
+
+        bool ok = policy.IsLoaded();
+        std::vector<float> out;
+        std::vector<double> ref, mag;
+        for (int rows : {1, 3, 4, 7, 37, 1}) {  // 末尾再跑 1 行 : 缓冲区复用后结果不受上一批残留影响
+            std::vector<float> x = Random(size_t(rows) * 7);
+            policy.Forward(x.data(), rows, out);
+            RefForward(layers, x, rows, ref, mag);
+            ok = ok && out.size() == size_t(rows);
+            for (int r = 0; ok && r < rows; ++r) {
+                ok = Close(out[r], ref[r], mag[r]);
+                if (!ok) std::printf("[INFO] Forward rows=%d mismatch at %d: %f vs %f\n", rows, r, out[r], ref[r]);
+            }
+        }
+        Check(ok, "MlpPolicy::Forward matches naive reference");
+    }
+
+    return agv::test::Result();
+}
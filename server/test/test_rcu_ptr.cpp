@@ -0,0 +1,93 @@
+// server/test/test_rcu_ptr.cpp
+// RcuPtr : 多读者 + 一个写者反复发布，读者永远看不到 已过宽限期被回收 / 写了一半 的对象
+#include "TestCheck.h"
+#include "utils/RcuPtr.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using agv::test::Check;
+
+namespace {
+
+constexpr uint64_t kLive = 0x11FE11FE11FE11FEull;
+
+struct Snap {
+    uint64_t magic = kLive;
+    uint64_t version = 0;
+    std::vector<uint64_t> cells;  // 每个元素都等于 version
+};
+
+std::unique_ptr<Snap> Make(uint64_t version) {
+    auto s = std::make_unique<Snap>();
+    s->version = version;
+    s->cells.assign(16, version);
+    return s;
+}
+
+}
+
+int main() {
+    // 1. 单线程 : Exchange 交回的就是上一个对象
+    {
+        RcuPtr<Snap> rcu(Make(1));
+        Check(rcu.Read()->version == 1, "reader sees initial object");
+        auto old = rcu.Exchange(Make(2));
+        Check(old && old->version == 1 && rcu.Read()->version == 2 && rcu.Peek()->version == 2,
+              "exchange returns the previous object and publishes the next");
+    }
+
+    // 2. 压测 : 写者每次回收前先把旧对象 “毒化”，读者在守卫内看到毒化值 = 宽限期没守住
+    RcuPtr<Snap> rcu(Make(0));
+    const int kReaders = 6;
+    const uint64_t kVersions = 2000;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0}, poisoned{0}, torn{0}, backwards{0};
+    std::atomic<int> started{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < kReaders; ++r) {
+        readers.emplace_back([&]() {
+            uint64_t last = 0, n = 0;
+            started.fetch_add(1, std::memory_order_release);
+            while (!stop.load(std::memory_order_acquire)) {
+                auto snap = rcu.Read();
+                uint64_t v = snap->version;
+                // 每隔几次在临界区里让出 CPU : 让写者在读者持有旧对象期间发布 + 回收 (单核机器上也能交错)
+                if (++n % 8 == 0) std::this_thread::yield();
+                if (snap->magic != kLive) poisoned.fetch_add(1, std::memory_order_relaxed);
+                for (uint64_t c : snap->cells)
+                    if (c != v) { torn.fetch_add(1, std::memory_order_relaxed); break; }
+                if (v < last) backwards.fetch_add(1, std::memory_order_relaxed);  // 单写者发布，版本只增不减
+                last = v;
+            }
+            reads.fetch_add(n, std::memory_order_relaxed);
+        });
+    }
+
+    while (started.load(std::memory_order_acquire) < kReaders)
+        std::this_thread::yield();
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t v = 1; v <= kVersions; ++v) {
+        auto old = rcu.Exchange(Make(v));
+        old->magic = 0;  // 宽限期已过 : 没有读者还拿着它
+        for (auto& c : old->cells) c = ~c;
+        std::this_thread::yield();
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    stop.store(true, std::memory_order_release);
+    for (auto& t : readers) t.join();
+
+    std::printf("[INFO] %d readers, %llu reads, %llu publishes in %.1fms (%.2fus per grace period)\n",
+                kReaders, (unsigned long long)reads.load(), (unsigned long long)kVersions, ms, ms * 1000.0 / kVersions);
+    Check(poisoned.load() == 0, "no reader saw a reclaimed object");
+    Check(torn.load() == 0, "no reader saw a half-built object");
+    Check(backwards.load() == 0, "each reader sees versions in publish order");
+    Check(rcu.Read()->version == kVersions, "last published object is current");
+
+    return agv::test::Result();
+}
@@ -0,0 +1,189 @@
+// server/test/test_reservation_table.cpp
+// ReservationTable : 连续性检查、幂等重试、allOrNothing 只回滚这一批、驶离释放、下线释放、两车对向抢同一条通道
+#include "TestCheck.h"
+#include "manager/ReservationTable.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace agv;
+using namespace agv::manager;
+using agv::test::Check;
+using model::Point;
+
+namespace {
+
+// 第 y 行从 x0 到 x1 (含两端，可倒序)
+std::vector<Point> Row(int y, int x0, int x1) {
+    std::vector<Point> path;
+    int step = x0 <= x1 ? 1 : -1;
+    for (int x = x0; x != x1 + step; x += step) path.push_back({x, y});
+    return path;
+}
+
+bool OwnedBy(const ReservationTable& table, const std::vector<Point>& cells, int agvId) {
+    for (const auto& p : cells)
+        if (table.Owner(p) != agvId) return false;
+    return true;
+}
+
+}
+
+int main() {
+    // 10x10，四周是墙，内部 (1..8, 1..8) 可通行
+    GridMap map;
+    map.CreateDefaultMap();
+    ReservationTable table;
+    table.Reset(&map);
+    Check(table.Enabled(), "table enabled after reset");
+
+    const AgvSlot s1{0, 0}, s2{1, 0}, s3{2, 0};
+
+    // 1. 正常申请 + 幂等重试 : 已经是自己的格子算成功，车道里不重复记
+    {
+        auto path = Row(1, 2, 4);
+        auto r = table.Claim(1, s1, {1, 1}, path, true);
+        Check(r.all && r.granted == 3 && OwnedBy(table, path, 1), "claim grants the whole path");
+        r = table.Claim(1, s1, {1, 1}, path, true);
+        Check(r.all && r.granted == 3 && OwnedBy(table, path, 1), "re-claim of own cells is idempotent");
+        Check(table.ReleaseBehind(1, s1, {4, 1}) == 2 && table.Owner({4, 1}) == 1, "re-claim does not duplicate lane cells");
+        Check(table.ReleaseAll(1, s1) == 1, "one cell left after driving ahead");
+    }
+
+    // 2. 连续性 : 首格须是脚下格或其邻格，之后逐格相邻; 障碍物 / 越界按冲突处理
+    {
+        auto r = table.Claim(1, s1, {1, 1}, {{3, 1}, {4, 1}}, false);
+        Check(r.granted == 0 && !r.all && r.conflictAgv == -1 && r.conflictCell == Point{3, 1},
+              "first cell must touch the current cell");
+        r = table.Claim(1, s1, {1, 1}, {{1, 1}, {2, 1}}, false);
+        Check(r.all && r.granted == 2, "first cell may be the current cell");
+        r = table.Claim(1, s1, {2, 1}, {{3, 1}, {4, 1}, {6, 1}, {7, 1}}, false);
+        Check(r.granted == 2 && !r.all && r.conflictCell == Point{6, 1} && table.Owner({6, 1}) == -1,
+              "gap in the path stops the claim (prefix kept)");
+        r = table.Claim(1, s1, {4, 1}, {{4, 0}}, false);
+        Check(r.granted == 0 && r.conflictAgv == -1 && table.Owner({4, 0}) == -1, "obstacle cell rejected");
+        r = table.Claim(1, s1, {1, 1}, {{1, 1}, {2, 2}}, false);
+        Check(r.granted == 1 && r.conflictCell == Point{2, 2}, "diagonal step is not adjacent");
+        table.ReleaseAll(1, s1);
+    }
+
+    // 3. allOrNothing : 只回滚这一批新拿到的格子，之前就持有的保持不动
+    {
+        table.Claim(1, s1, {1, 3}, Row(3, 2, 3), true);
+        table.Claim(2, s2, {7, 3}, Row(3, 6, 6), true);
+
+        auto r = table.Claim(1, s1, {1, 3}, Row(3, 2, 7), true);
+        Check(r.granted == 0 && !r.all && r.conflictAgv == 2 && r.conflictCell == Point{6, 3}, "conflict reported with owner");
+        Check(OwnedBy(table, Row(3, 2, 3), 1), "cells held before the batch survive rollback");
+        Check(OwnedBy(table, Row(3, 4, 5), -1), "cells fresh in the batch are rolled back");
+        Check(table.Owner({6, 3}) == 2, "other agv's cell untouched");
+
+        r = table.Claim(1, s1, {1, 3}, Row(3, 2, 7), false);
+        Check(r.granted == 4 && !r.all && r.conflictAgv == 2 && OwnedBy(table, Row(3, 2, 5), 1),
+              "without allOrNothing the prefix before the conflict is kept");
+
+        // 别人的格子放不掉
+        Check(table.Release(2, s2, Row(3, 2, 5)) == 0 && OwnedBy(table, Row(3, 2, 5), 1), "release skips cells of others");
+        Check(table.Release(1, s1, Row(3, 4, 5)) == 2 && OwnedBy(table, Row(3, 4, 5), -1), "release frees own cells");
+        table.ReleaseAll(1, s1);
+        table.ReleaseAll(2, s2);
+    }
+
+    // 4. 驶离 : 位置推进到车道第 k 格时放掉前 k 格; 不在车道上 / 别的车报的位置不动
+    {
+        auto path = Row(5, 2, 7);
+        table.Claim(1, s1, {1, 5}, path, true);
+        Check(table.ReleaseBehind(1, s1, {1, 1}) == 0 && OwnedBy(table, path, 1), "position off the lane keeps everything");
+        Check(table.ReleaseBehind(2, s1, {4, 5}) == 0 && OwnedBy(table, path, 1), "another agv cannot release through the slot");
+        Check(table.ReleaseBehind(1, s1, {4, 5}) == 2 && OwnedBy(table, Row(5, 2, 3), -1) && OwnedBy(table, Row(5, 4, 7), 1),
+              "cells behind the new position released");
+        Check(table.ReleaseBehind(1, s1, {4, 5}) == 0, "same position twice releases nothing more");
+        Check(table.ReleaseBehind(1, s1, {7, 5}) == 3 && table.Owner({7, 5}) == 1, "reaching the lane end keeps only the current cell");
+    }
+
+    // 5. 下线 : 放掉这辆车的所有格子 (包括不在车道里的)，别的车不受影响; 槽位给下一辆车后车道作废
+    {
+        table.Claim(1, s1, {7, 5}, {{7, 6}, {7, 7}}, true);
+        table.Claim(3, s3, {1, 8}, Row(8, 2, 4), true);
+        Check(table.ReleaseAll(1, s1) == 3, "logout releases every cell of the agv");
+        Check(table.Owner({7, 5}) == -1 && table.Owner({7, 7}) == -1 && OwnedBy(table, Row(8, 2, 4), 3), "other agv keeps its cells");
+
+        // 同一槽位换成 4 号车 : 1 号车的旧车道不会被 4 号车的驶离误放
+        table.Claim(4, s1, {1, 6}, Row(6, 2, 4), true);
+        Check(table.ReleaseBehind(1, s1, {3, 6}) == 0 && OwnedBy(table, Row(6, 2, 4), 4), "stale agv id on a reused slot ignored");
+        Check(table.ReleaseBehind(4, s1, {3, 6}) == 1 && table.Owner({2, 6}) == -1, "new owner of the slot drives normally");
+        table.ReleaseAll(3, s3);
+        table.ReleaseAll(4, s1);
+
+        bool empty = true;
+        for (int y = 0; y < map.GetHeight(); ++y)
+            for (int x = 0; x < map.GetWidth(); ++x) empty = empty && table.Owner({x, y}) == -1;
+        Check(empty, "table empty after all agvs logged out");
+    }
+
+    // 6. 单次耗时 : 8 格 allOrNothing 申请 + 按路径释放; 全是自己格子的重试
+    {
+        auto path = Row(2, 1, 8);
+        const int kRounds = 200000;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kRounds; ++i) {
+            table.Claim(1, s1, {1, 2}, path, true);
+            table.Release(1, s1, path);
+        }
+        table.Claim(1, s1, {1, 2}, path, true);
+        auto t1 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kRounds; ++i) table.Claim(1, s1, {1, 2}, path, true);
+        auto t2 = std::chrono::steady_clock::now();
+        table.ReleaseAll(1, s1);
+        std::printf("[INFO] 8-cell claim+release: %.3fus, 8-cell idempotent re-claim: %.3fus\n",
+                    std::chrono::duration<double, std::micro>(t1 - t0).count() / kRounds,
+                    std::chrono::duration<double, std::micro>(t2 - t1).count() / kRounds);
+    }
+
+    // 7. 两车对向抢同一条通道 (allOrNothing) : 任何时刻最多一辆车拿着整条通道，失败的一方什么都不留
+    {
+        GridMap wide;
+        wide.CreateRandomMap(64, 8, 0.0);  // 只有四周围墙
+        ReservationTable shared;
+        shared.Reset(&wide);
+
+        const auto east = Row(4, 2, 60), west = Row(4, 60, 2);
+        const int kRounds = 20000;
+        std::atomic<int> holders{0}, overlap{0}, leaked{0};
+        std::atomic<int> wins[2] = {{0}, {0}};
+        std::atomic<int> ready{0};
+
+        auto run = [&](int agvId, AgvSlot slot, Point from, const std::vector<Point>& path) {
+            ready.fetch_add(1);
+            while (ready.load() < 2) std::this_thread::yield();
+            for (int i = 0; i < kRounds; ++i) {
+                auto r = shared.Claim(agvId, slot, from, path, true);
+                if (r.all) {
+                    if (holders.fetch_add(1) != 0) overlap.fetch_add(1);
+                    if (!OwnedBy(shared, path, agvId)) overlap.fetch_add(1);
+                    wins[agvId].fetch_add(1);
+                    if (i % 4 == 0) std::this_thread::yield();  // 拿着通道时让出 CPU : 单核上也让对方撞上
+                    holders.fetch_sub(1);
+                    shared.Release(agvId, slot, path);
+                } else {
+                    if (r.granted != 0 || (r.conflictAgv != 1 - agvId)) leaked.fetch_add(1);
+                    std::this_thread::yield();
+                }
+            }
+        };
+        std::thread a(run, 0, AgvSlot{0, 0}, Point{1, 4}, std::cref(east));
+        std::thread b(run, 1, AgvSlot{1, 0}, Point{61, 4}, std::cref(west));
+        a.join();
+        b.join();
+
+        std::printf("[INFO] contention: agv0 won %d, agv1 won %d of %d rounds each\n", wins[0].load(), wins[1].load(), kRounds);
+        Check(overlap.load() == 0, "never both agvs hold the corridor");
+        Check(leaked.load() == 0, "losing claim keeps nothing and names the winner");
+        Check(wins[0].load() > 0 && wins[1].load() > 0, "both agvs get through");
+        Check(OwnedBy(shared, east, -1), "corridor free after both released");
+    }
+
+    return agv::test::Result();
+}
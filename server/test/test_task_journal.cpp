@@ -0,0 +1,146 @@
+// server/test/test_task_journal.cpp
+// TaskJournal : 写入 -> 重放、残缺尾部截断后继续追加、压缩前后重放结果一致
+#include "TestCheck.h"
+#include "manager/TaskJournal.h"
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace agv;
+using namespace agv::manager;
+using agv::test::Check;
+
+namespace {
+
+model::TaskHandle Handle(uint64_t v) {
+    model::TaskHandle h;
+    h.value = v;
+    return h;
+}
+
+model::TaskRequest Request(uint64_t id, int x, int y, int priority) {
+    model::TaskRequest req;
+    req.taskId = Handle(id);
+    req.targetAgvId = -1;
+    req.targetPos = {x, y};
+    req.targetAct = model::ActionType::NONE;
+    req.priority = priority;
+    return req;
+}
+
+int64_t FileSize(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 ? static_cast<int64_t>(st.st_size) : -1;
+}
+
+// 用一个新的 TaskJournal 重放，按任务句柄索引
+std::map<uint64_t, RecoveredTask> Replay(const config::JournalConfig& cfg) {
+    TaskJournal journal(cfg);
+    std::vector<RecoveredTask> out;
+    journal.Recover(out);
+    std::map<uint64_t, RecoveredTask> byId;
+    for (const auto& r : out) byId[r.req.taskId.value] = r;
+    return byId;
+}
+
+}
+
+int main() {
+    config::JournalConfig cfg;
+    cfg.enable = true;
+    cfg.path = "./test_task_journal.journal";
+    cfg.groupCommitMs = 5;
+    cfg.compactMb = 1;
+    std::remove(cfg.path.c_str());
+
+    // 1. 写入 -> 重放 : 新建 / 下发 / 进度 / 完成 / 回滚 / 改优先级
+    {
+        TaskJournal journal(cfg);
+        std::vector<RecoveredTask> none;
+        Check(journal.Recover(none) && none.empty(), "missing journal recovers as empty");
+        Check(journal.Start(), "journal started");
+        for (uint64_t id = 1; id <= 4; ++id) journal.Created(Request(id, int(id), int(id * 10), 1), 1000 + int64_t(id));
+        journal.Dispatched(Handle(1), 7);
+        journal.Progress(Handle(1), 7, 0.5);
+        journal.Dispatched(Handle(2), 8);
+        journal.Done(Handle(2), 8);
+        journal.Dispatched(Handle(3), 9);
+        journal.RolledBack(Handle(3), 1);
+        journal.Priority(Handle(4), 3);
+        journal.Stop();
+    }
+    const int64_t fullBytes = FileSize(cfg.path);
+    Check(fullBytes == 11 * int64_t(sizeof(JournalRecord)), "all records written");
+
+    auto live = Replay(cfg);
+    Check(live.size() == 3 && live.count(2) == 0, "done task not recovered");
+    Check(live.count(1) && live[1].agvId == 7 && live[1].progress == 0.5f
+          && live[1].req.targetPos.x == 1 && live[1].req.targetPos.y == 10 && live[1].createdMs == 1001,
+          "running task keeps agv, progress, target and create time");
+    Check(live.count(3) && live[3].agvId == -1 && live[3].progress == 0.0f, "rolled-back task is pending again");
+    Check(live.count(4) && live[4].req.priority == 3, "priority change replayed");
+
+    // 2. 残缺尾部 : 截在最后一条 (改优先级) 中间，重放丢掉这半条并把文件截回记录边界
+    Check(::truncate(cfg.path.c_str(), fullBytes - 17) == 0, "file truncated mid-record");
+    live = Replay(cfg);
+    Check(live.size() == 3 && live.count(4) && live[4].req.priority == 1, "torn record ignored, earlier records kept");
+    Check(FileSize(cfg.path) == fullBytes - int64_t(sizeof(JournalRecord)), "torn tail truncated to record boundary");
+
+    // 截断之后继续追加 : 新记录接在完好的边界上，重放能看到
+    {
+        TaskJournal journal(cfg);
+        std::vector<RecoveredTask> out;
+        journal.Recover(out);
+        journal.Start();
+        journal.Done(Handle(1), 7);
+        journal.Created(Request(5, 5, 50, 2), 1005);
+        journal.Stop();
+    }
+    live = Replay(cfg);
+    Check(live.size() == 3 && live.count(1) == 0 && live.count(5) && live[5].req.targetPos.y == 50,
+          "records appended after truncation are replayed");
+
+    // 3. 压缩 : 超过 compactMb 后按影子状态重写，重放结果与压缩前一致
+    std::map<uint64_t, RecoveredTask> expect;
+    {
+        TaskJournal journal(cfg);
+        std::vector<RecoveredTask> out;
+        journal.Recover(out);
+        journal.Start();
+        const uint64_t kTasks = 2000;
+        for (uint64_t id = 100; id < 100 + kTasks; ++id) {
+            journal.Created(Request(id, int(id % 97), int(id % 89), int(id % 3)), 2000 + int64_t(id));
+            journal.Dispatched(Handle(id), int(id % 50));
+            for (int k = 1; k <= 12; ++k) journal.Progress(Handle(id), int(id % 50), k / 16.0);  // 进度停在 0.75
+            if (id % 2 == 0) journal.Done(Handle(id), int(id % 50));
+            else if (id % 5 == 0) journal.RolledBack(Handle(id), 2);
+        }
+        // 等后端写完并触发压缩 (Stop 时不压缩)
+        for (int i = 0; i < 200 && FileSize(cfg.path) > 1024 * 1024 / 2; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        journal.Stop();
+    }
+    const int64_t compacted = FileSize(cfg.path);
+    std::printf("[INFO] compacted journal: %lld bytes\n", static_cast<long long>(compacted));
+    Check(compacted > 0 && compacted < 1024 * 1024 / 2, "journal compacted below threshold");
+
+    live = Replay(cfg);
+    bool same = live.size() == 3 + 1000;
+    for (uint64_t id = 101; same && id < 2100; id += 2) {
+        auto it = live.find(id);
+        same = it != live.end() && it->second.req.priority == int(id % 3) && it->second.createdMs == 2000 + int64_t(id);
+        if (!same) break;
+        if (id % 5 == 0) same = it->second.agvId == -1 && it->second.progress == 0.0f;
+        else same = it->second.agvId == int(id % 50) && it->second.progress == 0.75f;
+    }
+    Check(same, "compacted journal replays to the same unfinished tasks");
+    Check(live.count(3) && live.count(4) && live.count(5), "tasks from before compaction survive");
+
+    std::remove(cfg.path.c_str());
+    return agv::test::Result();
+}
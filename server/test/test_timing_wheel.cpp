@@ -0,0 +1,164 @@
+// server/test/test_timing_wheel.cpp
+// TimingWheel : 定时 / 重新定时 / 取消 / 跨层下沉 / 到期顺序，与 “逐个比较到期时间” 的朴素实现对拍
+#include "TestCheck.h"
+#include "utils/TimingWheel.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+using agv::test::Check;
+
+namespace {
+
+using Wheel = TimingWheel<int, int>;
+
+std::vector<int> Keys(const std::vector<Wheel::Expired>& out) {
+    std::vector<int> keys;
+    for (const auto& e : out) keys.push_back(e.key);
+    return keys;
+}
+
+}
+
+int main() {
+    std::vector<Wheel::Expired> out;
+
+    // 1. 定时 + 到期 : 到期时间向上取整到 tick，只会晚到、不会提前
+    {
+        Wheel wheel(100);
+        wheel.Advance(0, out);
+        wheel.Arm(1, 11, 150);
+        wheel.Advance(199, out);
+        bool notEarly = out.empty();
+        wheel.Advance(200, out);
+        Check(notEarly && out.size() == 1 && out[0].key == 1 && out[0].value == 11,
+              "deadline rounds up to the next tick");
+        Check(wheel.Empty(), "expired timer removed");
+        out.clear();
+    }
+
+    // 2. 重新定时 : 推后 / 提前都只触发一次，值取最后一次
+    {
+        Wheel wheel(1);
+        wheel.Advance(0, out);
+        wheel.Arm(1, 10, 50);
+        wheel.Arm(1, 20, 5000);     // 推后，跨层
+        wheel.Arm(2, 30, 5000);
+        wheel.Arm(2, 40, 30);       // 提前
+        Check(wheel.Size() == 2, "re-arm does not duplicate");
+
+        wheel.Advance(30, out);
+        Check(Keys(out) == std::vector<int>{2} && out[0].value == 40, "re-armed earlier fires at new deadline");
+        out.clear();
+        wheel.Advance(4999, out);
+        bool quiet = out.empty();
+        wheel.Advance(5000, out);
+        Check(quiet && Keys(out) == std::vector<int>{1} && out[0].value == 20, "re-armed later fires once at new deadline");
+        out.clear();
+    }
+
+    // 3. 取消
+    {
+        Wheel wheel(1);
+        wheel.Advance(0, out);
+        wheel.Arm(1, 0, 10);
+        wheel.Arm(2, 0, 100000);
+        bool c1 = wheel.Cancel(1), c2 = wheel.Cancel(2);
+        Check(c1 && c2 && !wheel.Cancel(1) && wheel.Empty(), "cancel removes timers once");
+        wheel.Arm(3, 0, 20);
+        wheel.Advance(200000, out);
+        Check(Keys(out) == std::vector<int>{3}, "cancelled timers never fire");
+        out.clear();
+    }
+
+    // 4. 已过期 : 下一个 tick 触发; 空轮子 Advance 直接跳到当前时间
+    {
+        Wheel wheel(1);
+        wheel.Advance(1000, out);
+        wheel.Arm(1, 0, 500);
+        wheel.Advance(1000, out);
+        bool notSameTick = out.empty();
+        wheel.Advance(1001, out);
+        Check(notSameTick && Keys(out) == std::vector<int>{1}, "past deadline fires on the next tick");
+        out.clear();
+
+        wheel.Advance(1000000, out);
+        wheel.Arm(2, 0, 1000010);
+        wheel.Advance(1000009, out);
+        bool quiet = out.empty();
+        wheel.Advance(1000010, out);
+        Check(quiet && Keys(out) == std::vector<int>{2}, "empty wheel jumps to current time");
+        out.clear();
+    }
+
+    // 5. 跨层 : 各层边界两侧 + 超出最高层范围，一次 Advance 走完，到期顺序按时间
+    {
+        Wheel wheel(1);
+        wheel.Advance(0, out);
+        const int64_t deadlines[] = {
+            1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 262145,
+            16777215, 16777216, 16777217, 20000000};
+        int key = 0;
+        for (auto it = std::rbegin(deadlines); it != std::rend(deadlines); ++it) wheel.Arm(key++, (int)*it, *it);
+
+        wheel.Advance(20000000, out);
+        bool sorted = out.size() == std::size(deadlines);
+        for (size_t i = 0; sorted && i < out.size(); ++i) sorted = out[i].value == deadlines[i];
+        Check(sorted, "timers across all levels expire in deadline order");
+        out.clear();
+    }
+
+    // 6. 随机对拍 : 随机定时 / 重新定时 / 取消 / 推进，每个定时器必须恰好在第一个 now >= 到期 tick 的 Advance 里触发
+    {
+        const int64_t tickMs = 10;
+        Wheel wheel(tickMs);
+        std::map<int, int64_t> model;  // key -> 到期 tick
+        std::mt19937 rng(2024);
+        std::uniform_int_distribution<int> op(0, 9), keyDist(0, 499);
+        std::uniform_int_distribution<int64_t> far(0, 3000000), step(0, 2000);
+
+        int64_t now = 0;
+        wheel.Advance(now, out);
+        bool exact = true, ordered = true;
+        size_t fired = 0;
+        for (int i = 0; i < 200000 && exact; ++i) {
+            int o = op(rng);
+            int key = keyDist(rng);
+            if (o < 5) {
+                int64_t deadline = now + (o == 0 ? far(rng) : step(rng));
+                int64_t tick = std::max((deadline + tickMs - 1) / tickMs, now / tickMs + 1);
+                wheel.Arm(key, 0, deadline);
+                model[key] = tick;
+            }
+            else if (o < 7) {
+                bool had = model.erase(key) > 0;
+                exact = wheel.Cancel(key) == had;
+            }
+            else {
+                now += step(rng);
+                out.clear();
+                wheel.Advance(now, out);
+                int64_t last = 0;
+                for (const auto& e : out) {
+                    auto it = model.find(e.key);
+                    exact = exact && it != model.end() && it->second <= now / tickMs;
+                    if (it == model.end()) break;
+                    ordered = ordered && it->second >= last;
+                    last = it->second;
+                    model.erase(it);
+                }
+                fired += out.size();
+                for (const auto& kv : model) exact = exact && kv.second > now / tickMs;  // 该到期的都到期了
+                exact = exact && wheel.Size() == model.size();
+            }
+        }
+        std::printf("[INFO] randomized run: %zu timers fired\n", fired);
+        Check(exact, "randomized arm/re-arm/cancel matches reference model");
+        Check(ordered, "each Advance returns expiries in tick order");
+    }
+
+    return agv::test::Result();
+}
@@ -0,0 +1,179 @@
+// server/test/test_trajectory_store.cpp
+// TrajectoryStore : 环形缓冲绕圈只留最近 capacity 个、降采样、Recent / InRect 的时间与矩形过滤、
+//                   Attach 之后上一任车主 (或上一次连接) 的采样不可见、写者绕圈时读者不会读到撕裂的采样
+#include "TestCheck.h"
+#include "manager/TrajectoryStore.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace agv;
+using namespace agv::manager;
+using agv::test::Check;
+using model::Point;
+
+namespace {
+
+// 时间先后、且时间 / 位置是连续的一段 : 第 k 个采样 (from + k) 在 (x0 + from + k, y)
+bool Run(const std::vector<TrajSample>& v, int from, int count, int64_t t0, int64_t stepMs, int x0, int y) {
+    if (static_cast<int>(v.size()) != count) return false;
+    for (int k = 0; k < count; ++k) {
+        int i = from + k;
+        if (v[k].tsMs != t0 + stepMs * i || !(v[k].pos == Point{x0 + i, y})) return false;
+    }
+    return true;
+}
+
+size_t HitsOf(const std::vector<TrajHit>& hits, int agvId) {
+    return std::count_if(hits.begin(), hits.end(), [agvId](const TrajHit& h) { return h.agvId == agvId; });
+}
+
+}
+
+int main() {
+    const AgvSlot a = SlotTbl.Acquire(1);
+    const AgvSlot b = SlotTbl.Acquire(2);
+    std::vector<TrajSample> out;
+    std::vector<TrajHit> hits;
+
+    // 1. 关闭 (capacity 0) : 什么都不记
+    {
+        TrajectoryStore off;
+        off.Configure(0, 100);
+        off.Attach(a, 1);
+        off.Record(a, 1000, {1, 1}, model::AgvStatus::MOVING);
+        Check(!off.Enabled() && off.Recent(a, 1, 0, out) == 0 && out.empty(), "disabled store records nothing");
+    }
+
+    const int kCap = 8;
+    const int64_t kStep = 100;
+    TrajectoryStore store;
+    store.Configure(kCap, kStep);
+    store.Attach(a, 1);
+    store.Attach(b, 2);
+
+    // 2. 绕圈 : 写 20 个，只剩最近 8 个，按时间先后返回; 状态原样带回
+    {
+        for (int i = 0; i < 20; ++i)
+            store.Record(a, 1000 + kStep * i, {i, 0}, (i & 1) ? model::AgvStatus::MOVING : model::AgvStatus::PAUSED);
+        out.clear();
+        Check(store.Recent(a, 1, 0, out) == kCap && Run(out, 20 - kCap, kCap, 1000, kStep, 0, 0), "ring keeps the latest capacity samples in order");
+        Check(out.back().status == model::AgvStatus::MOVING && out[out.size() - 2].status == model::AgvStatus::PAUSED,
+              "status stored with each sample");
+
+        out.clear();
+        Check(store.Recent(a, 1, 1000 + kStep * 16, out) == 4 && Run(out, 16, 4, 1000, kStep, 0, 0), "sinceMs trims older samples");
+
+        // 降采样 : 距上一个采样不足 sampleIntervalMs 不记
+        store.Record(a, 1000 + kStep * 19 + kStep / 2, {99, 99}, model::AgvStatus::MOVING);
+        out.clear();
+        Check(store.Recent(a, 1, 0, out) == kCap && out.back().pos == Point{19, 0}, "samples closer than the interval dropped");
+
+        out.clear();
+        Check(store.Recent(a, 2, 0, out) == 0 && out.empty(), "wrong agv id on the slot returns nothing");
+
+        // 长时间绕圈 : 编号远超容量后仍然只剩最近 8 个且连续
+        for (int i = 20; i < 10000; ++i) store.Record(a, 1000 + kStep * i, {i, 0}, model::AgvStatus::MOVING);
+        out.clear();
+        Check(store.Recent(a, 1, 0, out) == kCap && Run(out, 10000 - kCap, kCap, 1000, kStep, 0, 0), "many laps keep the window contiguous");
+    }
+
+    // 3. InRect : 矩形闭区间 + 时间过滤，按车分开
+    {
+        const int64_t t0 = 2000000;
+        store.Record(b, t0, {5, 5}, model::AgvStatus::MOVING);
+        store.Record(b, t0 + 100, {6, 6}, model::AgvStatus::MOVING);
+        store.Record(b, t0 + 200, {7, 7}, model::AgvStatus::MOVING);
+
+        hits.clear();
+        store.InRect({5, 5}, {6, 6}, 0, hits);
+        Check(hits.size() == 2 && HitsOf(hits, 2) == 2, "rect bounds are inclusive");
+
+        hits.clear();
+        store.InRect({5, 5}, {7, 7}, t0 + 100, hits);
+        Check(hits.size() == 2 && HitsOf(hits, 2) == 2, "rect query honours sinceMs");
+
+        const int64_t t9994 = 1000 + kStep * 9994;
+        hits.clear();
+        store.InRect({9990, 0}, {9995, 0}, 0, hits);
+        Check(hits.size() == 4 && HitsOf(hits, 1) == 4, "overwritten samples not returned by rect query");
+        hits.clear();
+        store.InRect({0, -1}, {20000, 10}, t9994, hits);
+        Check(HitsOf(hits, 1) == 6 && HitsOf(hits, 2) == 3, "rect query spans all online agvs");
+
+        // 下线 : 查询不再返回这辆车
+        store.Detach(b);
+        hits.clear();
+        store.InRect({0, 0}, {10, 10}, 0, hits);
+        out.clear();
+        Check(hits.empty() && store.Recent(b, 2, 0, out) == 0, "detached agv hidden from queries");
+    }
+
+    // 4. Attach : 槽位换主 / 同一辆车重连，之前的采样都不可见 (哪怕还在环里)
+    {
+        store.Attach(b, 3);
+        out.clear();
+        hits.clear();
+        store.InRect({0, 0}, {10, 10}, 0, hits);
+        Check(store.Recent(b, 3, 0, out) == 0 && store.Recent(b, 2, 0, out) == 0 && hits.empty(),
+              "new owner sees none of the previous owner's samples");
+
+        store.Record(b, 3000000, {1, 1}, model::AgvStatus::IDLE);
+        store.Record(b, 3000100, {2, 1}, model::AgvStatus::IDLE);
+        out.clear();
+        Check(store.Recent(b, 3, 0, out) == 2 && Run(out, 0, 2, 3000000, kStep, 1, 1), "new owner sees only its own samples");
+
+        // 重连 : 降采样的计时也重置，重连后第一个采样立即记下
+        store.Attach(a, 1);
+        store.Record(a, 1000 + kStep * 9999 + 1, {42, 42}, model::AgvStatus::IDLE);
+        out.clear();
+        Check(store.Recent(a, 1, 0, out) == 1 && out[0].pos == Point{42, 42}, "reconnect hides samples of the previous connection");
+    }
+
+    // 5. 并发 : 单写者高速绕圈，读者的每个采样都完整 (时间 / 位置对得上)、时间先后、个数不超过容量
+    {
+        TrajectoryStore live;
+        live.Configure(kCap, 0);
+        live.Attach(a, 1);
+
+        const int kRecords = 2000000;
+        std::atomic<bool> stop{false};
+        std::atomic<int> started{0};
+        std::atomic<uint64_t> reads{0}, bad{0};
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 2; ++r) {
+            readers.emplace_back([&]() {
+                started.fetch_add(1);
+                std::vector<TrajSample> v;
+                uint64_t n = 0;
+                while (!stop.load(std::memory_order_acquire)) {
+                    v.clear();
+                    live.Recent(a, 1, 0, v);
+                    bool ok = v.size() <= size_t(kCap);
+                    for (size_t k = 0; ok && k < v.size(); ++k) {
+                        ok = v[k].pos.x == v[k].tsMs && v[k].pos.y == int(v[k].tsMs % 1000) && (k == 0 || v[k].tsMs == v[k - 1].tsMs + 1);
+                    }
+                    if (!ok) bad.fetch_add(1);
+                    ++n;  // 不主动让出 : 单核机器上在扫描中途被切走，写者趁机覆盖
+                }
+                reads.fetch_add(n);
+            });
+        }
+        while (started.load() < 2) std::this_thread::yield();
+        for (int i = 1; i <= kRecords; ++i) {
+            live.Record(a, i, {i, i % 1000}, model::AgvStatus::MOVING);
+            if (i % 4096 == 0) std::this_thread::yield();
+        }
+        stop.store(true, std::memory_order_release);
+        for (auto& t : readers) t.join();
+
+        std::printf("[INFO] %llu scans during %d records\n", (unsigned long long)reads.load(), kRecords);
+        Check(bad.load() == 0, "readers never see torn or out-of-order samples while the writer laps");
+        out.clear();
+        Check(live.Recent(a, 1, 0, out) == kCap && out.back().tsMs == kRecords, "latest samples readable after the run");
+    }
+
+    return agv::test::Result();
+}